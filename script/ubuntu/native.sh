@@ -0,0 +1,96 @@
+#! /bin/bash
+
+set -u
+
+BASE_PATH="$(dirname "$0")/../.."
+cd "$BASE_PATH"
+
+USES="${1:-100000}"
+RENDERS="${2:-20}"
+PROGRAM="$(mktemp)"
+DRIVER="$(mktemp -d)"
+
+# Every "@use" has distinct arguments, so the expansion cache can't take the
+# work away from the generator.
+awk -v n="$USES" 'BEGIN {
+	print "@define card(title, text, kind)"
+	print "@card { background: red; padding: 8px; }"
+	print "# {{title}}"
+	print "@end"
+	print "@if (kind = \"wide\")"
+	print "@row { gap: 4px; }"
+	print "@column { flex: 1; }"
+	print "{{text}}"
+	print "@end"
+	print "@end"
+	print "@else"
+	print "{{text}}"
+	print "@end"
+	print "@enddefine"
+	for (i = 0; i < n; ++i) {
+		if (i % 500 == 0) {
+			print "@footer"
+		}
+		printf "@use card(\"Card %d\", \"Text %d\", \"%s\")\n", i, i, i % 2 == 0 ? "wide" : "narrow"
+		if (i % 500 == 499 || i == n - 1) {
+			print "@end"
+		}
+	}
+}' > "$PROGRAM"
+
+# Renders the program many times into the same buffer, and writes the last
+# render out.
+cat > "$DRIVER/driver.c" <<'DRIVER'
+#include "native.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+int main(const int count, const char ** arguments) {
+	const int renders = count > 1 ? atoi(arguments[1]) : 1;
+	RenderBuffer buffer = { NULL, 0, 0 };
+	render_program(&buffer);
+	buffer.bytes = malloc(buffer.length);
+	buffer.capacity = buffer.length;
+	struct timespec start, end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (int k = 0; k < renders; ++k) {
+		buffer.length = 0;
+		render_program(&buffer);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	fprintf(stderr, "%ld\n", ((end.tv_sec - start.tv_sec) * 1000000000L + end.tv_nsec - start.tv_nsec) / renders / 1000);
+	fwrite(buffer.bytes, 1, buffer.length, stdout);
+	free(buffer.bytes);
+	return 0;
+}
+DRIVER
+
+echo "Rendering time of the generator and of its C translation ($USES uses)..."
+echo ""
+
+START="$(date +%s%N)"
+NATIVE_OUTPUT_FILE=native.c OUTPUT_FILE=native.html build/Compiler < "$PROGRAM" >/dev/null 2>&1
+RESULT="$?"
+TIME=$(( ($(date +%s%N) - START) / 1000 ))
+STATUS=0
+if [ "$RESULT" != "0" ]; then
+	STATUS=1
+	echo "    The compiler failed (status $RESULT)."
+elif ! cc -std=gnu99 -O2 -Isrc/output -o "$DRIVER/native" src/output/native.c "$DRIVER/driver.c"; then
+	STATUS=1
+	echo "    The C translation unit does not compile."
+else
+	NATIVE_TIME="$("$DRIVER/native" "$RENDERS" 2>&1 >"$DRIVER/native.html")"
+	echo "    generate(): $(( TIME / 1000 )) ms (parsing included)"
+	echo "    render_program(): $(( NATIVE_TIME / 1000 )) ms (average of $RENDERS renders)"
+	if ! cmp -s "$DRIVER/native.html" src/output/native.html; then
+		STATUS=1
+		echo "    but their outputs differ"
+	fi
+fi
+rm -rf "$PROGRAM" "$DRIVER" src/output/native.c src/output/native.h src/output/native.html
+echo ""
+
+echo "All done."
+exit $STATUS
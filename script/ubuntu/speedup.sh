@@ -0,0 +1,55 @@
+#! /bin/bash
+
+set -u
+
+BASE_PATH="$(dirname "$0")/../.."
+cd "$BASE_PATH"
+
+SECTIONS="${1:-200}"
+PROGRAM="$(mktemp)"
+
+# Every section holds distinct text and "@use" arguments, so the expansion
+# cache can't take the work away from the threads.
+awk -v n="$SECTIONS" 'BEGIN {
+	print "@define card(title, text)"
+	print "@card { background: red; }"
+	print "# {{title}}"
+	print "{{text}}"
+	print "@end"
+	print "@enddefine"
+	for (i = 0; i < n; ++i) {
+		print "@footer { background: #222; }"
+		for (j = 0; j < 500; ++j) {
+			if (j % 5 == 0) {
+				printf "@use card(\"Section %d\", \"Card %d\")\n", i, j
+			}
+			else {
+				printf "\"Paragraph %d of section %d\"\n", j, i
+			}
+		}
+		print "@end"
+	}
+}' > "$PROGRAM"
+
+echo "Speedup of a parallel generation ($SECTIONS sections, $(nproc) processors)..."
+echo ""
+
+BASELINE=0
+for threads in 1 2 4 8 16 32; do
+	START="$(date +%s%N)"
+	GENERATOR_THREADS="$threads" OUTPUT_FILE=speedup.html build/Compiler < "$PROGRAM" >/dev/null 2>&1
+	RESULT="$?"
+	TIME=$(( ($(date +%s%N) - START) / 1000000 + 1 ))
+	if [ "$RESULT" != "0" ]; then
+		echo "    $threads threads: failed (status $RESULT)"
+		continue
+	fi
+	if [ "$BASELINE" == "0" ]; then
+		BASELINE="$TIME"
+	fi
+	echo "    $threads threads: $TIME ms (speedup $(( 100 * BASELINE / TIME / 100 )).$(printf "%02d" $(( 100 * BASELINE / TIME % 100 )))x)"
+done
+rm -f "$PROGRAM" src/output/speedup.html
+echo ""
+
+echo "All done."
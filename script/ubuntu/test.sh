@@ -40,5 +40,542 @@ for test in $(ls src/test/c/reject/); do
 done
 echo ""
 
+echo "Compiler should nest arbitrarily deep, in linear time..."
+echo ""
+
+DEEP_PROGRAM="$(mktemp)"
+declare -A DEEP_TIME
+for levels in 250000 1000000; do
+	awk -v n="$levels" 'BEGIN { for (i = 0; i < n; ++i) print "@footer"; print "\"x\""; for (i = 0; i < n; ++i) print "@end" }' > "$DEEP_PROGRAM"
+	START="$(date +%s%N)"
+	MINIFY=true MAXIMUM_NESTING_DEPTH=0 OUTPUT_FILE=deep-nesting.html build/Compiler < "$DEEP_PROGRAM" >/dev/null 2>&1
+	RESULT="$?"
+	DEEP_TIME[$levels]=$(( ($(date +%s%N) - START) / 1000000 + 1 ))
+	if [ "$RESULT" == "0" ]; then
+		echo -e "    $levels levels, ${GREEN}and it does${OFF} (${DEEP_TIME[$levels]} ms)"
+	else
+		STATUS=1
+		echo -e "    $levels levels, ${RED}but it rejects${OFF} (status $RESULT)"
+	fi
+done
+# 4 times the levels should take about 4 times as long (8 leaves room for noise).
+if [ $(( DEEP_TIME[1000000] )) -gt $(( 8 * DEEP_TIME[250000] )) ]; then
+	STATUS=1
+	echo -e "    ${RED}but it takes superlinear time${OFF}"
+fi
+rm -f "$DEEP_PROGRAM" src/output/deep-nesting.html
+echo ""
+
+echo "Compiler should stop at every resource limit, and tell which one..."
+echo ""
+
+NESTED_PROGRAM="$(mktemp)"
+CHAIN_PROGRAM="$(mktemp)"
+ERRORS_PROGRAM="$(mktemp)"
+awk 'BEGIN { for (i = 0; i < 50; ++i) print "@footer"; print "\"x\""; for (i = 0; i < 50; ++i) print "@end" }' > "$NESTED_PROGRAM"
+# Every define uses the one before it twice, so the last one expands into 2^24 headers.
+awk 'BEGIN { print "@define d0\n# \"x\"\n@enddefine"; for (i = 1; i <= 24; ++i) printf "@define d%d\n@use d%d\n@use d%d\n@enddefine\n", i, i - 1, i - 1; print "@use d24" }' > "$CHAIN_PROGRAM"
+for k in 1 2 3 4 5; do echo "@use missing$k"; done > "$ERRORS_PROGRAM"
+while IFS='|' read -r limit program expected; do
+	env "$limit" OUTPUT_FILE=limit.html build/Compiler < "$program" > src/output/limit.log 2>&1
+	RESULT="$?"
+	if [ "$RESULT" != "0" ] && grep -qF "$expected" src/output/limit.log && [ ! -s src/output/limit.html ]; then
+		echo -e "    $limit, ${GREEN}and it does${OFF} (status $RESULT)"
+	else
+		STATUS=1
+		echo -e "    $limit, ${RED}but it doesn't${OFF} (status $RESULT)"
+	fi
+done <<LIMITS
+MAXIMUM_INPUT_BYTES=16|src/test/c/accept/19-EntirePage|[Error 1]: Resource limit exceeded: input bytes (limit: 16).
+MAXIMUM_NESTING_DEPTH=10|$NESTED_PROGRAM|[Error 1]: Resource limit exceeded: nesting depth (limit: 10).
+MAXIMUM_EXPANDED_NODES=10000|$CHAIN_PROGRAM|[Error 1]: Resource limit exceeded: expanded nodes (limit: 10000).
+MAXIMUM_OUTPUT_BYTES=100|src/test/c/accept/19-EntirePage|[Error 1]: Resource limit exceeded: output bytes (limit: 100).
+MAXIMUM_ERRORS=2|$ERRORS_PROGRAM|[Error 3]: Too many errors (limit: 2), the rest are omitted.
+MAXIMUM_COMPILATION_TIME=1|$CHAIN_PROGRAM|[Error 1]: Resource limit exceeded: compilation time in milliseconds (limit: 1).
+LIMITS
+rm -f "$NESTED_PROGRAM" "$CHAIN_PROGRAM" "$ERRORS_PROGRAM" src/output/limit.html src/output/limit.log
+echo ""
+
+echo "Compiler should escape what HTML would take for markup, in every mode..."
+echo ""
+
+for mode in "" BYTECODE_GENERATION=true STREAMING_GENERATION=true LAZY_DEFINES=true; do
+	env $mode OUTPUT_FILE=escaping.html build/Compiler < src/test/c/accept/32-Escaping >/dev/null 2>&1
+	if grep -qF '<h1>Fish &amp; Chips &lt;daily&gt;</h1>' src/output/escaping.html \
+		&& grep -qF '<img src="menu.png?size=large&amp;lang=en" alt="The &quot;full&quot; menu"' src/output/escaping.html \
+		&& grep -qF '<h3>Tom &amp; Jerry</h3>' src/output/escaping.html \
+		&& grep -qF '<p>&lt;b&gt;not bold&lt;/b&gt;</p>' src/output/escaping.html \
+		&& grep -qF "<p>Every one of these words is plain (it's true), until the very end: &lt;b&gt;</p>" src/output/escaping.html \
+		&& grep -qF '<h3>Someone with a long name &amp; more</h3>' src/output/escaping.html \
+		&& grep -qF '<p>Every one of these words is plain, until the very end: &lt;b&gt;</p>' src/output/escaping.html \
+		&& ! grep -q '<b>' src/output/escaping.html; then
+		echo -e "    ${mode:-default}, ${GREEN}and it does${OFF}"
+	else
+		STATUS=1
+		echo -e "    ${mode:-default}, ${RED}but it doesn't${OFF}"
+	fi
+done
+rm -f src/output/escaping.html
+echo ""
+
+echo "Compiler should only take strings, numbers and booleans from the data of an @each..."
+echo ""
+
+DATA_FILE="$(mktemp)"
+printf '@define product(name, price)\n## {{name}}\n{{price}}\n@enddefine\n@each product in "%s"\n' "$DATA_FILE" > src/output/data.txt
+while IFS='|' read -r value expected; do
+	# The value of a field that's bound, and of one that's skipped.
+	echo "[ { \"name\": \"Keyboard\", \"price\": $value, \"stock\": $value } ]" > "$DATA_FILE"
+	OUTPUT_FILE=data.html build/Compiler < src/output/data.txt > src/output/data.log 2>&1
+	RESULT="$?"
+	if { [ "$expected" == "accepts" ] && [ "$RESULT" == "0" ]; } \
+		|| { [ "$expected" == "rejects" ] && [ "$RESULT" != "0" ] && grep -q "Invalid value" src/output/data.log; }; then
+		echo -e "    $value, ${GREEN}and it $expected it${OFF}"
+	else
+		STATUS=1
+		echo -e "    $value, ${RED}but it doesn't${OFF} (status $RESULT)"
+	fi
+done <<'VALUES'
+"$ 49"|accepts
+12|accepts
+0|accepts
+-0.5e+3|accepts
+1E9|accepts
+true|accepts
+false|accepts
+hello|rejects
+1x2|rejects
+01|rejects
+1.|rejects
++1|rejects
+1e|rejects
+-|rejects
+True|rejects
+VALUES
+rm -f "$DATA_FILE" src/output/data.txt src/output/data.html src/output/data.log
+echo ""
+
+echo "Compiler should accept and reject the same programs when it defers define bodies, with the same output..."
+echo ""
+
+for test in $(ls src/test/c/accept/); do
+	OUTPUT_FILE=eager.html build/Compiler < "src/test/c/accept/$test" >/dev/null 2>&1
+	LAZY_DEFINES=true OUTPUT_FILE=lazy.html build/Compiler < "src/test/c/accept/$test" >/dev/null 2>&1
+	LAZY_RESULT="$?"
+	LAZY_DEFINES=true STRICT_DEFINES=true OUTPUT_FILE=strict.html build/Compiler < "src/test/c/accept/$test" >/dev/null 2>&1
+	STRICT_RESULT="$?"
+	if [ "$LAZY_RESULT" == "0" ] && [ "$STRICT_RESULT" == "0" ] && cmp -s src/output/eager.html src/output/lazy.html \
+		&& cmp -s src/output/eager.html src/output/strict.html; then
+		echo -e "    $test, ${GREEN}and it does${OFF}"
+	else
+		STATUS=1
+		echo -e "    $test, ${RED}but it differs${OFF}"
+	fi
+done
+for test in $(ls src/test/c/reject/); do
+	LAZY_DEFINES=true OUTPUT_FILE=lazy.html build/Compiler < "src/test/c/reject/$test" >/dev/null 2>&1
+	LAZY_RESULT="$?"
+	LAZY_DEFINES=true STRICT_DEFINES=true build/Compiler < "src/test/c/reject/$test" >/dev/null 2>&1
+	STRICT_RESULT="$?"
+	if [ "$LAZY_RESULT" != "0" ] && [ "$STRICT_RESULT" != "0" ] && [ ! -s src/output/lazy.html ]; then
+		echo -e "    $test, ${GREEN}and it does${OFF}"
+	else
+		STATUS=1
+		echo -e "    $test, ${RED}but it accepts${OFF}"
+	fi
+done
+# A body that's never used is only parsed in strict mode.
+printf '@define unused\n@enddefine\n# "Title"' > src/output/unused.txt
+LAZY_DEFINES=true build/Compiler < src/output/unused.txt >/dev/null 2>&1
+LAZY_RESULT="$?"
+LAZY_DEFINES=true STRICT_DEFINES=true build/Compiler < src/output/unused.txt > src/output/unused.log 2>&1
+STRICT_RESULT="$?"
+if [ "$LAZY_RESULT" == "0" ] && [ "$STRICT_RESULT" != "0" ] && grep -q 'Function "unused" has an empty body' src/output/unused.log; then
+	echo -e "    an unused empty define, ${GREEN}and it does${OFF}"
+else
+	STATUS=1
+	echo -e "    an unused empty define, ${RED}but it doesn't${OFF}"
+fi
+rm -f src/output/eager.html src/output/lazy.html src/output/strict.html src/output/unused.txt src/output/unused.log
+echo ""
+
+echo "Compiler should generate the same output on many threads, while it parses, without copying, and as bytecode..."
+echo ""
+
+for test in $(ls src/test/c/accept/); do
+	OUTPUT_FILE=sequential.html build/Compiler < "src/test/c/accept/$test" >/dev/null 2>&1
+	GENERATOR_THREADS=4 GENERATOR_TASK_WEIGHT=1 OUTPUT_FILE=parallel.html build/Compiler < "src/test/c/accept/$test" >/dev/null 2>&1
+	STREAMING_GENERATION=true OUTPUT_FILE=streaming.html build/Compiler < "src/test/c/accept/$test" >/dev/null 2>&1
+	ZERO_COPY_OUTPUT=true OUTPUT_BUFFER_SIZE=64 OUTPUT_FILE=vectored.html build/Compiler < "src/test/c/accept/$test" >/dev/null 2>&1
+	BYTECODE_GENERATION=true OUTPUT_FILE=bytecode.html build/Compiler < "src/test/c/accept/$test" >/dev/null 2>&1
+	if cmp -s src/output/sequential.html src/output/parallel.html && cmp -s src/output/sequential.html src/output/streaming.html \
+		&& cmp -s src/output/sequential.html src/output/vectored.html && cmp -s src/output/sequential.html src/output/bytecode.html; then
+		echo -e "    $test, ${GREEN}and it does${OFF}"
+	else
+		STATUS=1
+		echo -e "    $test, ${RED}but it differs${OFF}"
+	fi
+done
+rm -f src/output/sequential.html src/output/parallel.html src/output/streaming.html src/output/vectored.html src/output/bytecode.html
+echo ""
+
+echo "Compiler should resolve a parameter named outside its define with the last use of the program, or the last one before it while streaming..."
+echo ""
+
+cat > src/output/parameters.txt <<'PROGRAM'
+@define inner
+# "title"
+@enddefine
+@define card(title)
+# {{title}}
+@enddefine
+# "title"
+@use card('X')
+@use inner
+@use card('Y')
+@use inner
+PROGRAM
+while IFS='|' read -r mode expected; do
+	env $mode OUTPUT_FILE=parameters.html build/Compiler < src/output/parameters.txt >/dev/null 2>&1
+	if [ "$(grep -o '<h1>[^<]*</h1>' src/output/parameters.html | paste -sd ' ')" == "$expected" ]; then
+		echo -e "    ${mode:-default}, ${GREEN}and it does${OFF}"
+	else
+		STATUS=1
+		echo -e "    ${mode:-default}, ${RED}but it doesn't${OFF}"
+	fi
+done <<'MODES'
+|<h1>Y</h1> <h1>X</h1> <h1>Y</h1> <h1>Y</h1> <h1>Y</h1>
+STREAMING_GENERATION=true|<h1>title</h1> <h1>X</h1> <h1>X</h1> <h1>Y</h1> <h1>Y</h1>
+STREAMING_GENERATION=true USE_CACHE_BYTES=256|<h1>title</h1> <h1>X</h1> <h1>X</h1> <h1>Y</h1> <h1>Y</h1>
+STREAMING_GENERATION=true USE_CACHE_BYTES=0|<h1>title</h1> <h1>X</h1> <h1>X</h1> <h1>Y</h1> <h1>Y</h1>
+MODES
+rm -f src/output/parameters.txt src/output/parameters.html
+echo ""
+
+echo "Compiler should reuse identical uses at every depth, with the same output as a tiny cache and no cache at all..."
+echo ""
+
+CACHE_PROGRAM="$(mktemp)"
+cat > "$CACHE_PROGRAM" <<'EOF'
+@define label(text)
+@button
+{{text}}
+@end
+@enddefine
+
+@define pair(caption)
+{{caption}}
+@use label('One')
+@use label('Both')
+@enddefine
+
+@use label('Both')
+@use pair('Two')
+@use label('Both')
+@footer
+@use label('Both')
+@use pair('Two')
+@row
+@column
+@use label('Both')
+@use pair('Two')
+@end
+@column
+@use label('Both')
+@footer
+@use pair('Two')
+@use label('Both')
+@end
+@end
+@end
+@end
+@use pair('Two')
+EOF
+for mode in "" MINIFY=true; do
+	env $mode LOGGING_LEVEL=DEBUGGING OUTPUT_FILE=cached.html build/Compiler < "$CACHE_PROGRAM" > src/output/cached.log 2>&1
+	env $mode LOGGING_LEVEL=DEBUGGING USE_CACHE_BYTES=256 OUTPUT_FILE=tiny.html build/Compiler < "$CACHE_PROGRAM" > src/output/tiny.log 2>&1
+	env $mode USE_CACHE_BYTES=0 OUTPUT_FILE=uncached.html build/Compiler < "$CACHE_PROGRAM" >/dev/null 2>&1
+	if grep -q "Use cache: [1-9][0-9]* hits" src/output/cached.log && grep -q "misses, [1-9][0-9]* evictions" src/output/tiny.log \
+		&& cmp -s src/output/cached.html src/output/tiny.html && cmp -s src/output/cached.html src/output/uncached.html; then
+		echo -e "    ${mode:-pretty}, ${GREEN}and it does${OFF}"
+	else
+		STATUS=1
+		echo -e "    ${mode:-pretty}, ${RED}but it differs${OFF}"
+	fi
+done
+rm -f "$CACHE_PROGRAM" src/output/cached.html src/output/tiny.html src/output/uncached.html src/output/cached.log src/output/tiny.log
+echo ""
+
+echo "Compiler should extract every style into a class, the same way on many threads and as bytecode..."
+echo ""
+
+for test in $(ls src/test/c/accept/); do
+	EXTRACT_STYLES=true OUTPUT_FILE=extracted.html build/Compiler < "src/test/c/accept/$test" >/dev/null 2>&1
+	EXTRACT_STYLES=true GENERATOR_THREADS=4 GENERATOR_TASK_WEIGHT=1 OUTPUT_FILE=parallel.html build/Compiler < "src/test/c/accept/$test" >/dev/null 2>&1
+	EXTRACT_STYLES=true BYTECODE_GENERATION=true OUTPUT_FILE=bytecode.html build/Compiler < "src/test/c/accept/$test" >/dev/null 2>&1
+	if ! grep -q 'style="[^"]' src/output/extracted.html && cmp -s src/output/extracted.html src/output/parallel.html \
+		&& cmp -s src/output/extracted.html src/output/bytecode.html; then
+		echo -e "    $test, ${GREEN}and it does${OFF}"
+	else
+		STATUS=1
+		echo -e "    $test, ${RED}but it doesn't${OFF}"
+	fi
+done
+rm -f src/output/extracted.html src/output/parallel.html src/output/bytecode.html
+echo ""
+
+echo "Compiler should build every page as a site, linking the same stylesheet from all of them..."
+echo ""
+
+PAGES=$(ls -d src/test/c/accept/* | paste -sd ",")
+rm -f src/output/site.*.css
+build/Compiler --site-pages="$PAGES" >/dev/null 2>&1
+SITE_STATUS=$?
+STYLESHEET=$(ls src/output/ | grep '^site\..*\.css$')
+LARGEST_PAGE=$(for test in $(ls src/test/c/accept/); do wc -c < "src/output/$test.html"; done | sort -n | tail -n 1)
+for test in $(ls src/test/c/accept/); do
+	if [ $SITE_STATUS -eq 0 ] && [ -s "src/output/$STYLESHEET" ] && ! grep -q 'style="[^"]' "src/output/$test.html" \
+		&& grep -q "<link rel=\"stylesheet\" href=\"$STYLESHEET\">" "src/output/$test.html"; then
+		echo -e "    $test, ${GREEN}and it does${OFF}"
+	else
+		STATUS=1
+		echo -e "    $test, ${RED}but it doesn't${OFF}"
+	fi
+	rm -f "src/output/$test.html"
+done
+# The limits apply to every page on its own, not to the whole site.
+MAXIMUM_OUTPUT_BYTES=$(( LARGEST_PAGE + 1 )) build/Compiler --site-pages="$PAGES" >/dev/null 2>&1
+LIMITED_STATUS=$?
+if [ $LIMITED_STATUS -eq 0 ]; then
+	echo -e "    with a limit of output bytes just above its largest page, ${GREEN}and it does${OFF}"
+else
+	STATUS=1
+	echo -e "    with a limit of output bytes just above its largest page, ${RED}but it rejects${OFF} (status $LIMITED_STATUS)"
+fi
+for test in $(ls src/test/c/accept/); do
+	rm -f "src/output/$test.html"
+done
+# A page that fails while it's generated leaves every page as it was.
+echo '# "first"' > src/output/short.txt
+for k in $(seq 200); do echo '"A paragraph of a long page."'; done > src/output/long.txt
+build/Compiler --site-pages=src/output/short.txt,src/output/long.txt >/dev/null 2>&1
+echo '# "second"' > src/output/short.txt
+MAXIMUM_OUTPUT_BYTES=1000 build/Compiler --site-pages=src/output/short.txt,src/output/long.txt >/dev/null 2>&1
+FAILED_STATUS=$?
+if [ $FAILED_STATUS -ne 0 ] && grep -q '<h1>first</h1>' src/output/short.html && [ -z "$(ls src/output/ | grep '\.html\.')" ]; then
+	echo -e "    with a page that fails to be generated, leaving every page as it was, ${GREEN}and it does${OFF}"
+else
+	STATUS=1
+	echo -e "    with a page that fails to be generated, leaving every page as it was, ${RED}but it doesn't${OFF}"
+fi
+rm -f src/output/short.txt src/output/long.txt src/output/short.html src/output/long.html
+rm -f src/output/site.*.css
+echo ""
+
+echo "Compiler should compress the same output, in blocks on many threads too..."
+echo ""
+
+for test in $(ls src/test/c/accept/); do
+	GZIP_OUTPUT=ALONGSIDE OUTPUT_FILE=plain.html build/Compiler < "src/test/c/accept/$test" >/dev/null 2>&1
+	GZIP_OUTPUT=INSTEAD GZIP_THREADS=4 GZIP_BLOCK_SIZE=64 OUTPUT_FILE=blocks.html build/Compiler < "src/test/c/accept/$test" >/dev/null 2>&1
+	if gzip -t src/output/plain.html.gz src/output/blocks.html.gz 2>/dev/null && [ ! -e src/output/blocks.html ] \
+		&& gzip -dc src/output/plain.html.gz | cmp -s - src/output/plain.html \
+		&& gzip -dc src/output/blocks.html.gz | cmp -s - src/output/plain.html; then
+		echo -e "    $test, ${GREEN}and it does${OFF}"
+	else
+		STATUS=1
+		echo -e "    $test, ${RED}but it differs${OFF}"
+	fi
+done
+rm -f src/output/plain.html src/output/plain.html.gz src/output/blocks.html.gz
+echo ""
+
+echo "Compiler should leave the output as it was when it doesn't change..."
+echo ""
+
+for test in $(ls src/test/c/accept/); do
+	rm -f src/output/unchanged.html src/output/unchanged.html.etag
+	SKIP_UNCHANGED_OUTPUT=true OUTPUT_FILE=unchanged.html build/Compiler < "src/test/c/accept/$test" >/dev/null 2>&1
+	touch -d "2000-01-01" src/output/unchanged.html
+	SKIP_UNCHANGED_OUTPUT=true OUTPUT_FILE=unchanged.html build/Compiler < "src/test/c/accept/$test" >/dev/null 2>&1
+	OUTPUT_FILE=plain.html build/Compiler < "src/test/c/accept/$test" >/dev/null 2>&1
+	if cmp -s src/output/unchanged.html src/output/plain.html && [ -s src/output/unchanged.html.etag ] \
+		&& [ "$(date -r src/output/unchanged.html +%Y)" = "2000" ] && ! ls src/output/ | grep -q '^unchanged\.html\.[^e]'; then
+		echo -e "    $test, ${GREEN}and it does${OFF}"
+	else
+		STATUS=1
+		echo -e "    $test, ${RED}but it doesn't${OFF}"
+	fi
+done
+rm -f src/output/unchanged.html src/output/unchanged.html.etag src/output/plain.html
+# What changed is written again: the output of a changed program, a compressed copy cut short, and one
+# compressed at another level.
+rm -f src/output/changed.html*
+{ cat src/test/c/accept/02-headers; echo ""; echo '# "Added"'; } > src/output/changed.txt
+SKIP_UNCHANGED_OUTPUT=true GZIP_OUTPUT=ALONGSIDE OUTPUT_FILE=changed.html build/Compiler < src/test/c/accept/02-headers >/dev/null 2>&1
+touch -d "2000-01-01" src/output/changed.html src/output/changed.html.gz
+SKIP_UNCHANGED_OUTPUT=true GZIP_OUTPUT=ALONGSIDE OUTPUT_FILE=changed.html build/Compiler < src/output/changed.txt >/dev/null 2>&1
+CHANGED_TAG="$(cat src/output/changed.html.etag 2>/dev/null)"
+if grep -q '<h1>Added</h1>' src/output/changed.html && gzip -dc src/output/changed.html.gz | cmp -s - src/output/changed.html \
+	&& [ "$(date -r src/output/changed.html +%Y)" != "2000" ]; then
+	echo -e "    a changed program, ${GREEN}and it's written again${OFF}"
+else
+	STATUS=1
+	echo -e "    a changed program, ${RED}but it isn't written again${OFF}"
+fi
+touch -d "2000-01-01" src/output/changed.html
+truncate -s 20 src/output/changed.html.gz
+SKIP_UNCHANGED_OUTPUT=true GZIP_OUTPUT=ALONGSIDE OUTPUT_FILE=changed.html build/Compiler < src/output/changed.txt >/dev/null 2>&1
+if gzip -dc src/output/changed.html.gz 2>/dev/null | cmp -s - src/output/changed.html && [ "$(date -r src/output/changed.html +%Y)" = "2000" ]; then
+	echo -e "    a compressed copy cut short, ${GREEN}and it's written again${OFF}"
+else
+	STATUS=1
+	echo -e "    a compressed copy cut short, ${RED}but it isn't written again${OFF}"
+fi
+cp src/output/changed.html.gz src/output/changed.level6.gz
+SKIP_UNCHANGED_OUTPUT=true GZIP_OUTPUT=ALONGSIDE GZIP_LEVEL=1 OUTPUT_FILE=changed.html build/Compiler < src/output/changed.txt >/dev/null 2>&1
+if gzip -dc src/output/changed.html.gz | cmp -s - src/output/changed.html && ! cmp -s src/output/changed.html.gz src/output/changed.level6.gz \
+	&& [ "$(cat src/output/changed.html.etag)" != "$CHANGED_TAG" ]; then
+	echo -e "    another compression level, ${GREEN}and it's written again${OFF}"
+else
+	STATUS=1
+	echo -e "    another compression level, ${RED}but it isn't written again${OFF}"
+fi
+rm -f src/output/changed.html src/output/changed.html.gz src/output/changed.html.etag src/output/changed.level6.gz src/output/changed.txt
+echo ""
+
+echo "Compiler should write the size of local images, and how every image loads..."
+echo ""
+
+printf 'GIF89a\x40\x01\xc8\x00' > src/output/size.gif
+for test in $(ls src/test/c/accept/); do
+	{ echo "@img('size.gif', 'first')"; cat "src/test/c/accept/$test"; echo ""; echo "@img('size.gif', 'last')"; } > src/output/images.txt
+	IMAGE_DIMENSIONS=true IMAGE_LOADING_HINTS=true OUTPUT_FILE=images.html build/Compiler < src/output/images.txt >/dev/null 2>&1
+	IMAGE_DIMENSIONS=true IMAGE_LOADING_HINTS=true BYTECODE_GENERATION=true OUTPUT_FILE=bytecode.html \
+		build/Compiler < src/output/images.txt >/dev/null 2>&1
+	if grep -q '<img src="size.gif" alt="first" width="320" height="200" fetchpriority="high"' src/output/images.html \
+		&& grep -q '<img src="size.gif" alt="last" width="320" height="200" loading="lazy" decoding="async"' src/output/images.html \
+		&& cmp -s src/output/images.html src/output/bytecode.html; then
+		echo -e "    $test, ${GREEN}and it does${OFF}"
+	else
+		STATUS=1
+		echo -e "    $test, ${RED}but it doesn't${OFF}"
+	fi
+done
+rm -f src/output/images.txt src/output/images.html src/output/bytecode.html
+echo ""
+
+echo "Compiler should read the size of JPEG images, minding their Exif orientation, even if it's cut short..."
+echo ""
+
+JPEG_FRAME='\xff\xc0\x00\x11\x08\x00\xc8\x01\x40\x03\x01\x22\x00\x02\x11\x01\x03\x11\x01\xff\xd9'
+printf "\xff\xd8\xff\xe1\x00\x22Exif\x00\x00II*\x00\x08\x00\x00\x00\x01\x00\x12\x01\x03\x00\x01\x00\x00\x00\x06\x00\x00\x00\x00\x00\x00\x00$JPEG_FRAME" > src/output/turned.jpg
+printf "\xff\xd8\xff\xe1\x00\x12Exif\x00\x00II*\x00\x08\x00\x00\x00\xff\xff$JPEG_FRAME" > src/output/truncated.jpg
+while IFS='|' read -r image size; do
+	echo "@img('$image', 'photo')" | IMAGE_DIMENSIONS=true OUTPUT_FILE=jpeg.html build/Compiler >/dev/null 2>&1
+	RESULT="$?"
+	if [ "$RESULT" == "0" ] && grep -q "<img src=\"$image\" alt=\"photo\" $size" src/output/jpeg.html; then
+		echo -e "    $image, ${GREEN}and it does${OFF}"
+	else
+		STATUS=1
+		echo -e "    $image, ${RED}but it doesn't${OFF} (status $RESULT)"
+	fi
+done <<'IMAGES'
+turned.jpg|width="200" height="320"
+truncated.jpg|width="320" height="200"
+IMAGES
+rm -f src/output/turned.jpg src/output/truncated.jpg src/output/jpeg.html
+echo ""
+
+echo "Compiler should tell the images of a define how to load in the order they're written..."
+echo ""
+
+cat > src/output/repeated.txt <<'PROGRAM'
+@define card
+@img('size.gif', 'card')
+@enddefine
+@define pair
+@use card
+# "pair"
+@use card
+@enddefine
+
+@use card
+@use card
+@use pair
+@use card
+PROGRAM
+for mode in "" LAZY_DEFINES=true STREAMING_GENERATION=true MINIFY=true; do
+	env $mode IMAGE_LOADING_HINTS=true OUTPUT_FILE=repeated.html build/Compiler < src/output/repeated.txt >/dev/null 2>&1
+	grep -o '<img [^>]*>' src/output/repeated.html > src/output/repeated.img
+	if [ "$(wc -l < src/output/repeated.img)" -eq 5 ] && head -n 1 src/output/repeated.img | grep -q 'fetchpriority="high"' \
+		&& [ "$(grep -c 'fetchpriority' src/output/repeated.img)" -eq 1 ] \
+		&& [ "$(tail -n +2 src/output/repeated.img | grep -c 'loading="lazy"')" -eq 4 ]; then
+		echo -e "    ${mode:-default}, ${GREEN}and it does${OFF}"
+	else
+		STATUS=1
+		echo -e "    ${mode:-default}, ${RED}but it doesn't${OFF}"
+	fi
+done
+rm -f src/output/size.gif src/output/repeated.txt src/output/repeated.html src/output/repeated.img
+echo ""
+
+echo "Compiler should write the JSON and the text of the page along with the same output, while it parses too..."
+echo ""
+
+for test in $(ls src/test/c/accept/); do
+	OUTPUT_FILE=sequential.html build/Compiler < "src/test/c/accept/$test" >/dev/null 2>&1
+	JSON_OUTPUT_FILE=page.json TEXT_OUTPUT_FILE=page.txt OUTPUT_FILE=sinks.html build/Compiler < "src/test/c/accept/$test" >/dev/null 2>&1
+	STREAMING_GENERATION=true JSON_OUTPUT_FILE=streaming.json TEXT_OUTPUT_FILE=streaming.txt OUTPUT_FILE=streaming.html \
+		build/Compiler < "src/test/c/accept/$test" >/dev/null 2>&1
+	if cmp -s src/output/sequential.html src/output/sinks.html && [ -s src/output/page.json ] \
+		&& cmp -s src/output/page.json src/output/streaming.json && cmp -s src/output/page.txt src/output/streaming.txt; then
+		echo -e "    $test, ${GREEN}and it does${OFF}"
+	else
+		STATUS=1
+		echo -e "    $test, ${RED}but it differs${OFF}"
+	fi
+done
+rm -f src/output/sequential.html src/output/sinks.html src/output/streaming.html src/output/page.json src/output/page.txt \
+	src/output/streaming.json src/output/streaming.txt
+echo ""
+
+echo "Compiler should translate into C that renders the same output..."
+echo ""
+
+DRIVER="$(mktemp -d)"
+cat > "$DRIVER/driver.c" <<'DRIVER'
+#include "native.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+int main(void) {
+	RenderBuffer buffer = { NULL, 0, 0 };
+	render_program(&buffer);
+	buffer.bytes = malloc(buffer.length);
+	buffer.capacity = buffer.length;
+	buffer.length = 0;
+	render_program(&buffer);
+	fwrite(buffer.bytes, 1, buffer.length, stdout);
+	free(buffer.bytes);
+	return 0;
+}
+DRIVER
+for test in $(ls src/test/c/accept/); do
+	rm -f src/output/native.c
+	NATIVE_OUTPUT_FILE=native.c OUTPUT_FILE=native.html build/Compiler < "src/test/c/accept/$test" >/dev/null 2>&1
+	if [ ! -f src/output/native.c ]; then
+		echo -e "    $test, which can't be translated"
+	elif cc -std=gnu99 -Wall -Werror -Isrc/output -o "$DRIVER/native" src/output/native.c "$DRIVER/driver.c" \
+		&& "$DRIVER/native" > "$DRIVER/native.html" && cmp -s "$DRIVER/native.html" src/output/native.html; then
+		echo -e "    $test, ${GREEN}and it does${OFF}"
+	else
+		STATUS=1
+		echo -e "    $test, ${RED}but it differs${OFF}"
+	fi
+done
+rm -rf "$DRIVER" src/output/native.c src/output/native.h src/output/native.html
+echo ""
+
 echo "All done."
 exit $STATUS
@@ -0,0 +1,65 @@
+#! /bin/bash
+
+set -u
+
+BASE_PATH="$(dirname "$0")/../.."
+cd "$BASE_PATH"
+
+USES="${1:-100000}"
+PROGRAM="$(mktemp)"
+
+# Every "@use" has distinct arguments, and the expansion cache is disabled, so
+# every body is generated again. They're grouped in sections of 500, like the
+# statements of a page would be.
+awk -v n="$USES" 'BEGIN {
+	print "@define card(title, text, kind)"
+	print "@card { background: red; padding: 8px; }"
+	print "# {{title}}"
+	print "@end"
+	print "@list"
+	print "* \"First\""
+	print "* \"Second\""
+	print "@end"
+	print "@if (kind = \"wide\")"
+	print "@row { gap: 4px; }"
+	print "@column { flex: 1; }"
+	print "{{text}}"
+	print "@end"
+	print "@column { flex: 2; }"
+	print "\"Details\""
+	print "@end"
+	print "@end"
+	print "@else"
+	print "{{text}}"
+	print "@end"
+	print "@enddefine"
+	for (i = 0; i < n; ++i) {
+		if (i % 500 == 0) {
+			print "@footer"
+		}
+		printf "@use card(\"Card %d\", \"Text %d\", \"%s\")\n", i, i, i % 2 == 0 ? "wide" : "narrow"
+		if (i % 500 == 499 || i == n - 1) {
+			print "@end"
+		}
+	}
+}' > "$PROGRAM"
+
+echo "Throughput of the tree walker and the bytecode interpreter ($USES uses)..."
+echo ""
+
+for bytecode in false true; do
+	START="$(date +%s%N)"
+	BYTECODE_GENERATION="$bytecode" USE_CACHE_BYTES=0 OUTPUT_FILE=throughput.html build/Compiler < "$PROGRAM" >/dev/null 2>&1
+	RESULT="$?"
+	TIME=$(( ($(date +%s%N) - START) / 1000000 + 1 ))
+	if [ "$RESULT" != "0" ]; then
+		echo "    BYTECODE_GENERATION=$bytecode: failed (status $RESULT)"
+		continue
+	fi
+	BYTES="$(stat -c %s src/output/throughput.html)"
+	echo "    BYTECODE_GENERATION=$bytecode: $TIME ms ($(( BYTES / 1024 * 1000 / TIME / 1024 )) MB/s)"
+done
+rm -f "$PROGRAM" src/output/throughput.html
+echo ""
+
+echo "All done."
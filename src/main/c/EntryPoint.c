@@ -1,4 +1,5 @@
 #include "backend/code-generation/Generator.h"
+#include "backend/code-generation/NativeGenerator.h"
 #include "frontend/lexical-analysis/FlexActions.h"
 #include "frontend/syntactic-analysis/AbstractSyntaxTree.h"
 #include "frontend/syntactic-analysis/BisonActions.h"
@@ -6,65 +7,195 @@
 #include "shared/CompilerState.h"
 #include "shared/Environment.h"
 #include "shared/Logger.h"
+#include "shared/ResourceGovernor.h"
+#include "shared/SourceCode.h"
 #include "shared/String.h"
 #include "shared/symbol-table/symbolTable.h"
 #include "shared/ErrorManager.h"
 
 /**
- * The main entry-point of the entire application. If you use "strtok" to
- * parse anything inside this project instead of using Flex and Bison, I will
- * find you, and I will kill you (Bryan Mills; "Taken", 2008).
+ * Initializes the modules of a compilation. The pages of a site are parsed
+ * once without the generators, to collect their styles (see "SITE_PAGES").
  */
-int main(const int count, const char ** arguments) {
-    Logger * logger = createLogger("EntryPoint");
+static void _initializeModules(const boolean generators) {
+    initializeResourceGovernorModule();
     initializeFlexActionsModule();
     initializeBisonActionsModule();
     initializeSyntacticAnalyzerModule();
     initializeAbstractSyntaxTreeModule();
-    initializeGeneratorModule();
+    initializeConstantFoldingModule();
+    if (generators) {
+        initializeGeneratorModule();
+        initializeNativeGeneratorModule();
+    }
+}
 
-    for (int k = 0; k < count; ++k) {
-        logDebugging(logger, "Argument %d: \"%s\"", k, arguments[k]);
+/**
+ * Shuts down the modules of a compilation, in reverse order.
+ */
+static void _shutdownModules(const boolean generators) {
+    if (generators) {
+        shutdownNativeGeneratorModule();
+        shutdownGeneratorModule();
     }
+    shutdownConstantFoldingModule();
+    shutdownAbstractSyntaxTreeModule();
+    shutdownSyntacticAnalyzerModule();
+    shutdownBisonActionsModule();
+    shutdownFlexActionsModule();
+    shutdownResourceGovernorModule();
+}
 
+/**
+ * Compiles the program read from the input. While a site is built, the first
+ * pass only collects the styles of its page, and the second one generates it
+ * with the styles of the whole site. Returns whether it succeeded.
+ */
+static boolean _compile(Logger * logger, FILE * input, StyleSheet * site, const boolean collect) {
+    _initializeModules(!collect);
     CompilerState compilerState = {
         .abstractSyntaxtTree = NULL,
         .succeed            = true,
         .symbolTable        = createSymbolTable(),
+        .sourceCode         = readSourceCode(input, maximumInputBytes()),
         .value              = 0,
-        .errorManager       = newErrorManager()
+        .errorManager       = newErrorManager(),
+        .streamStatement    = collect ? NULL : streamStatement
     };
 
-    SyntacticAnalysisStatus synStatus = parse(&compilerState);
+    governCompilation(&compilerState);
+
+    // The styles of a site are only used once it has been collected.
+    const boolean ready = site == NULL || collect || useSiteStyles(site);
+    SyntacticAnalysisStatus synStatus = REJECT;
+    if (ready && compilerState.sourceCode != NULL && chargeInputBytes(compilerState.sourceCode->length)) {
+        synStatus = parse(&compilerState);
+    }
 
     if (synStatus == ACCEPT && compilerState.succeed) {
-        logDebugging(logger, "Generating HTML output...");
-        generate(&compilerState);
-    } else {
-        if (synStatus != ACCEPT) {
+        if (collect) {
+            collectSiteStyles(&compilerState, site);
+        }
+        else {
+            logDebugging(logger, "Generating HTML output...");
+            generate(&compilerState);
+            if (compilerState.succeed) {
+                generateNative(&compilerState);
+            }
+        }
+    }
+    const boolean succeed = synStatus == ACCEPT && compilerState.succeed;
+    if (!succeed) {
+        if (compilerState.sourceCode == NULL) {
+            logError(logger, "The input program could not be read.");
+        }
+        else if (ready && synStatus != ACCEPT && !resourceLimitExceeded()) {
             logError(logger, "The syntactic-analysis phase rejects the input program.");
         }
         if (!compilerState.succeed) {
             showErrors(compilerState.errorManager);
         }
-        shutdownGeneratorModule();
-        shutdownAbstractSyntaxTreeModule();
-        shutdownSyntacticAnalyzerModule();
-        shutdownBisonActionsModule();
-        shutdownFlexActionsModule();
-        destroySymbolTable(compilerState.symbolTable);
-        freeErrorManager(compilerState.errorManager);
-        destroyLogger(logger);
-        return EXIT_FAILURE;
     }
-
-    shutdownGeneratorModule();
-    shutdownAbstractSyntaxTreeModule();
-    shutdownSyntacticAnalyzerModule();
-    shutdownBisonActionsModule();
-    shutdownFlexActionsModule();
+    _shutdownModules(!collect);
     destroySymbolTable(compilerState.symbolTable);
+    destroySourceCode(compilerState.sourceCode);
     freeErrorManager(compilerState.errorManager);
+    return succeed;
+}
+
+/**
+ * Compiles a page of a site. Its output is named after its file, without
+ * the directory nor the extension (e.g. "pages/about.txt" is "about.html").
+ */
+static boolean _compilePage(Logger * logger, const char * path, StyleSheet * site, const boolean collect) {
+    FILE * input = fopen(path, "r");
+    if (input == NULL) {
+        logError(logger, "The page \"%s\" could not be read: %s.", path, strerror(errno));
+        return false;
+    }
+    if (!collect) {
+        const char * slash = strrchr(path, '/');
+        const char * name = slash == NULL ? path : slash + 1;
+        const char * dot = strrchr(name, '.');
+        const size_t length = dot == NULL || dot == name ? strlen(name) : (size_t) (dot - name);
+        char * output = malloc(length + sizeof(".html"));
+        memcpy(output, name, length);
+        memcpy(output + length, ".html", sizeof(".html"));
+        setenv("OUTPUT_FILE", output, true);
+        free(output);
+        logDebugging(logger, "Generating the page \"%s\"...", path);
+    }
+    const boolean succeed = _compile(logger, input, site, collect);
+    fclose(input);
+    return succeed;
+}
+
+/**
+ * Builds every page of a site (a list of files, separated by commas). The
+ * first pass parses all of them to collect their styles, and the second one
+ * parses each page again and generates it. The pages are held until every
+ * one of them has been generated, so no page is replaced unless all of them
+ * compile.
+ */
+static boolean _buildSite(Logger * logger, const char * pages) {
+    StyleSheet * site = createStyleSheet(0);
+    boolean succeed = true;
+    unsigned int count = 0;
+    for (unsigned int pass = 0; pass < 2 && succeed; ++pass) {
+        if (pass == 1) {
+            holdOutputs();
+        }
+        const char * page = pages;
+        while (*page != '\0') {
+            const char * comma = strchr(page, ',');
+            const size_t length = comma == NULL ? strlen(page) : (size_t) (comma - page);
+            if (length > 0) {
+                char * path = strndup(page, length);
+                succeed = _compilePage(logger, path, site, pass == 0) && succeed;
+                count += pass == 0 ? 1 : 0;
+                free(path);
+            }
+            page += length + (comma == NULL ? 0 : 1);
+            if (pass == 0 && !succeed) {
+                break;
+            }
+        }
+    }
+    if (succeed) {
+        succeed = releaseOutputs(true);
+    }
+    else {
+        releaseOutputs(false);
+        logError(logger, "No page of the site was replaced, because not every one of them compiled.");
+    }
+    if (succeed) {
+        unsigned int shared = 0;
+        for (unsigned int k = 0; k < styleRules(site); ++k) {
+            shared += styleRule(site, k)->pages > 1 ? 1 : 0;
+        }
+        logInformation(logger, "Built a site of %u pages, which share %u of their %u style rules.", count, shared, styleRules(site));
+    }
+    destroyStyleSheet(site);
+    return succeed;
+}
+
+/**
+ * The main entry-point of the entire application. If you use "strtok" to
+ * parse anything inside this project instead of using Flex and Bison, I will
+ * find you, and I will kill you (Bryan Mills; "Taken", 2008).
+ */
+int main(const int count, const char ** arguments) {
+    exportArgumentsToEnvironment(count, arguments);
+    Logger * logger = createLogger("EntryPoint");
+
+    for (int k = 0; k < count; ++k) {
+        logDebugging(logger, "Argument %d: \"%s\"", k, arguments[k]);
+    }
+
+    const char * pages = getStringOrDefault("SITE_PAGES", "");
+    const boolean succeed = pages[0] == '\0'
+        ? _compile(logger, stdin, NULL, false)
+        : _buildSite(logger, pages);
     destroyLogger(logger);
-    return EXIT_SUCCESS;
-}
\ No newline at end of file
+    return succeed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
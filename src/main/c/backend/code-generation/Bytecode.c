@@ -0,0 +1,61 @@
+#include "Bytecode.h"
+
+/* PRIVATE FUNCTIONS */
+
+static const size_t _initialCapacity = 64;
+
+/**
+ * Whether the bytes of an instruction are in the constants of its code.
+ */
+static boolean _hasConstants(const Opcode opcode) {
+	switch (opcode) {
+		case OP_STATIC:
+		case OP_LINE:
+		case OP_NODE:
+		case OP_ARGUMENT:
+			return true;
+		default:
+			return false;
+	}
+}
+
+/* PUBLIC FUNCTIONS */
+
+Bytecode * createBytecode() {
+	Bytecode * code = calloc(1, sizeof(Bytecode));
+	code->capacity = _initialCapacity;
+	code->instructions = malloc(_initialCapacity * sizeof(Instruction));
+	openOutputBuffer(&code->constants, -1, 0);
+	reserveOutputBuffer(&code->constants, _initialCapacity);
+	return code;
+}
+
+size_t appendInstruction(Bytecode * code, const Opcode opcode, const unsigned int depth) {
+	if (code->count == code->capacity) {
+		code->capacity *= 2;
+		code->instructions = realloc(code->instructions, code->capacity * sizeof(Instruction));
+	}
+	Instruction * instruction = &code->instructions[code->count];
+	memset(instruction, 0, sizeof(Instruction));
+	instruction->opcode = opcode;
+	instruction->depth = depth;
+	return code->count++;
+}
+
+void finishBytecode(Bytecode * code) {
+	for (size_t k = 0; k < code->count; ++k) {
+		Instruction * instruction = &code->instructions[k];
+		if (_hasConstants(instruction->opcode)) {
+			instruction->bytes = code->constants.bytes + instruction->offset;
+		}
+	}
+}
+
+void destroyBytecode(Bytecode * code) {
+	if (code == NULL) {
+		return;
+	}
+	closeOutputBuffer(&code->constants);
+	free(code->instructions);
+	free(code);
+}
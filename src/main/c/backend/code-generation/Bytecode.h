@@ -0,0 +1,100 @@
+#ifndef BYTECODE_HEADER
+#define BYTECODE_HEADER
+
+#include "../../frontend/syntactic-analysis/AbstractSyntaxTree.h"
+#include "OutputBuffer.h"
+#include <stdlib.h>
+
+/**
+ * The operations of the linear code that the generator compiles a statement
+ * list into (see "BYTECODE_GENERATION"). Depths are relative to the
+ * indentation level where the code runs, so the body of a define is compiled
+ * once, and run at the level of every "@use".
+ */
+typedef enum {
+	// Enters the nesting level of a statement, or jumps over it if a limit
+	// was exceeded.
+	OP_ENTER = 0,
+	OP_LEAVE,
+	OP_BEGIN_LINE,
+	OP_END_LINE,
+	// Writes constant bytes.
+	OP_STATIC,
+	// A line of constant bytes (BEGIN_LINE, STATIC and END_LINE).
+	OP_LINE,
+	// A statement that is a line of constant bytes (ENTER, LINE and LEAVE).
+	OP_NODE,
+	// Writes the argument bound to a parameter, or the constant bytes if
+	// there's none.
+	OP_ARGUMENT,
+	// Jumps unless the argument bound to a parameter is the constant, or if
+	// it is.
+	OP_BRANCH_UNLESS_EQUAL,
+	OP_BRANCH_IF_EQUAL,
+	OP_JUMP,
+	// Expands a "@use".
+	OP_CALL,
+	// Leaves a statement to the tree walker ("@each", "@define" and folded
+	// static fragments).
+	OP_VISIT,
+	// Flushes the output after a top-level statement.
+	OP_FLUSH,
+	OP_RETURN
+} Opcode;
+
+typedef struct Instruction {
+	Opcode opcode;
+	unsigned int depth;
+	// The constant bytes (their offset in the constants, until the code is
+	// finished).
+	union {
+		const char * bytes;
+		size_t offset;
+	};
+	size_t length;
+	union {
+		// The bytes that the minified output leaves out of the constant ones.
+		size_t saved;
+		// How many instructions forward a jump goes.
+		size_t jump;
+	};
+	union {
+		// The position of a parameter in the define.
+		size_t slot;
+		Statement * statement;
+	};
+} Instruction;
+
+typedef struct Bytecode {
+	Instruction * instructions;
+	size_t count;
+	size_t capacity;
+	// The bytes of every instruction that writes constant bytes.
+	OutputBuffer constants;
+	// Codes are kept in a list until the output is closed, because the output
+	// can point at their constants.
+	struct Bytecode * next;
+} Bytecode;
+
+/**
+ * Creates an empty code.
+ */
+Bytecode * createBytecode();
+
+/**
+ * Appends an instruction, and returns its position.
+ */
+size_t appendInstruction(Bytecode * code, const Opcode opcode, const unsigned int depth);
+
+/**
+ * Points the instructions at their constant bytes, once nothing else is
+ * appended to the code.
+ */
+void finishBytecode(Bytecode * code);
+
+/**
+ * Releases the code.
+ */
+void destroyBytecode(Bytecode * code);
+
+#endif
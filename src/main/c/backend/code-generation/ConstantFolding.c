@@ -0,0 +1,318 @@
+#include "ConstantFolding.h"
+
+/* MODULE INTERNAL STATE */
+
+static Logger * _logger = NULL;
+static unsigned int _foldedStatements = 0;
+
+/**
+ * The lists of statements being folded. The tree is walked in post-order
+ * with an explicit stack of these (instead of C recursion), so programs can
+ * nest arbitrarily deep. The staticness of every member is reported to its
+ * group as soon as it's known.
+ */
+typedef enum {
+	// A list whose staticness is reported to its parent statement.
+	GROUP_LIST,
+	// A list folded on its own (a program, a define body, a branch).
+	GROUP_ROOT,
+	// The single statement in the body of a list item.
+	GROUP_ITEM,
+	// The cells of a table, each one a list.
+	GROUP_TABLE
+} GroupType;
+
+typedef struct Group {
+	GroupType type;
+	boolean isStatic;
+	StatementList * head;
+	StatementList * current;
+	StatementList * next;
+	Statement * item;
+	Table * table;
+	TableRowList * nextRow;
+	TableCellList * cell;
+} Group;
+
+static Group * _groups = NULL;
+static size_t _groupCount = 0;
+static size_t _groupCapacity = 0;
+
+void initializeConstantFoldingModule() {
+	_logger = createLogger("ConstantFolding");
+}
+
+void shutdownConstantFoldingModule() {
+	if (_logger != NULL) {
+		logDebugging(_logger, "Folded statements: %u", _foldedStatements);
+		destroyLogger(_logger);
+	}
+	free(_groups);
+	_groups = NULL;
+	_groupCount = 0;
+	_groupCapacity = 0;
+}
+
+/* PRIVATE FUNCTIONS */
+
+static boolean _isStaticText(Text * text, SymbolTable * symbolTable);
+static Statement * _toStaticHtml(Statement * statement);
+static void _foldStaticList(StatementList * list);
+static void _foldCellsBefore(Group * group);
+static Group * _pushGroup(const GroupType type);
+static void _pushList(const GroupType type, StatementList * list);
+static void _pushItem(Statement * body);
+static void _report(Group * group, const boolean isStatic);
+static void _visit(Statement * statement, SymbolTable * symbolTable);
+static void _finishGroup(void);
+static void _run(const size_t base, SymbolTable * symbolTable);
+
+/**
+ * A text is only static if the generator can't resolve its content as a
+ * variable.
+ */
+static boolean _isStaticText(Text * text, SymbolTable * symbolTable) {
+	Symbol * symbol = symbolTableLookup(symbolTable, text->content);
+	return symbol == NULL || symbol->type != SYM_VAR;
+}
+
+/**
+ * Wraps a static statement, so it's rendered only once.
+ */
+static Statement * _toStaticHtml(Statement * statement) {
+	StaticHtml * staticHtml = calloc(1, sizeof(StaticHtml));
+	staticHtml->original = statement;
+	Statement * folded = calloc(1, sizeof(Statement));
+	folded->type = STATEMENT_STATIC_HTML;
+	folded->static_html = staticHtml;
+	++_foldedStatements;
+	return folded;
+}
+
+/**
+ * Folds every statement of a list known to be static.
+ */
+static void _foldStaticList(StatementList * list) {
+	for (StatementList * it = list; it != NULL; it = it->next) {
+		if (it->statement != NULL && it->statement->type != STATEMENT_STATIC_HTML) {
+			it->statement = _toStaticHtml(it->statement);
+		}
+	}
+}
+
+/**
+ * Folds the cells of a table that come before the one being folded.
+ */
+static void _foldCellsBefore(Group * group) {
+	for (TableRowList * row = group->table->rows; row != NULL; row = row->next) {
+		for (TableCellList * cell = row->row->cells; cell != NULL; cell = cell->next) {
+			if (cell == group->cell) {
+				return;
+			}
+			_foldStaticList(cell->cell->content);
+		}
+	}
+}
+
+static Group * _pushGroup(const GroupType type) {
+	if (_groupCount == _groupCapacity) {
+		_groupCapacity = _groupCapacity == 0 ? 64 : 2 * _groupCapacity;
+		_groups = realloc(_groups, _groupCapacity * sizeof(Group));
+	}
+	Group * group = &_groups[_groupCount++];
+	memset(group, 0, sizeof(Group));
+	group->type = type;
+	group->isStatic = true;
+	return group;
+}
+
+static void _pushList(const GroupType type, StatementList * list) {
+	Group * group = _pushGroup(type);
+	group->head = list;
+	group->next = list;
+}
+
+/**
+ * An item is only static if it has a body, and its body is static.
+ */
+static void _pushItem(Statement * body) {
+	Group * group = _pushGroup(GROUP_ITEM);
+	group->item = body;
+	group->isStatic = false;
+}
+
+/**
+ * Takes note of the staticness of the member being folded. While a list is
+ * static, its static members are left for the parent to fold; as soon as one
+ * member isn't, those before it are folded, and so is every static member
+ * after it. Every statement is visited once, so the pass is linear in the
+ * tree size.
+ */
+static void _report(Group * group, const boolean isStatic) {
+	switch (group->type) {
+		case GROUP_ITEM:
+			group->isStatic = isStatic;
+			break;
+		case GROUP_TABLE:
+			if (isStatic && !group->isStatic) {
+				_foldStaticList(group->cell->cell->content);
+			}
+			else if (!isStatic && group->isStatic) {
+				group->isStatic = false;
+				_foldCellsBefore(group);
+			}
+			break;
+		default:
+			if (isStatic && !group->isStatic && group->current->statement->type != STATEMENT_STATIC_HTML) {
+				group->current->statement = _toStaticHtml(group->current->statement);
+			}
+			else if (!isStatic && group->isStatic) {
+				group->isStatic = false;
+				for (StatementList * it = group->head; it != group->current; it = it->next) {
+					if (it->statement != NULL && it->statement->type != STATEMENT_STATIC_HTML) {
+						it->statement = _toStaticHtml(it->statement);
+					}
+				}
+			}
+			break;
+	}
+}
+
+/**
+ * Reports the staticness of a statement to the group on top, or pushes the
+ * groups of its children if it has to wait for them.
+ */
+static void _visit(Statement * statement, SymbolTable * symbolTable) {
+	switch (statement->type) {
+		case STATEMENT_HEADER1:
+		case STATEMENT_HEADER2:
+		case STATEMENT_HEADER3:
+		case STATEMENT_PARAGRAPH:
+			_report(&_groups[_groupCount - 1], _isStaticText(statement->text, symbolTable));
+			break;
+		case STATEMENT_IMAGE:
+		case STATEMENT_NAV:
+		case STATEMENT_FORM:
+		case STATEMENT_STATIC_HTML:
+			_report(&_groups[_groupCount - 1], true);
+			break;
+		case STATEMENT_FOOTER:
+			_pushList(GROUP_LIST, statement->footer->body);
+			break;
+		case STATEMENT_CARD:
+			_pushList(GROUP_LIST, statement->card->body);
+			break;
+		case STATEMENT_BUTTON:
+			_pushList(GROUP_LIST, statement->button->body);
+			break;
+		case STATEMENT_COLUMN:
+			_pushList(GROUP_LIST, statement->column->body);
+			break;
+		case STATEMENT_ROW:
+			_pushList(GROUP_LIST, statement->row->columns);
+			break;
+		case STATEMENT_UNORDERED_LIST:
+			_pushList(GROUP_LIST, statement->unordered_list->items);
+			break;
+		case STATEMENT_ORDERED_LIST:
+			_pushList(GROUP_LIST, statement->ordered_list->items);
+			break;
+		case STATEMENT_BULLET_ITEM:
+			_pushItem(statement->bullet_item->body);
+			break;
+		case STATEMENT_ORDERED_ITEM:
+			_pushItem(statement->ordered_item->body);
+			break;
+		case STATEMENT_TABLE: {
+			Group * group = _pushGroup(GROUP_TABLE);
+			group->table = statement->table;
+			group->nextRow = statement->table->rows;
+			break;
+		}
+		case STATEMENT_DEFINE:
+			_report(&_groups[_groupCount - 1], false);
+			_pushList(GROUP_ROOT, statement->define->body);
+			break;
+		case STATEMENT_CONDITIONAL:
+			_report(&_groups[_groupCount - 1], false);
+			_pushList(GROUP_ROOT, statement->conditional->elseBody);
+			_pushList(GROUP_ROOT, statement->conditional->thenBody);
+			break;
+		case STATEMENT_USE:
+		default:
+			_report(&_groups[_groupCount - 1], false);
+			break;
+	}
+}
+
+/**
+ * Pops the group on top, and reports its staticness to its parent (or, if
+ * it's folded on its own, folds it entirely when it's static).
+ */
+static void _finishGroup(void) {
+	Group group = _groups[--_groupCount];
+	if (group.type == GROUP_ROOT) {
+		if (group.isStatic) {
+			_foldStaticList(group.head);
+		}
+		return;
+	}
+	_report(&_groups[_groupCount - 1], group.isStatic);
+}
+
+/**
+ * Folds the groups on top of the stack until it goes back to the given
+ * height.
+ */
+static void _run(const size_t base, SymbolTable * symbolTable) {
+	while (_groupCount > base) {
+		Group * group = &_groups[_groupCount - 1];
+		switch (group->type) {
+			case GROUP_ITEM: {
+				Statement * item = group->item;
+				if (item == NULL) {
+					_finishGroup();
+					break;
+				}
+				group->item = NULL;
+				_visit(item, symbolTable);
+				break;
+			}
+			case GROUP_TABLE: {
+				TableCellList * cell = group->cell != NULL ? group->cell->next : NULL;
+				while (cell == NULL && group->nextRow != NULL) {
+					cell = group->nextRow->row->cells;
+					group->nextRow = group->nextRow->next;
+				}
+				group->cell = cell;
+				if (cell == NULL) {
+					_finishGroup();
+					break;
+				}
+				_pushList(GROUP_LIST, cell->cell->content);
+				break;
+			}
+			default: {
+				StatementList * member = group->next;
+				if (member == NULL) {
+					_finishGroup();
+					break;
+				}
+				group->current = member;
+				group->next = member->next;
+				if (member->statement != NULL) {
+					_visit(member->statement, symbolTable);
+				}
+				break;
+			}
+		}
+	}
+}
+
+/* PUBLIC FUNCTIONS */
+
+void foldStatementList(StatementList * list, SymbolTable * symbolTable) {
+	const size_t base = _groupCount;
+	_pushList(GROUP_ROOT, list);
+	_run(base, symbolTable);
+}
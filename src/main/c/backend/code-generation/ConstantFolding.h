@@ -0,0 +1,25 @@
+#ifndef CONSTANT_FOLDING_HEADER
+#define CONSTANT_FOLDING_HEADER
+
+#include "../../frontend/syntactic-analysis/AbstractSyntaxTree.h"
+#include "../../shared/Logger.h"
+#include "../../shared/symbol-table/symbolTable.h"
+#include <stdlib.h>
+#include <string.h>
+
+/** Initialize module's internal state. */
+void initializeConstantFoldingModule();
+
+/** Shutdown module's internal state. */
+void shutdownConstantFoldingModule();
+
+/**
+ * Collapses every maximal subtree that can't reference a variable into a
+ * single STATEMENT_STATIC_HTML node, in place. The generator renders those
+ * nodes once (per indentation level), and then only copies their HTML. Text
+ * is static unless its content names a variable of the symbol table, since
+ * the generator may replace it with the value of that variable.
+ */
+void foldStatementList(StatementList * list, SymbolTable * symbolTable);
+
+#endif
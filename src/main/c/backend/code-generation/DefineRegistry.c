@@ -0,0 +1,130 @@
+#include "DefineRegistry.h"
+
+/* MODULE INTERNAL STATE */
+
+static const unsigned int _initialSlots = 64;
+
+/**
+ * A slot of the hash table: the hash of a name, and the position of its
+ * define in registration order (or 0 if the slot is empty).
+ */
+typedef struct {
+	size_t hash;
+	unsigned int position;
+} Slot;
+
+struct DefineRegistry {
+	Define ** defines;
+	unsigned int count;
+	unsigned int capacity;
+	Slot * slots;
+	// Always a power of 2.
+	unsigned int slotCount;
+};
+
+/* PRIVATE FUNCTIONS */
+
+static size_t _hash(const char * name);
+static unsigned int _findSlot(const DefineRegistry * registry, const char * name, const size_t hash);
+static void _grow(DefineRegistry * registry);
+
+/**
+ * The FNV-1a hash of a name.
+ */
+static size_t _hash(const char * name) {
+	size_t hash = (size_t) 14695981039346656037ULL;
+	for (const unsigned char * c = (const unsigned char *) name; *c != '\0'; ++c) {
+		hash = (hash ^ *c) * (size_t) 1099511628211ULL;
+	}
+	return hash;
+}
+
+/**
+ * The slot that holds the name, or the empty slot where it should go.
+ */
+static unsigned int _findSlot(const DefineRegistry * registry, const char * name, const size_t hash) {
+	const unsigned int mask = registry->slotCount - 1;
+	unsigned int k = (unsigned int) hash & mask;
+	for (;;) {
+		const Slot * slot = &registry->slots[k];
+		if (slot->position == 0) {
+			return k;
+		}
+		if (slot->hash == hash && strcmp(registry->defines[slot->position - 1]->name, name) == 0) {
+			return k;
+		}
+		k = (k + 1) & mask;
+	}
+}
+
+/**
+ * Doubles the hash table, so that it's never more than half full.
+ */
+static void _grow(DefineRegistry * registry) {
+	Slot * slots = registry->slots;
+	const unsigned int slotCount = registry->slotCount;
+	registry->slotCount = 2 * slotCount;
+	registry->slots = calloc(registry->slotCount, sizeof(Slot));
+	const unsigned int mask = registry->slotCount - 1;
+	for (unsigned int k = 0; k < slotCount; ++k) {
+		if (slots[k].position == 0) {
+			continue;
+		}
+		unsigned int j = (unsigned int) slots[k].hash & mask;
+		while (registry->slots[j].position != 0) {
+			j = (j + 1) & mask;
+		}
+		registry->slots[j] = slots[k];
+	}
+	free(slots);
+}
+
+/* PUBLIC FUNCTIONS */
+
+DefineRegistry * createDefineRegistry() {
+	DefineRegistry * registry = calloc(1, sizeof(DefineRegistry));
+	registry->slotCount = _initialSlots;
+	registry->slots = calloc(registry->slotCount, sizeof(Slot));
+	return registry;
+}
+
+boolean registerDefine(DefineRegistry * registry, Define * define) {
+	const size_t hash = _hash(define->name);
+	const unsigned int k = _findSlot(registry, define->name, hash);
+	if (registry->slots[k].position != 0) {
+		return false;
+	}
+	if (registry->count == registry->capacity) {
+		registry->capacity = registry->capacity == 0 ? 16 : 2 * registry->capacity;
+		registry->defines = realloc(registry->defines, registry->capacity * sizeof(Define *));
+	}
+	registry->defines[registry->count++] = define;
+	registry->slots[k].hash = hash;
+	registry->slots[k].position = registry->count;
+	if (2 * registry->count > registry->slotCount) {
+		_grow(registry);
+	}
+	return true;
+}
+
+Define * findDefine(const DefineRegistry * registry, const char * name) {
+	const Slot * slot = &registry->slots[_findSlot(registry, name, _hash(name))];
+	return slot->position == 0 ? NULL : registry->defines[slot->position - 1];
+}
+
+unsigned int registeredDefines(const DefineRegistry * registry) {
+	return registry->count;
+}
+
+Define * registeredDefine(const DefineRegistry * registry, const unsigned int k) {
+	return registry->defines[k];
+}
+
+void destroyDefineRegistry(DefineRegistry * registry) {
+	if (registry == NULL) {
+		return;
+	}
+	free(registry->slots);
+	free(registry->defines);
+	free(registry);
+}
@@ -0,0 +1,47 @@
+#ifndef DEFINE_REGISTRY_HEADER
+#define DEFINE_REGISTRY_HEADER
+
+#include "../../frontend/syntactic-analysis/AbstractSyntaxTree.h"
+#include "../../shared/Type.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * The defines known to the generator, indexed by name in an open-addressing
+ * hash table. The defines are not copied: the registry only points to the
+ * nodes of the abstract syntax tree, which keeps owning them.
+ */
+typedef struct DefineRegistry DefineRegistry;
+
+/**
+ * Creates an empty registry.
+ */
+DefineRegistry * createDefineRegistry();
+
+/**
+ * Registers a define. If there's already one with the same name, it's kept
+ * (the first definition wins) and false is returned.
+ */
+boolean registerDefine(DefineRegistry * registry, Define * define);
+
+/**
+ * The define registered with the given name, or NULL.
+ */
+Define * findDefine(const DefineRegistry * registry, const char * name);
+
+/**
+ * The amount of defines registered.
+ */
+unsigned int registeredDefines(const DefineRegistry * registry);
+
+/**
+ * The k-th define registered, in order of registration.
+ */
+Define * registeredDefine(const DefineRegistry * registry, const unsigned int k);
+
+/**
+ * Releases the registry (but not the defines).
+ */
+void destroyDefineRegistry(DefineRegistry * registry);
+
+#endif
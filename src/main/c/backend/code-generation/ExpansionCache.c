@@ -0,0 +1,231 @@
+#include "ExpansionCache.h"
+
+/* MODULE INTERNAL STATE */
+
+static const unsigned int _initialBuckets = 256;
+
+struct ExpansionCache {
+	size_t maximumBytes;
+	CachedExpansion ** buckets;
+	// Always a power of 2.
+	unsigned int bucketCount;
+	// The most and the least recently used expansions.
+	CachedExpansion * newest;
+	CachedExpansion * oldest;
+	ExpansionCacheStatistics statistics;
+};
+
+/* PRIVATE FUNCTIONS */
+
+static size_t _hashBytes(size_t hash, const void * bytes, const size_t length);
+static size_t _hash(const Define * define, const ParameterList * arguments, const unsigned int indentation);
+static boolean _matches(const CachedExpansion * expansion, const Define * define, const ParameterList * arguments, const unsigned int indentation);
+static void _unlink(ExpansionCache * cache, CachedExpansion * expansion);
+static void _pushNewest(ExpansionCache * cache, CachedExpansion * expansion);
+static void _evict(ExpansionCache * cache, CachedExpansion * expansion);
+static void _grow(ExpansionCache * cache);
+
+/**
+ * Continues a FNV-1a hash with some bytes.
+ */
+static size_t _hashBytes(size_t hash, const void * bytes, const size_t length) {
+	const unsigned char * byte = bytes;
+	for (size_t k = 0; k < length; ++k) {
+		hash = (hash ^ byte[k]) * (size_t) 1099511628211ULL;
+	}
+	return hash;
+}
+
+static size_t _hash(const Define * define, const ParameterList * arguments, const unsigned int indentation) {
+	size_t hash = (size_t) 14695981039346656037ULL;
+	hash = _hashBytes(hash, &define, sizeof(define));
+	hash = _hashBytes(hash, &indentation, sizeof(indentation));
+	for (const Parameter * p = arguments ? arguments->head : NULL; p; p = p->next) {
+		// The terminator separates the arguments.
+		hash = _hashBytes(hash, p->value, strlen(p->value) + 1);
+	}
+	return hash;
+}
+
+static boolean _matches(const CachedExpansion * expansion, const Define * define, const ParameterList * arguments, const unsigned int indentation) {
+	if (expansion->define != define || expansion->indentation != indentation) {
+		return false;
+	}
+	unsigned int k = 0;
+	const Parameter * p = arguments ? arguments->head : NULL;
+	while (p && k < expansion->argumentCount && strcmp(p->value, expansion->arguments[k]) == 0) {
+		p = p->next;
+		++k;
+	}
+	return p == NULL && k == expansion->argumentCount;
+}
+
+/**
+ * Takes an expansion out of the recency list.
+ */
+static void _unlink(ExpansionCache * cache, CachedExpansion * expansion) {
+	if (expansion->newer) {
+		expansion->newer->older = expansion->older;
+	}
+	else {
+		cache->newest = expansion->older;
+	}
+	if (expansion->older) {
+		expansion->older->newer = expansion->newer;
+	}
+	else {
+		cache->oldest = expansion->newer;
+	}
+	expansion->newer = NULL;
+	expansion->older = NULL;
+}
+
+static void _pushNewest(ExpansionCache * cache, CachedExpansion * expansion) {
+	expansion->older = cache->newest;
+	expansion->newer = NULL;
+	if (cache->newest) {
+		cache->newest->newer = expansion;
+	}
+	cache->newest = expansion;
+	if (cache->oldest == NULL) {
+		cache->oldest = expansion;
+	}
+}
+
+/**
+ * Removes an expansion from the cache, and releases it.
+ */
+static void _evict(ExpansionCache * cache, CachedExpansion * expansion) {
+	CachedExpansion ** link = &cache->buckets[expansion->hash & (cache->bucketCount - 1)];
+	while (*link != expansion) {
+		link = &(*link)->nextInBucket;
+	}
+	*link = expansion->nextInBucket;
+	_unlink(cache, expansion);
+	cache->statistics.bytes -= expansion->bytes;
+	--cache->statistics.entries;
+	releaseCachedExpansion(expansion);
+}
+
+/**
+ * Doubles the buckets, so that there's at most one expansion per bucket on
+ * average.
+ */
+static void _grow(ExpansionCache * cache) {
+	const unsigned int bucketCount = 2 * cache->bucketCount;
+	CachedExpansion ** buckets = calloc(bucketCount, sizeof(CachedExpansion *));
+	for (unsigned int k = 0; k < cache->bucketCount; ++k) {
+		CachedExpansion * expansion = cache->buckets[k];
+		while (expansion) {
+			CachedExpansion * next = expansion->nextInBucket;
+			CachedExpansion ** bucket = &buckets[expansion->hash & (bucketCount - 1)];
+			expansion->nextInBucket = *bucket;
+			*bucket = expansion;
+			expansion = next;
+		}
+	}
+	free(cache->buckets);
+	cache->buckets = buckets;
+	cache->bucketCount = bucketCount;
+}
+
+/* PUBLIC FUNCTIONS */
+
+ExpansionCache * createExpansionCache(const size_t maximumBytes) {
+	ExpansionCache * cache = calloc(1, sizeof(ExpansionCache));
+	cache->maximumBytes = maximumBytes;
+	cache->bucketCount = _initialBuckets;
+	cache->buckets = calloc(cache->bucketCount, sizeof(CachedExpansion *));
+	return cache;
+}
+
+CachedExpansion * findCachedExpansion(ExpansionCache * cache, const Define * define, const ParameterList * arguments, const unsigned int indentation) {
+	if (cache->statistics.entries > 0) {
+		const size_t hash = _hash(define, arguments, indentation);
+		for (CachedExpansion * it = cache->buckets[hash & (cache->bucketCount - 1)]; it; it = it->nextInBucket) {
+			if (it->hash == hash && _matches(it, define, arguments, indentation)) {
+				_unlink(cache, it);
+				_pushNewest(cache, it);
+				++cache->statistics.hits;
+				return it;
+			}
+		}
+	}
+	++cache->statistics.misses;
+	return NULL;
+}
+
+CachedExpansion * newCachedExpansion(const Define * define, const ParameterList * arguments, const unsigned int indentation) {
+	CachedExpansion * expansion = calloc(1, sizeof(CachedExpansion));
+	expansion->define = define;
+	expansion->indentation = indentation;
+	expansion->hash = _hash(define, arguments, indentation);
+	size_t argumentBytes = 0;
+	for (const Parameter * p = arguments ? arguments->head : NULL; p; p = p->next) {
+		++expansion->argumentCount;
+		argumentBytes += strlen(p->value) + 1;
+	}
+	// The copies of the arguments follow their pointers, in a single block.
+	expansion->arguments = malloc((expansion->argumentCount + 1) * sizeof(char *) + argumentBytes);
+	char * copy = (char *) (expansion->arguments + expansion->argumentCount + 1);
+	unsigned int k = 0;
+	for (const Parameter * p = arguments ? arguments->head : NULL; p; p = p->next) {
+		const size_t length = strlen(p->value) + 1;
+		memcpy(copy, p->value, length);
+		expansion->arguments[k++] = copy;
+		copy += length;
+	}
+	expansion->arguments[k] = NULL;
+	expansion->bytes = sizeof(CachedExpansion) + (expansion->argumentCount + 1) * sizeof(char *) + argumentBytes;
+	return expansion;
+}
+
+boolean storeCachedExpansion(ExpansionCache * cache, CachedExpansion * expansion) {
+	expansion->bytes += expansion->length;
+	if (cache->maximumBytes < expansion->bytes) {
+		return false;
+	}
+	while (cache->maximumBytes - cache->statistics.bytes < expansion->bytes) {
+		_evict(cache, cache->oldest);
+		++cache->statistics.evictions;
+	}
+	CachedExpansion ** bucket = &cache->buckets[expansion->hash & (cache->bucketCount - 1)];
+	expansion->nextInBucket = *bucket;
+	*bucket = expansion;
+	_pushNewest(cache, expansion);
+	cache->statistics.bytes += expansion->bytes;
+	if (cache->statistics.peakBytes < cache->statistics.bytes) {
+		cache->statistics.peakBytes = cache->statistics.bytes;
+	}
+	if (++cache->statistics.entries > cache->bucketCount) {
+		_grow(cache);
+	}
+	return true;
+}
+
+void releaseCachedExpansion(CachedExpansion * expansion) {
+	if (expansion == NULL) {
+		return;
+	}
+	free(expansion->arguments);
+	free(expansion->html);
+	free(expansion);
+}
+
+ExpansionCacheStatistics expansionCacheStatistics(const ExpansionCache * cache) {
+	return cache->statistics;
+}
+
+void destroyExpansionCache(ExpansionCache * cache) {
+	if (cache == NULL) {
+		return;
+	}
+	CachedExpansion * expansion = cache->newest;
+	while (expansion) {
+		CachedExpansion * older = expansion->older;
+		releaseCachedExpansion(expansion);
+		expansion = older;
+	}
+	free(cache->buckets);
+	free(cache);
+}
@@ -0,0 +1,93 @@
+#ifndef EXPANSION_CACHE_HEADER
+#define EXPANSION_CACHE_HEADER
+
+#include "../../frontend/syntactic-analysis/AbstractSyntaxTree.h"
+#include "../../shared/Type.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * The body of a "@define" already expanded for a concrete argument vector
+ * (every argument is a literal), and rendered at a fixed indentation level.
+ */
+typedef struct CachedExpansion {
+	const Define * define;
+	// A copy of the arguments.
+	char ** arguments;
+	unsigned int argumentCount;
+	unsigned int indentation;
+	char * html;
+	size_t length;
+	// The nodes expanded to render it.
+	size_t nodes;
+	// The bytes that minifying it left out, besides the indentation of its
+	// lines (which depends on where it's used).
+	size_t savedBytes;
+	size_t lines;
+	// Owned by the cache.
+	size_t hash;
+	size_t bytes;
+	struct CachedExpansion * nextInBucket;
+	struct CachedExpansion * newer;
+	struct CachedExpansion * older;
+} CachedExpansion;
+
+/**
+ * How well a cache has performed so far.
+ */
+typedef struct ExpansionCacheStatistics {
+	size_t hits;
+	size_t misses;
+	size_t evictions;
+	size_t entries;
+	size_t bytes;
+	size_t peakBytes;
+} ExpansionCacheStatistics;
+
+/**
+ * Memoizes the expansions of every "@use", keyed by the define it calls, its
+ * arguments and the indentation level. The cache holds at most a fixed amount
+ * of bytes, and evicts the least recently used expansions to make room.
+ */
+typedef struct ExpansionCache ExpansionCache;
+
+/**
+ * Creates an empty cache that holds up to "maximumBytes" (0 disables it).
+ */
+ExpansionCache * createExpansionCache(const size_t maximumBytes);
+
+/**
+ * Finds an expansion, which becomes the most recently used one. Returns NULL
+ * (and counts a miss) if there's none.
+ */
+CachedExpansion * findCachedExpansion(ExpansionCache * cache, const Define * define, const ParameterList * arguments, const unsigned int indentation);
+
+/**
+ * Prepares an empty expansion of a define for the given arguments, ready to
+ * hold its HTML and be stored.
+ */
+CachedExpansion * newCachedExpansion(const Define * define, const ParameterList * arguments, const unsigned int indentation);
+
+/**
+ * Stores an expansion, evicting the least recently used ones if needed. If
+ * it does not fit in the cache at all, it's not stored and false is returned
+ * (so the caller keeps owning it).
+ */
+boolean storeCachedExpansion(ExpansionCache * cache, CachedExpansion * expansion);
+
+/**
+ * Releases an expansion that is not stored.
+ */
+void releaseCachedExpansion(CachedExpansion * expansion);
+
+/**
+ * The hits, misses and evictions so far, and the current (and peak) size.
+ */
+ExpansionCacheStatistics expansionCacheStatistics(const ExpansionCache * cache);
+
+/**
+ * Releases the cache and every expansion in it.
+ */
+void destroyExpansionCache(ExpansionCache * cache);
+
+#endif
@@ -2,32 +2,213 @@
 
 #include "../../shared/symbol-table/symbolTable.h"
 
+static CompilerState *_compilerState = NULL;
 static SymbolTable *_symbolTable = NULL;
 
 /* MODULE INTERNAL STATE */
-const char _indentationCharacter = ' ';
 const char _indentationSize = 4;
 static Logger * _logger = NULL;
-static DefineStatementList * _defineStatementList = NULL;
-FILE * _outputFile = NULL;
+static DefineRegistry * _defineRegistry = NULL;
+static OutputBuffer _outputBuffer = { .descriptor = -1 };
+// The file of the compressed copy of the output, if it's written (see
+// "GZIP_OUTPUT"), and the settings it's compressed with (which change its
+// bytes, so they're part of the hash of the output).
+static int _gzipDescriptor = -1;
+static char _gzipSettings[64] = "";
+// Whether the output files are written into temporary files, and only renamed
+// over them if what they hold changed (see "SKIP_UNCHANGED_OUTPUT"), and the
+// sidecar with the hash of the output.
+static boolean _skipUnchanged = false;
+static char * _hashPath = NULL;
+static FlushPolicy _flushPolicy = FLUSH_BLOCKS;
+// Whether to leave out indentation, newlines, empty styles and attributes.
+static boolean _minify = false;
+// Whether the output points at the text of the program and at its constant
+// fragments, instead of copying them (see "_emitSource").
+static boolean _zeroCopy = false;
+// Whether top-level statements are generated (and released) as soon as
+// they're parsed, whether that already started, and whether it finished.
+static boolean _streaming = false;
+static boolean _streamed = false;
+static boolean _generated = false;
+// Whether the streamed generation failed (see "_fail").
+static boolean _failed = false;
+// The texts resolved through the symbol table while streaming, whose values
+// are the arguments of the "@use"s parsed so far (see "_resolveText").
+static size_t _tableResolutions = 0;
+// Whether statement lists are compiled into bytecode, and run by an
+// interpreter instead of walking their trees (see "_compile"). The codes are
+// kept until the output is closed.
+static boolean _bytecode = false;
+static Bytecode * _bytecodes = NULL;
+static size_t _compiledInstructions = 0;
+// The budget of the expansion cache, split evenly among the threads.
+static size_t _cacheBytes = 0;
+// The threads that generate the program (1 generates it on the main thread).
+static unsigned int _threads = 1;
+static ThreadPool * _pool = NULL;
+// The nodes that a task of a parallel generation generates, roughly.
+static size_t _taskWeight = 4096;
+// What the threads of a parallel generation saved and cached, once they're done.
+static size_t _threadSavedBytes = 0;
+static ExpansionCacheStatistics _threadCacheStatistics = { 0 };
+// What gets the nodes of the walk that generates the output, besides it
+// (see "_beginNode"): a JSON tree, and the text of the page.
+static OutputSink * _sinks[2] = { NULL, NULL };
+static unsigned int _sinkCount = 0;
+// Whether styles are written as classes, whose rules are in the head (see
+// "_collectStyles"): the rules, the rule of rows without a style, and the
+// style block, rendered before the prologue.
+static boolean _extractStyles = false;
+static StyleSheet * _styleSheet = NULL;
+static StyleRule * _emptyRowRule = NULL;
+static OutputBuffer _styleBlock = { .descriptor = -1 };
+// The styles of the pages of a site, while one of them is generated (see
+// "useSiteStyles"), and the name of the file with the rules that more than
+// one page shares, which the head links instead of repeating them.
+static StyleSheet * _siteSheet = NULL;
+static char * _siteStylesheet = NULL;
+// The sizes of the local images, if they're written (see "IMAGE_DIMENSIONS"),
+// and whether images are told how to load, how many of them load eagerly
+// (see "IMAGE_LOADING_HINTS"), and how many the output has so far.
+static ImageSizeCache * _imageSizes = NULL;
+static boolean _imageHints = false;
+static size_t _eagerImages = 1;
+static size_t _writtenImages = 0;
+
+// Every thread generates with its own state (below), so the main thread and
+// the threads of a parallel generation never share what they're writing.
+// The bytes that the pretty-printed output would have, and the minified one leaves out.
+static __thread size_t _savedBytes = 0;
+// The lines written in minified mode, whose indentation is left out.
+static __thread size_t _minifiedLines = 0;
+static __thread ExpansionCache * _expansionCache = NULL;
+// Where the generator is writing now: the output, or the innermost capture.
+static __thread OutputBuffer * _target = &_outputBuffer;
+// Where the current line starts, to charge its bytes once it's finished.
+static __thread size_t _lineStart = 0;
+
+// Indentation is sliced out of this buffer, instead of built for each line.
+static const char _spaces[] =
+    "                                                                "
+    "                                                                "
+    "                                                                "
+    "                                                                ";
+
+/**
+ * A constant piece of the output, with its length precomputed.
+ */
+typedef struct Fragment {
+    const char *text;
+    size_t length;
+} Fragment;
+
+#define FRAGMENT(text) { text, sizeof(text) - 1 }
+
+/**
+ * Every fixed piece of every tag. The variable parts (texts, styles,
+ * attributes) are written in between.
+ */
+typedef enum {
+    H1_OPEN, H1_CLOSE, H2_OPEN, H2_CLOSE, H3_OPEN, H3_CLOSE, P_OPEN, P_CLOSE,
+    IMG_OPEN, IMG_ALT, IMG_CLOSE, IMG_WIDTH, IMG_HEIGHT, IMG_PRIORITY, IMG_LAZY,
+    NAV_OPEN, NAV_CLOSE, LINK_OPEN, LINK_LABEL, LINK_CLOSE,
+    FORM_OPEN, FORM_CLOSE, LABEL_OPEN, LABEL_INPUT, LABEL_CLOSE,
+    FOOTER_OPEN, FOOTER_CLOSE, CARD_OPEN, ROW_OPEN, COLUMN_OPEN, DIV_CLOSE,
+    BUTTON_OPEN, BUTTON_CLOSE,
+    TABLE_OPEN, TABLE_CLOSE, TR_OPEN, TR_CLOSE, TD_OPEN, TD_CLOSE,
+    UL_OPEN, UL_CLOSE, OL_OPEN, OL_CLOSE, LI_OPEN, LI_VALUE_OPEN, LI_CLOSE,
+    STYLE_OPEN, STYLE_END, PROPERTY_VALUE, PROPERTY_END, ATTRIBUTE_VALUE,
+    QUOTE, SPACE, TAG_END, NEWLINE_FRAGMENT,
+    CLASS_OPEN, CARD_CLASS_OPEN, ROW_CLASS_OPEN, COLUMN_CLASS_OPEN, ROW_DISPLAY,
+    STYLE_BLOCK_OPEN, STYLE_BLOCK_CLOSE, MINIFIED_STYLE_BLOCK_OPEN, MINIFIED_STYLE_BLOCK_CLOSE,
+    RULE_INDENTATION, RULE_SELECTOR, RULE_OPEN, RULE_CLOSE,
+    STYLESHEET_LINK_OPEN, STYLESHEET_LINK_CLOSE, MINIFIED_STYLESHEET_LINK_OPEN, MINIFIED_STYLESHEET_LINK_CLOSE,
+    PROLOGUE, EPILOGUE, MINIFIED_PROLOGUE, MINIFIED_EPILOGUE,
+    PROLOGUE_HEAD, PROLOGUE_BODY, MINIFIED_PROLOGUE_HEAD, MINIFIED_PROLOGUE_BODY
+} FragmentType;
+
+// The prologue, split where the extracted styles go (see "_emitPrologue").
+#define HEAD \
+    "<!DOCTYPE html>\n" \
+    "<html lang=\"en\">\n" \
+    "<head>\n" \
+    "  <meta charset=\"UTF-8\">\n" \
+    "  <title>Output</title>\n"
+#define BODY \
+    "</head>\n" \
+    "<body>"
+#define MINIFIED_HEAD \
+    "<!DOCTYPE html>" \
+    "<html lang=\"en\">" \
+    "<head><meta charset=\"UTF-8\"><title>Output</title>"
+#define MINIFIED_BODY "</head><body>"
+
+static const Fragment _fragments[] = {
+    [H1_OPEN] = FRAGMENT("<h1>"), [H1_CLOSE] = FRAGMENT("</h1>"),
+    [H2_OPEN] = FRAGMENT("<h2>"), [H2_CLOSE] = FRAGMENT("</h2>"),
+    [H3_OPEN] = FRAGMENT("<h3>"), [H3_CLOSE] = FRAGMENT("</h3>"),
+    [P_OPEN] = FRAGMENT("<p>"), [P_CLOSE] = FRAGMENT("</p>"),
+    [IMG_OPEN] = FRAGMENT("<img src=\""), [IMG_ALT] = FRAGMENT("\" alt=\""),
+    [IMG_CLOSE] = FRAGMENT("/>"),
+    [IMG_WIDTH] = FRAGMENT(" width=\""), [IMG_HEIGHT] = FRAGMENT("\" height=\""),
+    [IMG_PRIORITY] = FRAGMENT(" fetchpriority=\"high\""), [IMG_LAZY] = FRAGMENT(" loading=\"lazy\" decoding=\"async\""),
+    [NAV_OPEN] = FRAGMENT("<nav"), [NAV_CLOSE] = FRAGMENT("</nav>"),
+    [LINK_OPEN] = FRAGMENT("<a href=\""), [LINK_LABEL] = FRAGMENT("\">"), [LINK_CLOSE] = FRAGMENT("</a>"),
+    [FORM_OPEN] = FRAGMENT("<form"), [FORM_CLOSE] = FRAGMENT("</form>"),
+    [LABEL_OPEN] = FRAGMENT("<label>"), [LABEL_INPUT] = FRAGMENT("<input placeholder=\""),
+    [LABEL_CLOSE] = FRAGMENT("\"/></label>"),
+    [FOOTER_OPEN] = FRAGMENT("<footer"), [FOOTER_CLOSE] = FRAGMENT("</footer>"),
+    [CARD_OPEN] = FRAGMENT("<div class=\"card\""),
+    [ROW_OPEN] = FRAGMENT("<div class=\"row\" style=\"display:flex;"),
+    [COLUMN_OPEN] = FRAGMENT("<div class=\"column\""),
+    [DIV_CLOSE] = FRAGMENT("</div>"),
+    [BUTTON_OPEN] = FRAGMENT("<button"), [BUTTON_CLOSE] = FRAGMENT("</button>"),
+    [TABLE_OPEN] = FRAGMENT("<table"), [TABLE_CLOSE] = FRAGMENT("</table>"),
+    [TR_OPEN] = FRAGMENT("<tr>"), [TR_CLOSE] = FRAGMENT("</tr>"),
+    [TD_OPEN] = FRAGMENT("<td>"), [TD_CLOSE] = FRAGMENT("</td>"),
+    [UL_OPEN] = FRAGMENT("<ul"), [UL_CLOSE] = FRAGMENT("</ul>"),
+    [OL_OPEN] = FRAGMENT("<ol"), [OL_CLOSE] = FRAGMENT("</ol>"),
+    [LI_OPEN] = FRAGMENT("<li>"), [LI_VALUE_OPEN] = FRAGMENT("<li value=\""), [LI_CLOSE] = FRAGMENT("</li>"),
+    [STYLE_OPEN] = FRAGMENT(" style=\""), [STYLE_END] = FRAGMENT("\">"),
+    [PROPERTY_VALUE] = FRAGMENT(":"), [PROPERTY_END] = FRAGMENT(";"), [ATTRIBUTE_VALUE] = FRAGMENT("=\""),
+    [QUOTE] = FRAGMENT("\""), [SPACE] = FRAGMENT(" "), [TAG_END] = FRAGMENT(">"),
+    [NEWLINE_FRAGMENT] = FRAGMENT("\n"),
+    [CLASS_OPEN] = FRAGMENT(" class=\""),
+    [CARD_CLASS_OPEN] = FRAGMENT("<div class=\"card"),
+    [ROW_CLASS_OPEN] = FRAGMENT("<div class=\"row"),
+    [COLUMN_CLASS_OPEN] = FRAGMENT("<div class=\"column"),
+    [ROW_DISPLAY] = FRAGMENT("display:flex;"),
+    [STYLE_BLOCK_OPEN] = FRAGMENT("  <style>\n"), [STYLE_BLOCK_CLOSE] = FRAGMENT("  </style>\n"),
+    [MINIFIED_STYLE_BLOCK_OPEN] = FRAGMENT("<style>"), [MINIFIED_STYLE_BLOCK_CLOSE] = FRAGMENT("</style>"),
+    [RULE_INDENTATION] = FRAGMENT("    "), [RULE_SELECTOR] = FRAGMENT("."), [RULE_OPEN] = FRAGMENT("{"), [RULE_CLOSE] = FRAGMENT("}"),
+    [STYLESHEET_LINK_OPEN] = FRAGMENT("  <link rel=\"stylesheet\" href=\""), [STYLESHEET_LINK_CLOSE] = FRAGMENT("\">\n"),
+    [MINIFIED_STYLESHEET_LINK_OPEN] = FRAGMENT("<link rel=\"stylesheet\" href=\""), [MINIFIED_STYLESHEET_LINK_CLOSE] = FRAGMENT("\">"),
+    [PROLOGUE] = FRAGMENT(HEAD BODY),
+    [EPILOGUE] = FRAGMENT(
+        "</body>\n"
+        "</html>\n"),
+    [MINIFIED_PROLOGUE] = FRAGMENT(MINIFIED_HEAD MINIFIED_BODY),
+    [MINIFIED_EPILOGUE] = FRAGMENT("</body></html>\n"),
+    [PROLOGUE_HEAD] = FRAGMENT(HEAD), [PROLOGUE_BODY] = FRAGMENT(BODY),
+    [MINIFIED_PROLOGUE_HEAD] = FRAGMENT(MINIFIED_HEAD), [MINIFIED_PROLOGUE_BODY] = FRAGMENT(MINIFIED_BODY)
+};
 
 
 
 static void _freeParameterList(ParameterList *list);
+static void _freeWorkStack(void);
+static void _freeBytecodes(void);
+static void _discardOutput(void);
+static void _fail(void);
 
 
-static void _freeDefineStatementList() {
-    DefineStatementList *current = _defineStatementList;
-    while (current) {
-        DefineStatementList *next = current->next;
-        if (current->define) {
-            free(current->define->name);
-            free(current->define);
-        }
-        free(current);
-        current = next;
+static void _freeDefineRegistry() {
+    if (_defineRegistry == NULL) {
+        return;
     }
-    _defineStatementList = NULL;
+    destroyDefineRegistry(_defineRegistry);
+    _defineRegistry = NULL;
 }
 
 
@@ -43,454 +224,3251 @@ static void _freeStatementList(StatementList *list) {
 }
 
 
-void initializeGeneratorModule() {
-	_logger = createLogger("Generator");
-
-	const char * dir = "src/output";
+/**
+ * The compilation failed after some of its output was written (while it was
+ * streamed, or generated), so it's dropped (as if nothing had been
+ * generated).
+ */
+static void _discardOutput(void) {
+    discardOutputBuffer(&_outputBuffer);
+    if (_outputBuffer.descriptor == STDOUT_FILENO
+        || (_outputBuffer.descriptor >= 0 && ftruncate(_outputBuffer.descriptor, 0) != 0)) {
+        logWarning(_logger, "The output written before the compilation failed could not be discarded.");
+    }
+    if (_outputBuffer.gzip != NULL) {
+        discardGzipStream(_outputBuffer.gzip);
+    }
+    for (unsigned int k = 0; k < _sinkCount; ++k) {
+        discardOutputSink(_sinks[k]);
+    }
+}
 
-	struct stat st = {0};
-	if(stat(dir, &st) == -1) {
-		if (mkdir(dir, 0755) != 0) {
-			_outputFile = stdout; 
-			return;
-		}
-	}
-    const char * name = getStringOrDefault("OUTPUT_FILE", "output.html");
 
+/**
+ * The path of a file in the output directory.
+ */
+static char * _outputPath(const char * dir, const char * name) {
     size_t len = strlen(dir) + 1 + strlen(name) + 1;
     char * path = malloc(len);
     snprintf(path, len, "%s/%s", dir, name);
+    return path;
+}
 
-    _outputFile = fopen(path, "w");
-    if (_outputFile == NULL) {
-        _outputFile = stdout;
+
+/**
+ * Opens the file of a sink, if it has a name.
+ */
+static void _openSink(const OutputSinkType type, const char * dir, const char * name, const size_t blockSize) {
+    if (name[0] == '\0') {
+        return;
+    }
+    char * path = _outputPath(dir, name);
+    const int descriptor = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (descriptor < 0) {
+        logError(_logger, "The output \"%s\" could not be opened: %s.", path, strerror(errno));
+    }
+    else {
+        _sinks[_sinkCount++] = createOutputSink(type, descriptor, blockSize);
     }
     free(path);
 }
 
-void shutdownGeneratorModule() {
-	if (_logger != NULL) {
-		destroyLogger(_logger);
-	}
-	if (_outputFile != NULL && _outputFile != stdout) {
-		fclose(_outputFile);
-	}
-	_freeDefineStatementList();
+
+/**
+ * Writes out and closes the files of the sinks.
+ */
+static void _closeSinks(void) {
+    for (unsigned int k = 0; k < _sinkCount; ++k) {
+        const int descriptor = _sinks[k]->buffer.descriptor;
+        const char * format = _sinks[k]->type == JSON_SINK ? "JSON" : "text";
+        if (!destroyOutputSink(_sinks[k])) {
+            logError(_logger, "The %s output could not be written completely.", format);
+        }
+        close(descriptor);
+        _sinks[k] = NULL;
+    }
+    _sinkCount = 0;
 }
 
-/** PRIVATE FUNCTIONS */
 
-static void _generateEpilogue();
-static void _generateProgram(Program * program);
-static void _generatePrologue(void);
-static char * _indentation(const unsigned int indentationLevel);
-static void _output(const unsigned int indentationLevel, const char * const format, ...);
-static void _generateStatement(unsigned indent, Statement *s);
-static char * styleToString(ParameterList *style);
-static char * attributesToString(ParameterList *attrs);
-static const char* lookupLocalParam(const char *key);
+/**
+ * Opens the output, so that it doesn't copy what it can point at if asked to.
+ */
+static void _openOutput(const int descriptor, const size_t blockSize) {
+    if (_zeroCopy) {
+        openVectoredOutputBuffer(&_outputBuffer, descriptor, blockSize);
+    }
+    else {
+        openOutputBuffer(&_outputBuffer, descriptor, blockSize);
+    }
+}
+
 
 /**
- * Creates the epilogue of the generated output, that is, the final lines that
- * completes a valid Latex document.
+ * A file that's written into a temporary file next to it, which is renamed
+ * over it once it's complete (see "SKIP_UNCHANGED_OUTPUT").
  */
-static void _generateEpilogue(void) {
-    _output(0,
-      "</body>\n"
-      "</html>\n"
-    );
+typedef struct {
+    char * path;
+    // NULL if the file is written directly.
+    char * temporaryPath;
+} PendingFile;
+
+static PendingFile _pendingOutput = { NULL, NULL };
+static PendingFile _pendingGzip = { NULL, NULL };
+
+/**
+ * A pending file that's complete, and whether it replaces its output file
+ * (a sidecar does only if every file before it did).
+ */
+typedef struct {
+    PendingFile file;
+    boolean replace;
+    boolean sidecar;
+} HeldFile;
+
+// Whether pending files are held until "releaseOutputs" (see "holdOutputs"),
+// and the ones held so far, in the order they were written.
+static boolean _holding = false;
+static HeldFile * _heldFiles = NULL;
+static size_t _heldCount = 0;
+static size_t _heldCapacity = 0;
+
+
+/**
+ * Opens an output file, or a temporary file next to it while unchanged
+ * outputs are skipped, or outputs are held.
+ */
+static int _openPending(PendingFile * file, const char * path) {
+    if (!_skipUnchanged && !_holding) {
+        return open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    }
+    const size_t length = strlen(path) + sizeof(".XXXXXX");
+    char * temporaryPath = malloc(length);
+    snprintf(temporaryPath, length, "%s.XXXXXX", path);
+    const int descriptor = mkstemp(temporaryPath);
+    if (descriptor < 0) {
+        free(temporaryPath);
+        return -1;
+    }
+    // Like a file that "open" creates, instead of one only its owner reads.
+    const mode_t mask = umask(0);
+    umask(mask);
+    fchmod(descriptor, 0666 & ~mask);
+    file->path = strdup(path);
+    file->temporaryPath = temporaryPath;
+    return descriptor;
 }
 
-static char * styleToString(ParameterList *style) {
-    if (!style || !style->head) {
-        return strdup("");
+
+/**
+ * Renames the temporary file over the output file, or removes it.
+ */
+static boolean _settlePending(PendingFile * file, const boolean replace) {
+    boolean settled = true;
+    if (file->temporaryPath != NULL) {
+        if (replace && rename(file->temporaryPath, file->path) != 0) {
+            logError(_logger, "The output \"%s\" could not be replaced: %s.", file->path, strerror(errno));
+            settled = false;
+        }
+        if (!replace || !settled) {
+            unlink(file->temporaryPath);
+        }
     }
+    free(file->path);
+    free(file->temporaryPath);
+    file->path = NULL;
+    file->temporaryPath = NULL;
+    return settled;
+}
+
 
-    size_t total = 1;
-    for (Parameter *p = style->head; p; p = p->next) {
-        total += strlen(p->key)  
-               + 1              
-               + strlen(p->value) 
-               + 1;             
+/**
+ * Keeps a complete pending file until the held files are settled.
+ */
+static void _hold(PendingFile * file, const boolean replace, const boolean sidecar) {
+    if (file->temporaryPath == NULL) {
+        _settlePending(file, false);
+        return;
     }
-    char *buf = malloc(total);
-    if (!buf) return strdup(""); 
+    if (_heldCount == _heldCapacity) {
+        _heldCapacity = _heldCapacity == 0 ? 16 : 2 * _heldCapacity;
+        _heldFiles = realloc(_heldFiles, _heldCapacity * sizeof(HeldFile));
+    }
+    _heldFiles[_heldCount++] = (HeldFile) { .file = *file, .replace = replace, .sidecar = sidecar };
+    file->path = NULL;
+    file->temporaryPath = NULL;
+}
 
-    buf[0] = '\0';
-    for (Parameter *p = style->head; p; p = p->next) {
-        strcat(buf, p->key);
-        strcat(buf, ":");
-        strcat(buf, p->value);
-        strcat(buf, ";");
-	}
-    return buf;
+
+/**
+ * Renames the held files over their outputs (the ones that changed), or
+ * removes them all. A sidecar that doesn't match its output makes the next
+ * compilation replace it anyway, so it's removed if a file before it
+ * couldn't be replaced. Returns whether every file was.
+ */
+static boolean _settleHeld(const boolean replace) {
+    boolean settled = true;
+    // Whether every file since the last sidecar was replaced.
+    boolean replaced = true;
+    for (size_t k = 0; k < _heldCount; ++k) {
+        HeldFile * held = &_heldFiles[k];
+        if (!held->sidecar) {
+            replaced = _settlePending(&held->file, replace && held->replace) && replaced;
+            settled = settled && replaced;
+            continue;
+        }
+        char * path = strdup(held->file.path);
+        if (!_settlePending(&held->file, replace && replaced) || (replace && !replaced)) {
+            unlink(path);
+            settled = false;
+        }
+        free(path);
+        replaced = true;
+    }
+    free(_heldFiles);
+    _heldFiles = NULL;
+    _heldCount = 0;
+    _heldCapacity = 0;
+    return settled;
 }
 
-static char * attributesToString(ParameterList *attrs) {
-    if (!attrs || !attrs->head) return strdup("");
 
-    size_t total = 1;
-    for (Parameter *p = attrs->head; p; p = p->next) {
-        total += strlen(p->key) + 2 + strlen(p->value) + 2;
+/**
+ * Whether a file holds exactly these bytes.
+ */
+static boolean _fileHolds(const char * path, const char * bytes) {
+    struct stat st;
+    const size_t length = strlen(bytes);
+    if (stat(path, &st) != 0 || (size_t) st.st_size != length) {
+        return false;
+    }
+    char * contents = malloc(length + 1);
+    FILE * file = fopen(path, "r");
+    const boolean holds = file != NULL && fread(contents, 1, length, file) == length && memcmp(contents, bytes, length) == 0;
+    if (file != NULL) {
+        fclose(file);
     }
+    free(contents);
+    return holds;
+}
 
-    char *buf = malloc(total);
-    if (!buf) return strdup("");
 
-    buf[0] = '\0';
-    for (Parameter *p = attrs->head; p; p = p->next) {
-        strcat(buf, p->key);
-        strcat(buf, "=\"");
-        strcat(buf, p->value);
-        strcat(buf, "\" ");
+/**
+ * Whether the output file of a pending file holds the same bytes as its
+ * temporary file (which a file edited, or cut short, since it was written
+ * doesn't, whatever its sidecar says).
+ */
+static boolean _pendingUnchanged(const PendingFile * file) {
+    struct stat existing;
+    struct stat written;
+    if (stat(file->path, &existing) != 0 || stat(file->temporaryPath, &written) != 0
+        || existing.st_size != written.st_size) {
+        return false;
+    }
+    FILE * before = fopen(file->path, "rb");
+    FILE * after = fopen(file->temporaryPath, "rb");
+    boolean same = before != NULL && after != NULL;
+    const size_t chunk = 64 * 1024;
+    char * bytes = malloc(2 * chunk);
+    while (same) {
+        const size_t length = fread(bytes, 1, chunk, before);
+        same = fread(bytes + chunk, 1, chunk, after) == length && memcmp(bytes, bytes + chunk, length) == 0
+            && !ferror(before) && !ferror(after);
+        if (length < chunk) {
+            break;
+        }
     }
-    if (strlen(buf) > 0) buf[strlen(buf) - 1] = '\0';
-    return buf;
+    free(bytes);
+    if (before != NULL) {
+        fclose(before);
+    }
+    if (after != NULL) {
+        fclose(after);
+    }
+    return same;
 }
 
 
-static ParameterList * _currentParams = NULL;
+/**
+ * Once the output files are closed, renames the temporary file of each one
+ * over it only if the compilation is complete and it doesn't hold the same
+ * bytes anymore (so the files that didn't change keep their modification
+ * time), and writes the hash of the output, and of the settings of its
+ * compressed copy, into the sidecar. Otherwise, the temporary files are
+ * removed, and the last output is left as it was. While outputs are held,
+ * the files are only renamed by "releaseOutputs".
+ */
+static void _replaceOutput(const boolean complete) {
+    if (!complete || (_pendingOutput.temporaryPath == NULL && _pendingGzip.temporaryPath == NULL)) {
+        if (_pendingOutput.temporaryPath != NULL || _pendingGzip.temporaryPath != NULL) {
+            logDebugging(_logger, "The compilation failed, so the last output is left as it was.");
+        }
+        _settlePending(&_pendingOutput, false);
+        _settlePending(&_pendingGzip, false);
+        return;
+    }
+    uint64_t tag = _outputBuffer.hash;
+    for (const char * c = _gzipSettings; *c != '\0'; ++c) {
+        tag = (tag ^ (unsigned char) *c) * 1099511628211ULL;
+    }
+    // Quoted, as an HTTP entity tag.
+    char hash[24];
+    snprintf(hash, sizeof(hash), "\"%016" PRIx64 "\"\n", tag);
+    const boolean outputChanged = _pendingOutput.path != NULL && !_pendingUnchanged(&_pendingOutput);
+    const boolean gzipChanged = _pendingGzip.path != NULL && !_pendingUnchanged(&_pendingGzip);
+    _hold(&_pendingOutput, outputChanged, false);
+    _hold(&_pendingGzip, gzipChanged, false);
+    if (_hashPath != NULL && !outputChanged && !gzipChanged && _fileHolds(_hashPath, hash)) {
+        logDebugging(_logger, "The output didn't change, so it's left as it was.");
+    }
+    else if (_hashPath != NULL) {
+        PendingFile sidecar = { NULL, NULL };
+        const int descriptor = _openPending(&sidecar, _hashPath);
+        const boolean written = descriptor >= 0 && write(descriptor, hash, strlen(hash)) == (ssize_t) strlen(hash);
+        if (descriptor >= 0) {
+            close(descriptor);
+        }
+        if (written) {
+            _hold(&sidecar, true, true);
+        }
+        else {
+            _settlePending(&sidecar, false);
+            unlink(_hashPath);
+            logError(_logger, "The hash of the output could not be written into \"%s\".", _hashPath);
+        }
+    }
+    if (!_holding) {
+        _settleHeld(true);
+    }
+}
+
 
-static const char* lookupLocalParam(const char *key) {
-    for (Parameter *p = _currentParams ? _currentParams->head : NULL; p; p = p->next) {
-        if (p->key && strcmp(p->key, key) == 0 && p->value) {
-            return p->value;
+/**
+ * Writes a compressed copy of the output into a file next to it, with a
+ * ".gz" extension. If it's the only copy, the output falls back to the
+ * standard output when the file can't be opened.
+ */
+static void _openGzip(const char * path, const boolean only) {
+    const size_t length = strlen(path) + sizeof(".gz");
+    char * gzipPath = malloc(length);
+    snprintf(gzipPath, length, "%s.gz", path);
+    _gzipDescriptor = _openPending(&_pendingGzip, gzipPath);
+    if (_gzipDescriptor < 0) {
+        logError(_logger, "The compressed output \"%s\" could not be opened: %s.", gzipPath, strerror(errno));
+        if (only) {
+            _outputBuffer.descriptor = STDOUT_FILENO;
         }
     }
-    return NULL;
+    else {
+        size_t level = getSizeOrDefault("GZIP_LEVEL", 6);
+        if (level > 9) {
+            level = 9;
+        }
+        const size_t blockSize = getSizeOrDefault("GZIP_BLOCK_SIZE", 128 * 1024);
+        _outputBuffer.gzip = createGzipStream(_gzipDescriptor, (int) level,
+            blockSize, (unsigned int) getSizeOrDefault("GZIP_THREADS", 0));
+        snprintf(_gzipSettings, sizeof(_gzipSettings), "%s %zu %zu", only ? "INSTEAD" : "ALONGSIDE", level, blockSize);
+    }
+    free(gzipPath);
 }
 
 
-static void _generateStatement(unsigned indent, Statement *s) {
-	if(!s){
-		return;
+/**
+ * Writes out the end of the compressed output, and closes its file. Returns
+ * false if it couldn't be written completely.
+ */
+static boolean _closeGzip(void) {
+    GzipStream * gzip = _outputBuffer.gzip;
+    if (gzip == NULL) {
+        return true;
+    }
+    const boolean written = finishGzipStream(gzip);
+    if (!written) {
+        logError(_logger, "The compressed output could not be written completely.");
+    }
+    else {
+        const size_t bytes = _outputBuffer.flushedBytes;
+        const size_t compressed = gzipStreamCompressedBytes(gzip);
+        logDebugging(_logger, "Compressed output: %zu bytes, %.1f%% of the %zu bytes of the output.",
+            compressed, bytes == 0 ? 0.0 : 100.0 * compressed / bytes, bytes);
+    }
+    destroyGzipStream(gzip);
+    _outputBuffer.gzip = NULL;
+    close(_gzipDescriptor);
+    _gzipDescriptor = -1;
+    return written;
+}
+
+
+/**
+ * Fails the compilation. While streaming, it only fails once the program
+ * has been parsed, so the parser doesn't take it for an error of its own.
+ */
+static void _fail(void) {
+    if (_streamed) {
+        _failed = true;
+    }
+    else {
+        _compilerState->succeed = false;
+    }
+}
+
+
+void initializeGeneratorModule() {
+	_logger = createLogger("Generator");
+	_defineRegistry = createDefineRegistry();
+	const char * jsonName = getStringOrDefault("JSON_OUTPUT_FILE", "");
+	const char * textName = getStringOrDefault("TEXT_OUTPUT_FILE", "");
+	const boolean sinks = jsonName[0] != '\0' || textName[0] != '\0';
+	_cacheBytes = getSizeOrDefault("USE_CACHE_BYTES", 64 * 1024 * 1024);
+	if (sinks && _cacheBytes > 0) {
+		// A cached expansion is reused as HTML, without walking its nodes.
+		logDebugging(_logger, "The use cache is disabled, because the JSON and text outputs walk every expansion.");
+		_cacheBytes = 0;
 	}
-    switch (s->type) {
-        case STATEMENT_HEADER1: {
-			const char *raw = s->text->content;
-			const char *val = lookupLocalParam(raw);
-			if (!val) {
-				char *resolved = NULL;
-				if (symbolTableGetValue(_symbolTable, raw, &resolved)) {
-					val = resolved;
-				} else {
-					val = raw;
-				}
-			}
-			_output(indent, "<h1>%s</h1>", val);
-			break;
-		}
-		case STATEMENT_HEADER2: {
-			const char *raw = s->text->content;
-			const char *val = lookupLocalParam(raw);
-			if (!val) {
-				char *resolved = NULL;
-				if (symbolTableGetValue(_symbolTable, raw, &resolved)) {
-					val = resolved;
-				} else {
-					val = raw;
-				}
-			}
-			_output(indent, "<h2>%s</h2>", val);
-			break;
-		}
-		case STATEMENT_HEADER3: {
-			const char *raw = s->text->content;
-			const char *val = lookupLocalParam(raw);
-			if (!val) {
-				char *resolved = NULL;
-				if (symbolTableGetValue(_symbolTable, raw, &resolved)) {
-					val = resolved;
-				} else {
-					val = raw;
-				}
-			}
-			_output(indent, "<h3>%s</h3>", val);
-			break;
-		}
-		case STATEMENT_PARAGRAPH: {
-			const char *raw = s->text->content;
-			const char *val = lookupLocalParam(raw);
-			if (!val) {
-				char *resolved = NULL;
-				if (symbolTableGetValue(_symbolTable, raw, &resolved)) {
-					val = resolved;
-				} else {
-					val = raw;
-				}
-			}
-			_output(indent, "<p>%s</p>", val);
-			break;
-		}
-		case STATEMENT_IMAGE: {
-			char *styleStr = styleToString(s->image->style);
-			_output(indent,
-					"<img src=\"%s\" alt=\"%s\" style=\"%s\"/>",
-					s->image->src,
-					s->image->alt,
-					styleStr);
-			free(styleStr);
-			break;
-		}
-		case STATEMENT_NAV: {
-			char *styleStr = styleToString(s->nav->style);
-			char *attrsStr = attributesToString(s->nav->attributes);
-			_output(indent, "<nav style=\"%s\" %s>", styleStr, attrsStr);
-			for (NavItem *it = s->nav->items; it; it = it->next) {
-				_output(indent+1, "<a href=\"%s\">%s</a>", it->link, it->label);
-			}
-			_output(indent, "</nav>");
-			free(styleStr);
-			free(attrsStr);
-			break;
-		}
-		case STATEMENT_FORM: {
-			char *styleStr = styleToString(s->form->style);
-			char *attrsStr = attributesToString(s->form->attributes);
-			_output(indent, "<form style=\"%s\" %s>", styleStr, attrsStr);
-			for (FormItem *it = s->form->items; it; it = it->next) {
-				_output(indent+1,
-					"<label>%s<input placeholder=\"%s\"/></label>",
-					it->label,
-					it->placeholder
-				);
-			}
-			_output(indent, "</form>");
-			free(styleStr);
-			free(attrsStr);
-			break;
-		}
-		case STATEMENT_FOOTER: {
-			char *styleStr = styleToString(s->footer->style);
-			_output(indent, "<footer style=\"%s\">", styleStr);
-			for (StatementList *it = s->footer->body; it; it = it->next) {
-				_generateStatement(indent+1, it->statement);
-			}
-			_output(indent, "</footer>");
-			free(styleStr);
-			break;
-		}
-		case STATEMENT_CARD: {
-			char *styleStr = styleToString(s->card->style);
-			_output(indent, "<div class=\"card\" style=\"%s\">", styleStr);
-			for (StatementList *it = s->card->body; it; it = it->next) {
-				_generateStatement(indent+1, it->statement);
-			}
-			_output(indent, "</div>");
-			free(styleStr);
-			break;
-		}
-		case STATEMENT_BUTTON: {
-			char *styleStr = styleToString(s->button->style);
-			char *actionStr = attributesToString(s->button->action);
-			_output(indent, "<button style=\"%s\" %s>", styleStr, actionStr);
-			for (StatementList *it = s->button->body; it; it = it->next) {
-				_generateStatement(indent+1, it->statement);
-			}
-			_output(indent, "</button>");
-			free(styleStr);
-			free(actionStr);
-			break;
-		}
-		case STATEMENT_TABLE: {
-			char *styleStr = styleToString(s->table->style);
-			_output(indent, "<table style=\"%s\">", styleStr);
-			for (TableRowList *r = s->table->rows; r; r = r->next) {
-				_output(indent+1, "<tr>");
-				for (TableCellList *c = r->row->cells; c; c = c->next) {
-					_output(indent+2, "<td>");
-					for (StatementList *cell = c->cell->content; cell; cell = cell->next) {
-						_generateStatement(indent+3, cell->statement);
-					}
-					_output(indent+2, "</td>");
-				}
-				_output(indent+1, "</tr>");
-			}
-			_output(indent, "</table>");
-			free(styleStr);
-			break;
-		}
-		case STATEMENT_UNORDERED_LIST: {
-			char *styleStr = styleToString(s->unordered_list->style);
-			_output(indent, "<ul style=\"%s\">", styleStr);
-			for (StatementList *it = s->unordered_list->items; it; it = it->next) {
-				_generateStatement(indent+1, it->statement);
-			}
-			_output(indent, "</ul>");
-			free(styleStr);
-			break;
-		}
-		case STATEMENT_BULLET_ITEM: {
-			_output(indent, "<li>");
-			_generateStatement(indent+1, s->bullet_item->body);
-			_output(indent, "</li>");
-			break;
-		}
-		case STATEMENT_ORDERED_LIST: {
-			char *styleStr = styleToString(s->ordered_list->style);
-			_output(indent, "<ol style=\"%s\">", styleStr);
-			for (StatementList *it = s->ordered_list->items; it; it = it->next) {
-				_generateStatement(indent+1, it->statement);
+	_expansionCache = createExpansionCache(_cacheBytes);
+	_threads = (unsigned int) getSizeOrDefault("GENERATOR_THREADS", 1);
+	if (_threads == 0) {
+		_threads = availableProcessors();
+	}
+	if (sinks && _threads > 1) {
+		logWarning(_logger, "Parallel generation is disabled, because the JSON and text outputs are written in the order of the walk.");
+		_threads = 1;
+	}
+	_taskWeight = getSizeOrDefault("GENERATOR_TASK_WEIGHT", 4096);
+	if (_taskWeight == 0) {
+		_taskWeight = 1;
+	}
+	_flushPolicy = flushPolicyFromString(getStringOrDefault("OUTPUT_FLUSH_POLICY", "BLOCKS"));
+	_minify = getBooleanOrDefault("MINIFY", false);
+	_zeroCopy = getBooleanOrDefault("ZERO_COPY_OUTPUT", false);
+	_streaming = getBooleanOrDefault("STREAMING_GENERATION", false);
+	_tableResolutions = 0;
+	if (_streaming && getBooleanOrDefault("LAZY_DEFINES", false)) {
+		logWarning(_logger, "Streaming generation is disabled, because deferred define bodies can't be parsed while the program is.");
+		_streaming = false;
+	}
+	_extractStyles = getBooleanOrDefault("EXTRACT_STYLES", false);
+	if (_extractStyles && _streaming) {
+		logWarning(_logger, "Style extraction is disabled, because the head is written before the styles of the program have been parsed.");
+		_extractStyles = false;
+	}
+	if (getBooleanOrDefault("IMAGE_DIMENSIONS", false)) {
+		_imageSizes = createImageSizeCache(getStringOrDefault("IMAGE_ROOT", "src/output"));
+	}
+	_imageHints = getBooleanOrDefault("IMAGE_LOADING_HINTS", false);
+	_eagerImages = getSizeOrDefault("EAGER_IMAGES", 1);
+	_writtenImages = 0;
+	if (_imageHints && _threads > 1) {
+		logWarning(_logger, "Parallel generation is disabled, because images are told how to load in the order they're written.");
+		_threads = 1;
+	}
+	_bytecode = getBooleanOrDefault("BYTECODE_GENERATION", false);
+	if (_bytecode && (_streaming || _threads > 1 || getBooleanOrDefault("LAZY_DEFINES", false))) {
+		logWarning(_logger, "Bytecode generation is disabled, because it compiles define bodies once every statement has been parsed, on a single thread.");
+		_bytecode = false;
+	}
+	if (_bytecode && _imageHints) {
+		logWarning(_logger, "Bytecode generation is disabled, because its code would write the images of a define the same way every time it's expanded.");
+		_bytecode = false;
+	}
+	if (_bytecode && sinks) {
+		logWarning(_logger, "Bytecode generation is disabled, because its code doesn't walk the nodes that the JSON and text outputs are made of.");
+		_bytecode = false;
+	}
+	size_t blockSize = getSizeOrDefault("OUTPUT_BUFFER_SIZE", 1024 * 1024);
+	if (blockSize == 0) {
+		blockSize = 1;
+	}
+
+	const char * dir = "src/output";
+
+	struct stat st = {0};
+	if(stat(dir, &st) == -1) {
+		if (mkdir(dir, 0755) != 0) {
+			if (sinks) {
+				logError(_logger, "The JSON and text outputs can't be written, because \"%s\" could not be created.", dir);
 			}
-			_output(indent, "</ol>");
-			free(styleStr);
-			break;
-		}
-		case STATEMENT_ORDERED_ITEM: {
-			_output(indent, "<li value=\"%s\">", s->ordered_item->number);
-			_generateStatement(indent+1, s->ordered_item->body);
-			_output(indent, "</li>");
-			break;
+			_openOutput(STDOUT_FILENO, blockSize);
+			return;
 		}
-		case STATEMENT_ROW: {
-			char *userStyle = styleToString(s->row->style);
-			size_t prefixLen = strlen("display:flex;");
-			size_t totalLen  = prefixLen + strlen(userStyle) + 1;
-			char *styleStr   = malloc(totalLen);
-			if (!styleStr) styleStr = strdup(userStyle);
-			else {
-			strcpy(styleStr, "display:flex;");
-			strcat(styleStr, userStyle);
-			}
-			free(userStyle);
+	}
+    _openSink(JSON_SINK, dir, jsonName, blockSize);
+    _openSink(TEXT_SINK, dir, textName, blockSize);
+    const char * name = getStringOrDefault("OUTPUT_FILE", "output.html");
 
-			_output(indent, "<div class=\"row\" style=\"%s\">", styleStr);
-			for (StatementList *it = s->row->columns; it; it = it->next) {
-				_generateStatement(indent+1, it->statement);
-			}
-			_output(indent, "</div>");
-			free(styleStr);
-			break;
+    char * path = _outputPath(dir, name);
+    const char * gzip = getStringOrDefault("GZIP_OUTPUT", "NONE");
+    const boolean compressedOnly = strcmp(gzip, "INSTEAD") == 0;
+
+    _skipUnchanged = getBooleanOrDefault("SKIP_UNCHANGED_OUTPUT", false);
+    if (_skipUnchanged) {
+        const size_t length = strlen(path) + sizeof(".etag");
+        _hashPath = malloc(length);
+        snprintf(_hashPath, length, "%s.etag", path);
+    }
+
+    int descriptor = -1;
+    if (!compressedOnly) {
+        descriptor = _openPending(&_pendingOutput, path);
+        if (descriptor < 0) {
+            descriptor = STDOUT_FILENO;
+        }
+    }
+    _openOutput(descriptor, blockSize);
+    _outputBuffer.hashing = _skipUnchanged;
+    if (compressedOnly || strcmp(gzip, "ALONGSIDE") == 0) {
+        _openGzip(path, compressedOnly);
+    }
+    free(path);
+}
+
+void shutdownGeneratorModule() {
+	const int descriptor = _outputBuffer.descriptor;
+	if ((_streamed && !_generated) || (_generated && !_compilerState->succeed)) {
+		_discardOutput();
+	}
+	closeOutputBuffer(&_outputBuffer);
+	const boolean compressed = _closeGzip();
+	_closeSinks();
+	if (descriptor >= 0 && descriptor != STDOUT_FILENO) {
+		close(descriptor);
+	}
+	_outputBuffer.descriptor = -1;
+	_replaceOutput(_generated && !_failed && _compilerState != NULL && _compilerState->succeed
+		&& !_outputBuffer.failed && compressed);
+	free(_hashPath);
+	_hashPath = NULL;
+	_gzipSettings[0] = '\0';
+	if (_logger != NULL) {
+		if (_outputBuffer.failed) {
+			logError(_logger, "The output could not be written completely.");
 		}
-		case STATEMENT_COLUMN: {
-			char *styleStr = styleToString(s->column->style);
-			_output(indent, "<div class=\"column\" style=\"%s\">", styleStr);
-			for (StatementList *it = s->column->body; it; it = it->next) {
-				_generateStatement(indent+1, it->statement);
-			}
-			_output(indent, "</div>");
-			free(styleStr);
-			break;
+		logDebugging(_logger, "Output: %zu bytes in %zu write calls (%zu bytes copied).",
+			_outputBuffer.flushedBytes, _outputBuffer.writes, _outputBuffer.copiedBytes);
+		if (_expansionCache != NULL) {
+			ExpansionCacheStatistics statistics = expansionCacheStatistics(_expansionCache);
+			statistics.hits += _threadCacheStatistics.hits;
+			statistics.misses += _threadCacheStatistics.misses;
+			statistics.evictions += _threadCacheStatistics.evictions;
+			statistics.peakBytes += _threadCacheStatistics.peakBytes;
+			logDebugging(_logger, "Use cache: %zu hits, %zu misses, %zu evictions (%zu bytes at most).",
+				statistics.hits, statistics.misses, statistics.evictions, statistics.peakBytes);
 		}
-		case STATEMENT_DEFINE: {
-			DefineStatementList *newNode = malloc(sizeof(DefineStatementList));
-    		newNode->define = calloc(1, sizeof(Define));
-			newNode->define->name = strdup(s->define->name);
-			newNode->define->parameters = s->define->parameters ? s->define->parameters : NULL;
-			newNode->define->style = s->define->style ? s->define->style : NULL;
-			newNode->define->body = s->define->body ? s->define->body : calloc(1, sizeof(StatementList));
-    		newNode->next = NULL;
-
-   			if (_defineStatementList == NULL) {
-        		_defineStatementList = newNode;
-    		} else {
-        		DefineStatementList *it = _defineStatementList;
-        		while (it->next != NULL) {
-            		it = it->next;
-        		}
-        		it->next = newNode;
-    		}
-			
-    	break;
-			
+		if (_bytecode) {
+			logDebugging(_logger, "Bytecode: %zu instructions compiled.", _compiledInstructions);
 		}
-		case STATEMENT_USE: {
-			DefineStatementList *it = _defineStatementList;
-			while (it) {
-			if (strcmp(it->define->name, s->use->name) == 0) {
-				Parameter *pDef = it->define->parameters->head;
-				Parameter *pUse = s->use->parameters->head;
-				while (pDef && pUse) {
-				pDef->value = pUse->value;
-				pDef = pDef->next;
-				pUse = pUse->next;
-				}
-				ParameterList *oldCtx = _currentParams;
-				_currentParams = it->define->parameters;
-
-				for (StatementList *stmt = it->define->body; stmt; stmt = stmt->next) {
-				_generateStatement(indent, stmt->statement);
-				}
-
-				_currentParams = oldCtx;
-				break;
-			}
-			it = it->next;
-			}
-			break;
+		if (_imageSizes != NULL) {
+			const ImageSizeCacheStatistics statistics = imageSizeCacheStatistics(_imageSizes);
+			logDebugging(_logger, "Image sizes: %zu read, %zu reused.", statistics.misses, statistics.hits);
 		}
-        default:
-            logError(_logger, "Tipo de statement no soportado: %d", s->type);
-            break;
-    }
+		destroyLogger(_logger);
+		_logger = NULL;
+	}
+	// A site initializes the module again for each page.
+	_compilerState = NULL;
+	_streamed = false;
+	_generated = false;
+	_failed = false;
+	_freeDefineRegistry();
+	destroyExpansionCache(_expansionCache);
+	_expansionCache = NULL;
+	_freeWorkStack();
+	_freeBytecodes();
+	destroyImageSizeCache(_imageSizes);
+	_imageSizes = NULL;
+	closeOutputBuffer(&_styleBlock);
+	destroyStyleSheet(_styleSheet);
+	_styleSheet = NULL;
+	_emptyRowRule = NULL;
+	_siteSheet = NULL;
+	free(_siteStylesheet);
+	_siteStylesheet = NULL;
 }
 
+/** PRIVATE FUNCTIONS */
 
+static void _generateEpilogue();
+static void _generateProgram(Program * program);
+static void _generatePrologue(void);
+static void _emit(const char * bytes, const size_t length);
+static void _emitSource(const char * bytes, const size_t length);
+static void _emitEscaped(const char * bytes, const size_t length, const HtmlContext context, const boolean source);
 /**
- * Generates the output of the program.
+ * What a statement list is compiled as: the body of a define (or of a static
+ * fragment), the program (flushed after every top-level statement if the
+ * flush policy asks for it), or the whole document with its prologue and
+ * epilogue, as the C backend renders it.
  */
-static void _generateProgram(Program *program) {
-    for (StatementList *it = program->statements; it; it = it->next) {
-		if(it->statement){
-        	_generateStatement(1, it->statement);
-		}
+typedef enum {
+    BODY_CODE,
+    PROGRAM_CODE,
+    DOCUMENT_CODE
+} CodeKind;
+
+static void _emitLiteral(const char * string, const HtmlContext context, const boolean clean);
+static void _emitFragment(const FragmentType type);
+static void _beginLine(const unsigned int indentationLevel);
+static void _endLine(void);
+static void _emitLine(const unsigned int indentationLevel, const FragmentType type);
+static void _emitCss(const char * css, const size_t length);
+static void _emitProperties(ParameterList * style);
+static void _emitStyle(ParameterList * style);
+static void _emitImageAttributes(Image * image);
+static void _emitAttributes(ParameterList * attributes);
+static void _emitOpening(const unsigned int indentationLevel, const FragmentType open, ParameterList * style);
+static void _emitOpeningWithAttributes(const unsigned int indentationLevel, const FragmentType open, ParameterList * style, ParameterList * attributes);
+static void _outputBytes(const char * bytes, const size_t length, const boolean stable);
+static unsigned int _cacheIndentation(const unsigned int indent);
+static void _reuse(const size_t savedBytes, const size_t lines, const unsigned int indent, const char * html, const size_t length, const boolean stable);
+static void _generateStatement(unsigned indent, Statement *s);
+static boolean _split(StatementList *list, const unsigned int indent, const size_t weight);
+static size_t _listWeight(StatementList *list);
+static Define * _resolveDefine(Define **cached, const char *name);
+static const char* lookupLocalParam(const char *key);
+static const char * _resolveText(const char *raw);
+static void _emitText(unsigned indent, const FragmentType open, Text *text, const FragmentType close);
+static void _emitTextContent(Text *text);
+static void _emitOpeningTag(const FragmentType open, ParameterList * style);
+static void _emitRowOpeningTag(ParameterList * style);
+static void _emitOpeningTagWithAttributes(const FragmentType open, ParameterList * style, ParameterList * attributes);
+static Bytecode * _compile(StatementList *list, Parameter *parameters, const CodeKind kind);
+static void _interpret(void);
+static void _beginNode(const char *type);
+static void _endNode(void);
+static void _fold(StatementList *list);
+static void _emitPrologue(void);
+static void _collectStyles(StatementList *list, const boolean add);
+static void _renderStyleBlock(void);
+static boolean _writeSiteStylesheet(void);
+
+/**
+ * Creates the epilogue of the generated output, that is, the final lines that
+ * completes a valid Latex document.
+ */
+static void _generateEpilogue(void) {
+    _endNode();
+    if (_minify) {
+        _savedBytes += _fragments[EPILOGUE].length - _fragments[MINIFIED_EPILOGUE].length;
+        _emitLine(0, MINIFIED_EPILOGUE);
+        return;
     }
+    _emitLine(0, EPILOGUE);
 }
 
 /**
- * Creates the prologue of the generated output, a Latex document that renders
- * a tree thanks to the Forest package.
- *
- * @see https://ctan.dcc.uchile.cl/graphics/pgf/contrib/forest/forest-doc.pdf
+ * The arguments bound to the parameters of the define being expanded: the
+ * k-th value is the one of the k-th parameter. Values are never written into
+ * the define itself, so many threads can expand the same define at once.
  */
-static void _generatePrologue(void) {
-    _output(0,
-      "<!DOCTYPE html>\n"
-      "<html lang=\"en\">\n"
-      "<head>\n"
-      "  <meta charset=\"UTF-8\">\n"
-      "  <title>Output</title>\n"
-      "</head>\n"
-      "<body>"
-    );
-}
+typedef struct Bindings {
+    Parameter *parameters;
+    Parameter *values;
+} Bindings;
+
+static __thread Bindings _bindings = { NULL, NULL };
 
 /**
- * Generates an indentation string for the specified level.
+ * While a "@define" is being specialized, its output is collected in memory
+ * instead of being written to the output file. Specializations can nest (a
+ * body that uses another define), so captures form a stack.
  */
-static char * _indentation(const unsigned int level) {
-	return indentation(_indentationCharacter, level, _indentationSize);
+typedef struct Capture {
+    OutputBuffer buffer;
+    struct Capture *previous;
+    // Where the output went before (the output, or the segment of a task).
+    OutputBuffer *target;
+} Capture;
+
+static __thread Capture * _capture = NULL;
+
+static void _beginCapture(Capture *capture) {
+    openOutputBuffer(&capture->buffer, -1, 0);
+    capture->previous = _capture;
+    capture->target = _target;
+    _capture = capture;
+    _target = &capture->buffer;
+}
+
+static void _endCapture(Capture *capture) {
+    _capture = capture->previous;
+    _target = capture->target;
 }
 
 /**
- * Outputs a formatted string to standard output. The "fflush" instruction
- * allows to see the output even close to a failure, because it drops the
- * buffering.
+ * A render being collected in memory (the expansion of a "@use", or a static
+ * fragment rendered for the first time), until its body has been generated.
  */
-static void _output(const unsigned int indentationLevel, const char * const format, ...) {
-    va_list args;
-    va_start(args, format);
+typedef struct PendingRender {
+    Capture capture;
+    // The expansion to fill, or NULL for a static fragment.
+    CachedExpansion *expansion;
+    StaticHtml *staticHtml;
+    Bindings previousBindings;
+    size_t nodes;
+    size_t savedBytes;
+    size_t lines;
+    // Whether it can be cached (see "_cacheable"), unless it resolves a text
+    // through the symbol table while streaming.
+    boolean cacheable;
+    size_t tableResolutions;
+} PendingRender;
 
-    char *indent = _indentation(indentationLevel);
-    fputs(indent, _outputFile);
-    free(indent);
+/**
+ * An "@each" whose records are being generated, one at a time.
+ */
+typedef struct PendingEach {
+    Define *define;
+    const char *path;
+    const char **keys;
+    JsonRecordStream *stream;
+    // The fields of the current record, bound to the parameters.
+    Parameter *values;
+    Bindings previousBindings;
+    unsigned long records;
+    JsonRecordStatus status;
+} PendingEach;
 
-    vfprintf(_outputFile, format, args);
-    fputc('\n', _outputFile);
-    fflush(_outputFile);
+/**
+ * The pieces of work of the generator. Statements are not generated with C
+ * recursion, but with an explicit stack of these on the heap, so the depth of
+ * the program is only bounded by the memory (and the nesting limit).
+ */
+typedef enum {
+    // Generates the remaining statements of a list, one at a time.
+    WORK_STATEMENTS,
+    // Generates a single statement.
+    WORK_STATEMENT,
+    // Generates the remaining rows of a table, or cells of a row.
+    WORK_TABLE_ROWS,
+    WORK_TABLE_CELLS,
+    // Closes the tag of a statement, and leaves its nesting level.
+    WORK_CLOSE,
+    // Closes a tag that is not a statement of its own (a row or a cell).
+    WORK_CLOSE_LINE,
+    // Leaves the nesting level of a statement that has no tag.
+    WORK_LEAVE,
+    // Collects a render, once its body has been generated.
+    WORK_FINISH_RENDER,
+    // Binds the next record of an "@each", and generates its body again.
+    WORK_NEXT_RECORD,
+    // Runs compiled code, from the next instruction on.
+    WORK_CODE
+} WorkType;
 
-    va_end(args);
-}
+typedef struct Work {
+    WorkType type;
+    unsigned int indent;
+    union {
+        StatementList *statements;
+        Statement *statement;
+        TableRowList *rows;
+        TableCellList *cells;
+        FragmentType fragment;
+        PendingRender *render;
+        PendingEach *each;
+        const Instruction *next;
+    };
+} Work;
 
+static __thread Work * _work = NULL;
+static __thread size_t _workCount = 0;
+static __thread size_t _workCapacity = 0;
 
+/**
+ * Pushes a piece of work, and returns it to fill in its operand (the pointer
+ * is only valid until the next push).
+ */
+static Work * _push(const WorkType type, const unsigned int indent) {
+    if (_workCount == _workCapacity) {
+        _workCapacity = _workCapacity == 0 ? 256 : 2 * _workCapacity;
+        _work = realloc(_work, _workCapacity * sizeof(Work));
+    }
+    Work *work = &_work[_workCount++];
+    work->type = type;
+    work->indent = indent;
+    return work;
+}
 
-/** PUBLIC FUNCTIONS */
+static void _freeWorkStack(void) {
+    free(_work);
+    _work = NULL;
+    _workCount = 0;
+    _workCapacity = 0;
+}
 
-void generate(CompilerState * compilerState) {
-	logDebugging(_logger, "Generating final output...");
-	_symbolTable = compilerState->symbolTable;
-	_generatePrologue();
-	_generateProgram(compilerState->abstractSyntaxtTree);
-	_generateEpilogue();
-	logDebugging(_logger, "Generation is done.");
+/**
+ * Opens the body of a statement: its statements are generated one level
+ * deeper, and then its tag is closed.
+ */
+static void _pushBody(const unsigned int indent, const FragmentType close, StatementList *body, const size_t weight) {
+    _push(WORK_CLOSE, indent)->fragment = close;
+    if (!_split(body, indent + 1, weight)) {
+        _push(WORK_STATEMENTS, indent + 1)->statements = body;
+    }
+}
+
+/**
+ * Generates the body of a define (as compiled code, if bytecode is enabled).
+ */
+static void _pushDefineBody(const unsigned int indent, Define *define) {
+    if (_bytecode) {
+        if (!define->code) {
+            define->code = _compile(define->body, define->parameters->head, BODY_CODE);
+        }
+        _push(WORK_CODE, indent)->next = define->code->instructions;
+    }
+    else {
+        _push(WORK_STATEMENTS, indent)->statements = define->body;
+    }
+}
+
+/**
+ * The indentation level under which a fragment is cached. The minified
+ * output has no indentation, so a fragment can be reused at every level.
+ */
+static unsigned int _cacheIndentation(const unsigned int indent) {
+    return _minify ? 0 : indent;
+}
+
+/**
+ * Whether an expansion that starts now can be cached, or reused from the
+ * cache. With loading hints, one that starts before every eager image has
+ * been written may write its images differently than anywhere else, while
+ * afterwards every image loads lazily.
+ */
+static boolean _cacheable(void) {
+    return !_imageHints || _writtenImages >= _eagerImages;
+}
+
+/**
+ * Outputs a fragment rendered before, accounting for the bytes that its
+ * lines would have had at this indentation level if it wasn't minified.
+ */
+static void _reuse(const size_t savedBytes, const size_t lines, const unsigned int indent, const char * html, const size_t length, const boolean stable) {
+    _savedBytes += savedBytes + lines * indent * _indentationSize;
+    _minifiedLines += lines;
+    _outputBytes(html, length, stable);
+}
+
+/**
+ * Partially evaluates the body of a define for the arguments of a "@use":
+ * every parameter is bound to its literal, and the body is rendered into
+ * memory, so it can be cached for the following calls with the same
+ * arguments (and indentation). The render is collected by "_finishRender".
+ */
+static void _beginExpansion(Define *define, ParameterList *arguments, unsigned indent) {
+    PendingRender *render = calloc(1, sizeof(PendingRender));
+    render->expansion = newCachedExpansion(define, arguments, _cacheIndentation(indent));
+    render->cacheable = _cacheable();
+    render->tableResolutions = _tableResolutions;
+    render->previousBindings = _bindings;
+    _bindings.parameters = define->parameters->head;
+    _bindings.values = arguments->head;
+
+    render->nodes = expandedNodes();
+    render->savedBytes = _savedBytes;
+    render->lines = _minifiedLines;
+    _beginCapture(&render->capture);
+    _push(WORK_FINISH_RENDER, indent)->render = render;
+    _pushDefineBody(indent, define);
+}
+
+/**
+ * Renders a static fragment into memory for the first time, to reuse it
+ * every time it's generated again at this indentation level.
+ */
+static void _beginStaticRender(StaticHtml *staticHtml, unsigned indent) {
+    PendingRender *render = calloc(1, sizeof(PendingRender));
+    render->staticHtml = staticHtml;
+    render->nodes = expandedNodes();
+    render->savedBytes = _savedBytes;
+    render->lines = _minifiedLines;
+    _beginCapture(&render->capture);
+    _push(WORK_FINISH_RENDER, indent)->render = render;
+    _push(WORK_STATEMENT, indent)->statement = staticHtml->original;
+}
+
+/**
+ * The render of a static fragment at an indentation level, if there's one.
+ * Renders are only ever prepended to the list, so it can be read while
+ * another thread publishes one.
+ */
+static StaticRender * _findStaticRender(StaticHtml *staticHtml, const unsigned int indentation) {
+    StaticRender *render = __atomic_load_n(&staticHtml->renders, __ATOMIC_ACQUIRE);
+    while (render && render->indentation != indentation) {
+        render = render->next;
+    }
+    return render;
+}
+
+/**
+ * Prepends a render to the list of a static fragment. If two threads render
+ * the same fragment at once, both renders are kept (they're identical).
+ */
+static void _publishStaticRender(StaticHtml *staticHtml, StaticRender *render) {
+    render->next = __atomic_load_n(&staticHtml->renders, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&staticHtml->renders, &render->next, render, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+    }
+}
+
+/**
+ * Once the body of a render has been generated, keeps it (in the expansion
+ * cache, or in the static fragment), and writes it out.
+ */
+static void _finishRender(unsigned indent, PendingRender *render) {
+    _endCapture(&render->capture);
+    const size_t lines = _minifiedLines - render->lines;
+    const size_t savedBytes = _savedBytes - render->savedBytes - lines * indent * _indentationSize;
+    if (render->expansion) {
+        CachedExpansion *expansion = render->expansion;
+        _bindings = render->previousBindings;
+        expansion->html = render->capture.buffer.bytes;
+        expansion->length = render->capture.buffer.length;
+        expansion->nodes = expandedNodes() - render->nodes;
+        expansion->lines = lines;
+        expansion->savedBytes = savedBytes;
+        _outputBytes(expansion->html, expansion->length, false);
+        const boolean cacheable = render->cacheable && render->tableResolutions == _tableResolutions;
+        if (!cacheable || !storeCachedExpansion(_expansionCache, expansion)) {
+            releaseCachedExpansion(expansion);
+        }
+    }
+    else {
+        StaticRender *staticRender = calloc(1, sizeof(StaticRender));
+        staticRender->indentation = _cacheIndentation(indent);
+        staticRender->html = render->capture.buffer.bytes;
+        staticRender->length = render->capture.buffer.length;
+        staticRender->nodes = expandedNodes() - render->nodes;
+        staticRender->lines = lines;
+        staticRender->savedBytes = savedBytes;
+        _publishStaticRender(render->staticHtml, staticRender);
+        _outputBytes(staticRender->html, staticRender->length, true);
+    }
+    free(render);
+    leaveNesting();
+}
+
+/**
+ * Finds a define by name, parsing (and folding) its body if it was deferred.
+ * The define found is cached in the node that calls it, so the registry is
+ * only looked up the first time. A body that can't be parsed fails the
+ * compilation.
+ */
+static Define * _resolveDefine(Define **cached, const char *name) {
+    Define *define = *cached;
+    if (!define) {
+        define = findDefine(_defineRegistry, name);
+        if (!define) {
+            return NULL;
+        }
+        *cached = define;
+    }
+    if (!define->body && define->lazyBody) {
+        if (parseLazyDefineBody(_compilerState, define) != ACCEPT) {
+            // It's only reported once, and the output is dropped at the end.
+            logError(_logger, "The body of \"%s\" could not be parsed.", define->name);
+            free(define->lazyBody);
+            define->lazyBody = NULL;
+            _fail();
+            return NULL;
+        }
+        _fold(define->body);
+        if (_extractStyles) {
+            _collectStyles(define->body, false);
+        }
+    }
+    return define;
+}
+
+/**
+ * Expands the body of a define once per record of a JSON data file. Every
+ * record is streamed, bound and rendered straight to the output, so neither
+ * the records nor their expansions are kept. Returns false if the file
+ * cannot be opened.
+ */
+static boolean _beginEach(unsigned indent, Define *define, const char *path) {
+    unsigned int count = 0;
+    for (Parameter *p = define->parameters->head; p; p = p->next) {
+        ++count;
+    }
+    const char **keys = calloc(count + 1, sizeof(char *));
+    unsigned int k = 0;
+    for (Parameter *p = define->parameters->head; p; p = p->next) {
+        keys[k++] = p->key;
+    }
+    JsonRecordStream *stream = openJsonRecordStream(path, keys, count);
+    if (!stream) {
+        addInvalidDataFileError(_compilerState->errorManager, path, strerror(errno));
+        _fail();
+        free(keys);
+        return false;
+    }
+    PendingEach *each = calloc(1, sizeof(PendingEach));
+    each->define = define;
+    each->path = path;
+    each->keys = keys;
+    each->stream = stream;
+    each->values = calloc(count + 1, sizeof(Parameter));
+    for (k = 1; k < count; ++k) {
+        each->values[k - 1].next = &each->values[k];
+    }
+    each->previousBindings = _bindings;
+    each->status = JSON_RECORD_READ;
+    _bindings.parameters = define->parameters->head;
+    _bindings.values = each->values;
+    _push(WORK_NEXT_RECORD, indent)->each = each;
+    return true;
+}
+
+/**
+ * Reads the next record, and binds its fields to the parameters. Returns
+ * false once there are no more records to generate.
+ */
+static boolean _bindNextRecord(PendingEach *each) {
+    if (resourceLimitExceeded() || (each->status = nextJsonRecord(each->stream)) != JSON_RECORD_READ) {
+        return false;
+    }
+    ++each->records;
+    unsigned int k = 0;
+    for (Parameter *p = each->define->parameters->head; p; p = p->next, ++k) {
+        Parameter *value = &each->values[k];
+        value->value = (char *) jsonRecordValue(each->stream, k);
+        value->valueLength = value->value ? strlen(value->value) : 0;
+        if (!value->value) {
+            char reason[128];
+            snprintf(reason, sizeof(reason), "record %lu has no field \"%s\"", each->records, p->key);
+            addInvalidDataFileError(_compilerState->errorManager, each->path, reason);
+            _fail();
+            each->status = JSON_RECORD_END;
+            return false;
+        }
+    }
+    return true;
+}
+
+static void _finishEach(PendingEach *each) {
+    if (each->status == JSON_RECORD_ERROR) {
+        addInvalidDataFileError(_compilerState->errorManager, each->path, jsonRecordError(each->stream));
+        _fail();
+    }
+    _bindings = each->previousBindings;
+    closeJsonRecordStream(each->stream);
+    free(each->values);
+    free(each->keys);
+    free(each);
+    leaveNesting();
+}
+
+/**
+ * The value of a text: the argument of the parameter it names, the value of
+ * the variable it names, or the text itself. While streaming, the value of a
+ * variable can change with the next "@use", so what resolves one isn't cached.
+ */
+static const char * _resolveText(const char *raw) {
+    const char *val = lookupLocalParam(raw);
+    if (!val) {
+        val = symbolTableValue(_symbolTable, raw);
+        if (!val) {
+            return raw;
+        }
+        if (_streaming) {
+            ++_tableResolutions;
+        }
+    }
+    return val;
+}
+
+/**
+ * Outputs the line of a text. Its content is known to be clean or not since
+ * it was parsed, but what it resolves to has to be scanned.
+ */
+static void _emitText(unsigned indent, const FragmentType open, Text *text, const FragmentType close) {
+    _beginLine(indent);
+    _emitFragment(open);
+    _emitTextContent(text);
+    _emitFragment(close);
+    _endLine();
+}
+
+static void _emitTextContent(Text *text) {
+    const char *resolved = _resolveText(text->content);
+    if (resolved == text->content) {
+        _emitLiteral(resolved, TEXT_CONTEXT, text->clean);
+    }
+    else {
+        _emitEscaped(resolved, strlen(resolved), TEXT_CONTEXT, false);
+    }
+}
+
+/**
+ * Sinks: the walk tells them when a node begins, its properties and text, and
+ * when it ends (the body of a node ends with the work that closes its tag).
+ * What they're told is the expanded page, so "@use", "@each" and "@if" are
+ * transparent, and texts are resolved.
+ */
+static void _beginNode(const char *type) {
+    for (unsigned int k = 0; k < _sinkCount; ++k) {
+        beginSinkNode(_sinks[k], type);
+    }
+}
+
+static void _addProperty(const char *key, const char *value) {
+    for (unsigned int k = 0; k < _sinkCount; ++k) {
+        addSinkProperty(_sinks[k], key, value);
+    }
+}
+
+static void _addProperties(const char *key, ParameterList *properties) {
+    for (unsigned int k = 0; k < _sinkCount; ++k) {
+        addSinkProperties(_sinks[k], key, properties);
+    }
+}
+
+static void _addText(const char *text) {
+    const size_t length = strlen(text);
+    for (unsigned int k = 0; k < _sinkCount; ++k) {
+        addSinkText(_sinks[k], text, length);
+    }
+}
+
+static void _endNode(void) {
+    for (unsigned int k = 0; k < _sinkCount; ++k) {
+        endSinkNode(_sinks[k]);
+    }
+}
+
+/**
+ * A node that only holds a text (e.g. a paragraph).
+ */
+static void _textNode(const char *type, Text *text) {
+    if (_sinkCount == 0) {
+        return;
+    }
+    _beginNode(type);
+    _addText(_resolveText(text->content));
+    _endNode();
+}
+
+/**
+ * Folds the static fragments of a statement list, unless there are sinks or
+ * loading hints: a folded fragment is reused as HTML, without walking its
+ * nodes, nor counting its images.
+ */
+static void _fold(StatementList *list) {
+    if (_sinkCount == 0 && !_imageHints) {
+        foldStatementList(list, _symbolTable);
+    }
+}
+
+/**
+ * Generates a "@use": reuses its expansion if it's cached, or starts
+ * expanding it. Returns true in the latter case, where the expansion leaves
+ * the nesting level of the "@use" once it's finished.
+ */
+static boolean _expand(unsigned indent, Use *use) {
+    Define *define = _resolveDefine(&use->define, use->name);
+    if (!define) {
+        return false;
+    }
+    CachedExpansion *expansion = _cacheable()
+        ? findCachedExpansion(_expansionCache, define, use->parameters, _cacheIndentation(indent))
+        : NULL;
+    if (expansion) {
+        if (chargeExpandedNodes(expansion->nodes)) {
+            _reuse(expansion->savedBytes, expansion->lines, indent, expansion->html, expansion->length, false);
+        }
+        return false;
+    }
+    _beginExpansion(define, use->parameters, indent);
+    return true;
+}
+
+static const char* lookupLocalParam(const char *key) {
+	Parameter *v = _bindings.values;
+	for (Parameter *p = _bindings.parameters; p && v; p = p->next, v = v->next) {
+		if (p->key && strcmp(p->key, key) == 0 && v->value) {
+			return v->value;
+        }
+    }
+    return NULL;
+}
+
+
+/**
+ * Starts generating a statement: writes what it can right away, and pushes
+ * the work that its body (and its closing tag) still need. The nesting level
+ * entered here is left once that work is done.
+ */
+static void _visit(unsigned indent, Statement *s) {
+	if(!s || !enterNesting()){
+		return;
+	}
+    switch (s->type) {
+        case STATEMENT_HEADER1:
+            _emitText(indent, H1_OPEN, s->text, H1_CLOSE);
+            _textNode("h1", s->text);
+            break;
+        case STATEMENT_HEADER2:
+            _emitText(indent, H2_OPEN, s->text, H2_CLOSE);
+            _textNode("h2", s->text);
+            break;
+        case STATEMENT_HEADER3:
+            _emitText(indent, H3_OPEN, s->text, H3_CLOSE);
+            _textNode("h3", s->text);
+            break;
+        case STATEMENT_PARAGRAPH:
+            _emitText(indent, P_OPEN, s->text, P_CLOSE);
+            _textNode("p", s->text);
+            break;
+        case STATEMENT_IMAGE: {
+            _beginLine(indent);
+            _emitFragment(IMG_OPEN);
+            _emitLiteral(s->image->src, ATTRIBUTE_CONTEXT, s->image->clean);
+            _emitFragment(IMG_ALT);
+            _emitLiteral(s->image->alt, ATTRIBUTE_CONTEXT, s->image->clean);
+            _emitFragment(QUOTE);
+            _emitImageAttributes(s->image);
+            _emitStyle(s->image->style);
+            _emitFragment(IMG_CLOSE);
+            _endLine();
+            _beginNode("img");
+            _addProperty("src", s->image->src);
+            _addProperty("alt", s->image->alt);
+            _addProperties("style", s->image->style);
+            _endNode();
+            break;
+        }
+        case STATEMENT_NAV: {
+            _emitOpeningWithAttributes(indent, NAV_OPEN, s->nav->style, s->nav->attributes);
+            _beginNode("nav");
+            _addProperties("style", s->nav->style);
+            _addProperties("attributes", s->nav->attributes);
+            for (NavItem *it = s->nav->items; it; it = it->next) {
+                _beginLine(indent+1);
+                _emitFragment(LINK_OPEN);
+                _emitLiteral(it->link, ATTRIBUTE_CONTEXT, it->clean);
+                _emitFragment(LINK_LABEL);
+                _emitLiteral(it->label, TEXT_CONTEXT, it->clean);
+                _emitFragment(LINK_CLOSE);
+                _endLine();
+                _beginNode("a");
+                _addProperty("href", it->link);
+                _addText(it->label);
+                _endNode();
+            }
+            _emitLine(indent, NAV_CLOSE);
+            _endNode();
+            break;
+        }
+        case STATEMENT_FORM: {
+            _emitOpeningWithAttributes(indent, FORM_OPEN, s->form->style, s->form->attributes);
+            _beginNode("form");
+            _addProperties("style", s->form->style);
+            _addProperties("attributes", s->form->attributes);
+            for (FormItem *it = s->form->items; it; it = it->next) {
+                _beginLine(indent+1);
+                _emitFragment(LABEL_OPEN);
+                _emitLiteral(it->label, TEXT_CONTEXT, it->clean);
+                _emitFragment(LABEL_INPUT);
+                _emitLiteral(it->placeholder, ATTRIBUTE_CONTEXT, it->clean);
+                _emitFragment(LABEL_CLOSE);
+                _endLine();
+                _beginNode("label");
+                _addProperty("placeholder", it->placeholder);
+                _addText(it->label);
+                _endNode();
+            }
+            _emitLine(indent, FORM_CLOSE);
+            _endNode();
+            break;
+        }
+        case STATEMENT_FOOTER:
+            _emitOpening(indent, FOOTER_OPEN, s->footer->style);
+            _beginNode("footer");
+            _addProperties("style", s->footer->style);
+            _pushBody(indent, FOOTER_CLOSE, s->footer->body, s->weight);
+            return;
+        case STATEMENT_CARD:
+            _emitOpening(indent, CARD_OPEN, s->card->style);
+            _beginNode("card");
+            _addProperties("style", s->card->style);
+            _pushBody(indent, DIV_CLOSE, s->card->body, s->weight);
+            return;
+        case STATEMENT_BUTTON:
+            _emitOpeningWithAttributes(indent, BUTTON_OPEN, s->button->style, s->button->action);
+            _beginNode("button");
+            _addProperties("style", s->button->style);
+            _addProperties("attributes", s->button->action);
+            _pushBody(indent, BUTTON_CLOSE, s->button->body, s->weight);
+            return;
+        case STATEMENT_TABLE:
+            _emitOpening(indent, TABLE_OPEN, s->table->style);
+            _beginNode("table");
+            _addProperties("style", s->table->style);
+            _push(WORK_CLOSE, indent)->fragment = TABLE_CLOSE;
+            _push(WORK_TABLE_ROWS, indent)->rows = s->table->rows;
+            return;
+        case STATEMENT_UNORDERED_LIST:
+            _emitOpening(indent, UL_OPEN, s->unordered_list->style);
+            _beginNode("ul");
+            _addProperties("style", s->unordered_list->style);
+            _pushBody(indent, UL_CLOSE, s->unordered_list->items, s->weight);
+            return;
+        case STATEMENT_BULLET_ITEM:
+            _emitLine(indent, LI_OPEN);
+            _beginNode("li");
+            _push(WORK_CLOSE, indent)->fragment = LI_CLOSE;
+            _push(WORK_STATEMENT, indent+1)->statement = s->bullet_item->body;
+            return;
+        case STATEMENT_ORDERED_LIST:
+            _emitOpening(indent, OL_OPEN, s->ordered_list->style);
+            _beginNode("ol");
+            _addProperties("style", s->ordered_list->style);
+            _pushBody(indent, OL_CLOSE, s->ordered_list->items, s->weight);
+            return;
+        case STATEMENT_ORDERED_ITEM:
+            _beginLine(indent);
+            _emitFragment(LI_VALUE_OPEN);
+            _emitLiteral(s->ordered_item->number, ATTRIBUTE_CONTEXT, s->ordered_item->clean);
+            _emitFragment(STYLE_END);
+            _endLine();
+            _beginNode("li");
+            _addProperty("value", s->ordered_item->number);
+            _push(WORK_CLOSE, indent)->fragment = LI_CLOSE;
+            _push(WORK_STATEMENT, indent+1)->statement = s->ordered_item->body;
+            return;
+        case STATEMENT_ROW:
+            _beginLine(indent);
+            _emitRowOpeningTag(s->row->style);
+            _endLine();
+            _beginNode("row");
+            _addProperties("style", s->row->style);
+            _pushBody(indent, DIV_CLOSE, s->row->columns, s->weight);
+            return;
+        case STATEMENT_COLUMN:
+            _emitOpening(indent, COLUMN_OPEN, s->column->style);
+            _beginNode("column");
+            _addProperties("style", s->column->style);
+            _pushBody(indent, DIV_CLOSE, s->column->body, s->weight);
+            return;
+        case STATEMENT_DEFINE:
+            registerDefine(_defineRegistry, s->define);
+            break;
+        case STATEMENT_USE:
+            if (_expand(indent, s->use)) {
+                return;
+            }
+            break;
+        case STATEMENT_EACH: {
+            Define *define = _resolveDefine(&s->each->define, s->each->name);
+            if (define && _beginEach(indent, define, s->each->path)) {
+                return;
+            }
+            break;
+        }
+        case STATEMENT_CONDITIONAL: {
+            const char *value = lookupLocalParam(s->conditional->parameter);
+            const boolean holds = value != NULL && strcmp(value, s->conditional->literal) == 0;
+            StatementList *branch = holds != s->conditional->negated
+                ? s->conditional->thenBody
+                : s->conditional->elseBody;
+            _push(WORK_LEAVE, indent);
+            _push(WORK_STATEMENTS, indent)->statements = branch;
+            return;
+        }
+        case STATEMENT_STATIC_HTML: {
+            StaticRender *render = _findStaticRender(s->static_html, _cacheIndentation(indent));
+            if (!render) {
+                _beginStaticRender(s->static_html, indent);
+                return;
+            }
+            if (chargeExpandedNodes(render->nodes)) {
+                _reuse(render->savedBytes, render->lines, indent, render->html, render->length, true);
+            }
+            break;
+        }
+        default:
+            logError(_logger, "Tipo de statement no soportado: %d", s->type);
+            break;
+    }
+    leaveNesting();
+}
+
+/**
+ * Runs the work on top of the stack until it goes back to the given height.
+ */
+static void _run(const size_t base) {
+    while (_workCount > base) {
+        Work *work = &_work[_workCount - 1];
+        const unsigned int indent = work->indent;
+        switch (work->type) {
+            case WORK_STATEMENTS: {
+                StatementList *it = work->statements;
+                if (!it) {
+                    --_workCount;
+                    break;
+                }
+                work->statements = it->next;
+                _visit(indent, it->statement);
+                break;
+            }
+            case WORK_STATEMENT:
+                --_workCount;
+                _visit(indent, work->statement);
+                break;
+            case WORK_TABLE_ROWS: {
+                TableRowList *r = work->rows;
+                if (!r) {
+                    --_workCount;
+                    break;
+                }
+                work->rows = r->next;
+                _emitLine(indent+1, TR_OPEN);
+                _beginNode("tr");
+                _push(WORK_CLOSE_LINE, indent+1)->fragment = TR_CLOSE;
+                _push(WORK_TABLE_CELLS, indent+1)->cells = r->row->cells;
+                break;
+            }
+            case WORK_TABLE_CELLS: {
+                TableCellList *c = work->cells;
+                if (!c) {
+                    --_workCount;
+                    break;
+                }
+                work->cells = c->next;
+                _emitLine(indent+1, TD_OPEN);
+                _beginNode("td");
+                _push(WORK_CLOSE_LINE, indent+1)->fragment = TD_CLOSE;
+                if (!_split(c->cell->content, indent+2, _listWeight(c->cell->content))) {
+                    _push(WORK_STATEMENTS, indent+2)->statements = c->cell->content;
+                }
+                break;
+            }
+            case WORK_CLOSE:
+                --_workCount;
+                _emitLine(indent, work->fragment);
+                _endNode();
+                leaveNesting();
+                break;
+            case WORK_CLOSE_LINE:
+                --_workCount;
+                _emitLine(indent, work->fragment);
+                _endNode();
+                break;
+            case WORK_LEAVE:
+                --_workCount;
+                leaveNesting();
+                break;
+            case WORK_FINISH_RENDER:
+                --_workCount;
+                _finishRender(indent, work->render);
+                break;
+            case WORK_CODE:
+                _interpret();
+                break;
+            case WORK_NEXT_RECORD: {
+                PendingEach *each = work->each;
+                if (_bindNextRecord(each)) {
+                    _pushDefineBody(indent, each->define);
+                }
+                else {
+                    --_workCount;
+                    _finishEach(each);
+                }
+                break;
+            }
+        }
+    }
+}
+
+/**
+ * Generates a statement, and everything nested in it.
+ */
+static void _generateStatement(unsigned indent, Statement *s) {
+    const size_t base = _workCount;
+    _visit(indent, s);
+    _run(base);
+}
+
+
+/**
+ * Bytecode: a statement list can be compiled into linear code, which
+ * "_interpret" runs instead of walking the tree of every statement. What
+ * doesn't change from one run to the next is worked out while compiling:
+ * the fragments, styles and attributes of a line are merged into constant
+ * bytes (already escaped and minified), and every text is resolved to a
+ * constant, or to the parameter of the define that it names. Lists and
+ * tables are laid out in the code, so they're not looped over. A "@use"
+ * runs the code of its define, and "@each", "@define" and folded static
+ * fragments are left to the tree walker (the body of an "@each" runs as
+ * code too).
+ *
+ * The compiler walks the tree the way "_run" does, with a stack of these.
+ */
+typedef enum {
+    COMPILE_PROGRAM,
+    COMPILE_STATEMENTS,
+    COMPILE_STATEMENT,
+    COMPILE_TABLE_ROWS,
+    COMPILE_TABLE_CELLS,
+    // Closes the tag of a statement, and leaves its nesting level.
+    COMPILE_CLOSE,
+    COMPILE_CLOSE_LINE,
+    COMPILE_LEAVE,
+    // Jumps over the "@else" branch at the end of the "@if" one, and
+    // compiles it.
+    COMPILE_ELSE,
+    // Points a jump at the next instruction.
+    COMPILE_LANDING,
+    COMPILE_FLUSH
+} CompilationType;
+
+typedef struct Compilation {
+    CompilationType type;
+    unsigned int depth;
+    // The instruction to point at the end: the ENTER of a statement, or a jump.
+    size_t patch;
+    union {
+        StatementList *statements;
+        Statement *statement;
+        TableRowList *rows;
+        TableCellList *cells;
+        FragmentType fragment;
+    };
+} Compilation;
+
+static const size_t _noSlot = (size_t) -1;
+// The code being compiled, and the parameters of its define.
+static Bytecode * _code = NULL;
+static Parameter * _codeParameters = NULL;
+// Where the constant bytes not taken by an instruction yet start, and the
+// bytes saved until then.
+static size_t _constantsMark = 0;
+static size_t _savedMark = 0;
+static Compilation * _compilations = NULL;
+static size_t _compilationCount = 0;
+static size_t _compilationCapacity = 0;
+
+static Compilation * _pushCompilation(const CompilationType type, const unsigned int depth) {
+    if (_compilationCount == _compilationCapacity) {
+        _compilationCapacity = _compilationCapacity == 0 ? 256 : 2 * _compilationCapacity;
+        _compilations = realloc(_compilations, _compilationCapacity * sizeof(Compilation));
+    }
+    Compilation *compilation = &_compilations[_compilationCount++];
+    compilation->type = type;
+    compilation->depth = depth;
+    return compilation;
+}
+
+static Instruction * _instruction(const size_t k) {
+    return &_code->instructions[k];
+}
+
+/**
+ * Takes the constant bytes written since the last instruction (and what the
+ * minified output saved in them) into a STATIC one.
+ */
+static void _takeConstants(void) {
+    const size_t length = _code->constants.length - _constantsMark;
+    const size_t saved = _savedBytes - _savedMark;
+    if (length > 0 || saved > 0) {
+        Instruction *instruction = _instruction(appendInstruction(_code, OP_STATIC, 0));
+        instruction->offset = _constantsMark;
+        instruction->length = length;
+        instruction->saved = saved;
+    }
+    _constantsMark = _code->constants.length;
+    _savedMark = _savedBytes;
+}
+
+static size_t _compileInstruction(const Opcode opcode, const unsigned int depth) {
+    _takeConstants();
+    return appendInstruction(_code, opcode, depth);
+}
+
+/**
+ * Ends a line. A line of constant bytes becomes a single instruction.
+ */
+static void _compileEndLine(void) {
+    const size_t end = _compileInstruction(OP_END_LINE, 0);
+    if (end >= 2 && _instruction(end - 1)->opcode == OP_STATIC && _instruction(end - 2)->opcode == OP_BEGIN_LINE) {
+        Instruction line = *_instruction(end - 1);
+        line.opcode = OP_LINE;
+        line.depth = _instruction(end - 2)->depth;
+        *_instruction(end - 2) = line;
+        _code->count = end - 1;
+    }
+}
+
+static void _compileLine(const unsigned int depth, const FragmentType type) {
+    _compileInstruction(OP_BEGIN_LINE, depth);
+    _emitFragment(type);
+    _compileEndLine();
+}
+
+/**
+ * Leaves the nesting level of a statement, where its ENTER jumps if it can't
+ * enter it. A statement that is a line of constant bytes becomes a single
+ * instruction.
+ */
+static void _compileLeave(const size_t enter) {
+    const size_t leave = _compileInstruction(OP_LEAVE, 0);
+    _instruction(enter)->jump = leave + 1 - enter;
+    if (leave == enter + 2 && _instruction(enter + 1)->opcode == OP_LINE) {
+        Instruction node = *_instruction(enter + 1);
+        node.opcode = OP_NODE;
+        *_instruction(enter) = node;
+        _code->count = enter + 1;
+    }
+}
+
+/**
+ * The position of the parameter that a name refers to, if it's one of the
+ * define being compiled.
+ */
+static size_t _slot(const char *name) {
+    size_t k = 0;
+    for (Parameter *p = _codeParameters; p; p = p->next, ++k) {
+        if (p->key && strcmp(p->key, name) == 0) {
+            return k;
+        }
+    }
+    return _noSlot;
+}
+
+/**
+ * Compiles the line of a text. If it names a parameter, its argument is
+ * written when it runs, and what it resolves to otherwise is kept in case
+ * there's no argument.
+ */
+static void _compileText(const unsigned int depth, const FragmentType open, Text *text, const FragmentType close) {
+    _compileInstruction(OP_BEGIN_LINE, depth);
+    _emitFragment(open);
+    const size_t slot = _slot(text->content);
+    if (slot == _noSlot) {
+        _emitTextContent(text);
+    }
+    else {
+        Instruction *argument = _instruction(_compileInstruction(OP_ARGUMENT, depth));
+        _emitTextContent(text);
+        argument->slot = slot;
+        argument->offset = _constantsMark;
+        argument->length = _code->constants.length - _constantsMark;
+        _constantsMark = _code->constants.length;
+    }
+    _emitFragment(close);
+    _compileEndLine();
+}
+
+static void _compileOpening(const unsigned int depth, const FragmentType open, ParameterList *style) {
+    _compileInstruction(OP_BEGIN_LINE, depth);
+    _emitOpeningTag(open, style);
+    _compileEndLine();
+}
+
+static void _compileOpeningWithAttributes(const unsigned int depth, const FragmentType open, ParameterList *style, ParameterList *attributes) {
+    _compileInstruction(OP_BEGIN_LINE, depth);
+    _emitOpeningTagWithAttributes(open, style, attributes);
+    _compileEndLine();
+}
+
+static void _compileBody(const unsigned int depth, const FragmentType close, StatementList *body, const size_t enter) {
+    Compilation *compilation = _pushCompilation(COMPILE_CLOSE, depth);
+    compilation->fragment = close;
+    compilation->patch = enter;
+    _pushCompilation(COMPILE_STATEMENTS, depth + 1)->statements = body;
+}
+
+/**
+ * Compiles what a statement writes right away, and pushes what its body
+ * (and its closing tag) still need, as "_visit" does.
+ */
+static void _compileStatement(const unsigned int depth, Statement *s) {
+    if (!s) {
+        return;
+    }
+    switch (s->type) {
+        case STATEMENT_USE:
+            _instruction(_compileInstruction(OP_CALL, depth))->statement = s;
+            return;
+        case STATEMENT_HEADER1: case STATEMENT_HEADER2: case STATEMENT_HEADER3: case STATEMENT_PARAGRAPH:
+        case STATEMENT_IMAGE: case STATEMENT_NAV: case STATEMENT_FORM: case STATEMENT_FOOTER:
+        case STATEMENT_CARD: case STATEMENT_BUTTON: case STATEMENT_TABLE: case STATEMENT_UNORDERED_LIST:
+        case STATEMENT_BULLET_ITEM: case STATEMENT_ORDERED_LIST: case STATEMENT_ORDERED_ITEM:
+        case STATEMENT_ROW: case STATEMENT_COLUMN: case STATEMENT_CONDITIONAL:
+            break;
+        default:
+            _instruction(_compileInstruction(OP_VISIT, depth))->statement = s;
+            return;
+    }
+    const size_t enter = _compileInstruction(OP_ENTER, depth);
+    switch (s->type) {
+        case STATEMENT_HEADER1:
+            _compileText(depth, H1_OPEN, s->text, H1_CLOSE);
+            break;
+        case STATEMENT_HEADER2:
+            _compileText(depth, H2_OPEN, s->text, H2_CLOSE);
+            break;
+        case STATEMENT_HEADER3:
+            _compileText(depth, H3_OPEN, s->text, H3_CLOSE);
+            break;
+        case STATEMENT_PARAGRAPH:
+            _compileText(depth, P_OPEN, s->text, P_CLOSE);
+            break;
+        case STATEMENT_IMAGE:
+            _compileInstruction(OP_BEGIN_LINE, depth);
+            _emitFragment(IMG_OPEN);
+            _emitLiteral(s->image->src, ATTRIBUTE_CONTEXT, s->image->clean);
+            _emitFragment(IMG_ALT);
+            _emitLiteral(s->image->alt, ATTRIBUTE_CONTEXT, s->image->clean);
+            _emitFragment(QUOTE);
+            _emitImageAttributes(s->image);
+            _emitStyle(s->image->style);
+            _emitFragment(IMG_CLOSE);
+            _compileEndLine();
+            break;
+        case STATEMENT_NAV:
+            _compileOpeningWithAttributes(depth, NAV_OPEN, s->nav->style, s->nav->attributes);
+            for (NavItem *it = s->nav->items; it; it = it->next) {
+                _compileInstruction(OP_BEGIN_LINE, depth + 1);
+                _emitFragment(LINK_OPEN);
+                _emitLiteral(it->link, ATTRIBUTE_CONTEXT, it->clean);
+                _emitFragment(LINK_LABEL);
+                _emitLiteral(it->label, TEXT_CONTEXT, it->clean);
+                _emitFragment(LINK_CLOSE);
+                _compileEndLine();
+            }
+            _compileLine(depth, NAV_CLOSE);
+            break;
+        case STATEMENT_FORM:
+            _compileOpeningWithAttributes(depth, FORM_OPEN, s->form->style, s->form->attributes);
+            for (FormItem *it = s->form->items; it; it = it->next) {
+                _compileInstruction(OP_BEGIN_LINE, depth + 1);
+                _emitFragment(LABEL_OPEN);
+                _emitLiteral(it->label, TEXT_CONTEXT, it->clean);
+                _emitFragment(LABEL_INPUT);
+                _emitLiteral(it->placeholder, ATTRIBUTE_CONTEXT, it->clean);
+                _emitFragment(LABEL_CLOSE);
+                _compileEndLine();
+            }
+            _compileLine(depth, FORM_CLOSE);
+            break;
+        case STATEMENT_FOOTER:
+            _compileOpening(depth, FOOTER_OPEN, s->footer->style);
+            _compileBody(depth, FOOTER_CLOSE, s->footer->body, enter);
+            return;
+        case STATEMENT_CARD:
+            _compileOpening(depth, CARD_OPEN, s->card->style);
+            _compileBody(depth, DIV_CLOSE, s->card->body, enter);
+            return;
+        case STATEMENT_BUTTON:
+            _compileOpeningWithAttributes(depth, BUTTON_OPEN, s->button->style, s->button->action);
+            _compileBody(depth, BUTTON_CLOSE, s->button->body, enter);
+            return;
+        case STATEMENT_TABLE: {
+            _compileOpening(depth, TABLE_OPEN, s->table->style);
+            Compilation *close = _pushCompilation(COMPILE_CLOSE, depth);
+            close->fragment = TABLE_CLOSE;
+            close->patch = enter;
+            _pushCompilation(COMPILE_TABLE_ROWS, depth)->rows = s->table->rows;
+            return;
+        }
+        case STATEMENT_UNORDERED_LIST:
+            _compileOpening(depth, UL_OPEN, s->unordered_list->style);
+            _compileBody(depth, UL_CLOSE, s->unordered_list->items, enter);
+            return;
+        case STATEMENT_BULLET_ITEM: {
+            _compileLine(depth, LI_OPEN);
+            Compilation *close = _pushCompilation(COMPILE_CLOSE, depth);
+            close->fragment = LI_CLOSE;
+            close->patch = enter;
+            _pushCompilation(COMPILE_STATEMENT, depth + 1)->statement = s->bullet_item->body;
+            return;
+        }
+        case STATEMENT_ORDERED_LIST:
+            _compileOpening(depth, OL_OPEN, s->ordered_list->style);
+            _compileBody(depth, OL_CLOSE, s->ordered_list->items, enter);
+            return;
+        case STATEMENT_ORDERED_ITEM: {
+            _compileInstruction(OP_BEGIN_LINE, depth);
+            _emitFragment(LI_VALUE_OPEN);
+            _emitLiteral(s->ordered_item->number, ATTRIBUTE_CONTEXT, s->ordered_item->clean);
+            _emitFragment(STYLE_END);
+            _compileEndLine();
+            Compilation *close = _pushCompilation(COMPILE_CLOSE, depth);
+            close->fragment = LI_CLOSE;
+            close->patch = enter;
+            _pushCompilation(COMPILE_STATEMENT, depth + 1)->statement = s->ordered_item->body;
+            return;
+        }
+        case STATEMENT_ROW:
+            _compileInstruction(OP_BEGIN_LINE, depth);
+            _emitRowOpeningTag(s->row->style);
+            _compileEndLine();
+            _compileBody(depth, DIV_CLOSE, s->row->columns, enter);
+            return;
+        case STATEMENT_COLUMN:
+            _compileOpening(depth, COLUMN_OPEN, s->column->style);
+            _compileBody(depth, DIV_CLOSE, s->column->body, enter);
+            return;
+        case STATEMENT_CONDITIONAL: {
+            Conditional *conditional = s->conditional;
+            _pushCompilation(COMPILE_LEAVE, depth)->patch = enter;
+            const size_t slot = _slot(conditional->parameter);
+            if (slot == _noSlot) {
+                // Nothing is ever bound to it, so it never holds.
+                _pushCompilation(COMPILE_STATEMENTS, depth)->statements = conditional->negated
+                    ? conditional->thenBody
+                    : conditional->elseBody;
+                return;
+            }
+            const size_t branch = _compileInstruction(conditional->negated ? OP_BRANCH_IF_EQUAL : OP_BRANCH_UNLESS_EQUAL, depth);
+            _instruction(branch)->slot = slot;
+            _instruction(branch)->bytes = conditional->literal;
+            Compilation *otherwise = _pushCompilation(COMPILE_ELSE, depth);
+            otherwise->patch = branch;
+            otherwise->statements = conditional->elseBody;
+            _pushCompilation(COMPILE_STATEMENTS, depth)->statements = conditional->thenBody;
+            return;
+        }
+        default:
+            break;
+    }
+    _compileLeave(enter);
+}
+
+/**
+ * Compiles a statement list as the given kind of code. The code is kept until
+ * the generator is shut down.
+ */
+static Bytecode * _compile(StatementList *list, Parameter *parameters, const CodeKind kind) {
+    OutputBuffer *target = _target;
+    const Bindings bindings = _bindings;
+    const size_t savedBytes = _savedBytes;
+    // Texts are resolved as if nothing was bound, since what's bound to
+    // parameters is only known when the code runs.
+    _bindings = (Bindings) { NULL, NULL };
+    _code = createBytecode();
+    _codeParameters = parameters;
+    _target = &_code->constants;
+    _constantsMark = 0;
+    _savedMark = _savedBytes;
+    if (kind == DOCUMENT_CODE) {
+        _compileInstruction(OP_BEGIN_LINE, 0);
+        _emitPrologue();
+        _compileEndLine();
+    }
+    _pushCompilation(kind == BODY_CODE ? COMPILE_STATEMENTS : COMPILE_PROGRAM, kind == DOCUMENT_CODE ? 1 : 0)->statements = list;
+    while (_compilationCount > 0) {
+        Compilation *compilation = &_compilations[_compilationCount - 1];
+        const unsigned int depth = compilation->depth;
+        switch (compilation->type) {
+            case COMPILE_PROGRAM:
+            case COMPILE_STATEMENTS: {
+                StatementList *it = compilation->statements;
+                if (!it) {
+                    --_compilationCount;
+                    break;
+                }
+                compilation->statements = it->next;
+                if (compilation->type == COMPILE_PROGRAM && it->statement && _flushPolicy == FLUSH_STATEMENTS) {
+                    _pushCompilation(COMPILE_FLUSH, depth);
+                }
+                _compileStatement(depth, it->statement);
+                break;
+            }
+            case COMPILE_STATEMENT:
+                --_compilationCount;
+                _compileStatement(depth, compilation->statement);
+                break;
+            case COMPILE_TABLE_ROWS: {
+                TableRowList *r = compilation->rows;
+                if (!r) {
+                    --_compilationCount;
+                    break;
+                }
+                compilation->rows = r->next;
+                _compileLine(depth + 1, TR_OPEN);
+                _pushCompilation(COMPILE_CLOSE_LINE, depth + 1)->fragment = TR_CLOSE;
+                _pushCompilation(COMPILE_TABLE_CELLS, depth + 1)->cells = r->row->cells;
+                break;
+            }
+            case COMPILE_TABLE_CELLS: {
+                TableCellList *c = compilation->cells;
+                if (!c) {
+                    --_compilationCount;
+                    break;
+                }
+                compilation->cells = c->next;
+                _compileLine(depth + 1, TD_OPEN);
+                _pushCompilation(COMPILE_CLOSE_LINE, depth + 1)->fragment = TD_CLOSE;
+                _pushCompilation(COMPILE_STATEMENTS, depth + 2)->statements = c->cell->content;
+                break;
+            }
+            case COMPILE_CLOSE: {
+                --_compilationCount;
+                const size_t enter = compilation->patch;
+                _compileLine(depth, compilation->fragment);
+                _compileLeave(enter);
+                break;
+            }
+            case COMPILE_CLOSE_LINE:
+                --_compilationCount;
+                _compileLine(depth, compilation->fragment);
+                break;
+            case COMPILE_LEAVE:
+                --_compilationCount;
+                _compileLeave(compilation->patch);
+                break;
+            case COMPILE_ELSE: {
+                --_compilationCount;
+                const size_t branch = compilation->patch;
+                StatementList *otherwise = compilation->statements;
+                const size_t jump = _compileInstruction(OP_JUMP, depth);
+                _instruction(branch)->jump = jump + 1 - branch;
+                _pushCompilation(COMPILE_LANDING, depth)->patch = jump;
+                _pushCompilation(COMPILE_STATEMENTS, depth)->statements = otherwise;
+                break;
+            }
+            case COMPILE_LANDING:
+                --_compilationCount;
+                _takeConstants();
+                _instruction(compilation->patch)->jump = _code->count - compilation->patch;
+                break;
+            case COMPILE_FLUSH:
+                --_compilationCount;
+                _compileInstruction(OP_FLUSH, 0);
+                break;
+        }
+    }
+    if (kind == DOCUMENT_CODE) {
+        _compileLine(0, _minify ? MINIFIED_EPILOGUE : EPILOGUE);
+    }
+    _compileInstruction(OP_RETURN, 0);
+    finishBytecode(_code);
+    _compiledInstructions += _code->count;
+    _code->next = _bytecodes;
+    _bytecodes = _code;
+    _code = NULL;
+    _target = target;
+    _bindings = bindings;
+    _savedBytes = savedBytes;
+    return _bytecodes;
+}
+
+/**
+ * Releases the compiled code, once the output (which can point at its
+ * constants) has been closed.
+ */
+static void _freeBytecodes(void) {
+    while (_bytecodes) {
+        Bytecode *next = _bytecodes->next;
+        destroyBytecode(_bytecodes);
+        _bytecodes = next;
+    }
+    free(_compilations);
+    _compilations = NULL;
+    _compilationCount = 0;
+    _compilationCapacity = 0;
+}
+
+/**
+ * The argument bound to a parameter of the define being expanded, if any.
+ */
+static const char * _argument(const size_t slot) {
+    Parameter *value = _bindings.values;
+    for (size_t k = 0; value && k < slot; ++k) {
+        value = value->next;
+    }
+    return value ? value->value : NULL;
+}
+
+/**
+ * Runs the code on top of the work stack until it returns, or until it hands
+ * a statement to the tree walker (it goes on where it left once that's been
+ * generated). Every instruction jumps straight to the next one through a
+ * table of labels (a GNU C extension).
+ */
+static void _interpret(void) {
+    static const void * const dispatch[] = {
+        [OP_ENTER] = &&enter,
+        [OP_LEAVE] = &&leave,
+        [OP_BEGIN_LINE] = &&beginLine,
+        [OP_END_LINE] = &&endLine,
+        [OP_STATIC] = &&constant,
+        [OP_LINE] = &&line,
+        [OP_NODE] = &&node,
+        [OP_ARGUMENT] = &&argument,
+        [OP_BRANCH_UNLESS_EQUAL] = &&branchUnlessEqual,
+        [OP_BRANCH_IF_EQUAL] = &&branchIfEqual,
+        [OP_JUMP] = &&jump,
+        [OP_CALL] = &&call,
+        [OP_VISIT] = &&visit,
+        [OP_FLUSH] = &&flush,
+        [OP_RETURN] = &&finish
+    };
+    Work *work = &_work[_workCount - 1];
+    const unsigned int indent = work->indent;
+    const Instruction *instruction = work->next;
+    const char *value;
+    #define DISPATCH() goto *dispatch[instruction->opcode]
+    #define NEXT() do { ++instruction; DISPATCH(); } while (0)
+    DISPATCH();
+enter:
+    if (!enterNesting()) {
+        instruction += instruction->jump;
+        DISPATCH();
+    }
+    NEXT();
+leave:
+    leaveNesting();
+    NEXT();
+beginLine:
+    _beginLine(indent + instruction->depth);
+    NEXT();
+endLine:
+    _endLine();
+    NEXT();
+constant:
+    _savedBytes += instruction->saved;
+    appendBorrowedToOutputBuffer(_target, instruction->bytes, instruction->length);
+    NEXT();
+line:
+    _beginLine(indent + instruction->depth);
+    _savedBytes += instruction->saved;
+    appendBorrowedToOutputBuffer(_target, instruction->bytes, instruction->length);
+    _endLine();
+    NEXT();
+node:
+    if (enterNesting()) {
+        _beginLine(indent + instruction->depth);
+        _savedBytes += instruction->saved;
+        appendBorrowedToOutputBuffer(_target, instruction->bytes, instruction->length);
+        _endLine();
+        leaveNesting();
+    }
+    NEXT();
+argument:
+    value = _argument(instruction->slot);
+    if (value) {
+        _emitEscaped(value, strlen(value), TEXT_CONTEXT, false);
+    }
+    else {
+        appendBorrowedToOutputBuffer(_target, instruction->bytes, instruction->length);
+    }
+    NEXT();
+branchUnlessEqual:
+    value = _argument(instruction->slot);
+    if (!value || strcmp(value, instruction->bytes) != 0) {
+        instruction += instruction->jump;
+        DISPATCH();
+    }
+    NEXT();
+branchIfEqual:
+    value = _argument(instruction->slot);
+    if (value && strcmp(value, instruction->bytes) == 0) {
+        instruction += instruction->jump;
+        DISPATCH();
+    }
+    NEXT();
+jump:
+    instruction += instruction->jump;
+    DISPATCH();
+call:
+    work->next = instruction + 1;
+    if (enterNesting() && !_expand(indent + instruction->depth, instruction->statement->use)) {
+        leaveNesting();
+    }
+    return;
+visit:
+    work->next = instruction + 1;
+    _visit(indent + instruction->depth, instruction->statement);
+    return;
+flush:
+    flushOutputBuffer(&_outputBuffer);
+    NEXT();
+finish:
+    --_workCount;
+    return;
+    #undef NEXT
+    #undef DISPATCH
+}
+
+
+/**
+ * A parallel generation splits the program in tasks: runs of sibling
+ * statements that weigh about "_taskWeight" nodes. A heavier statement gets
+ * a task of its own, where its body is split again if it's heavy enough (so
+ * a large "@use" or "@each" is a task that any thread can steal). Every task
+ * renders into a segment of its own, and the segments are written out in
+ * source order, so the output is the same no matter which thread renders
+ * what.
+ *
+ * The bytes of a segment are split in chunks: after a chunk can come the
+ * segment of a task spawned at that point.
+ */
+typedef struct Chunk {
+    OutputBuffer buffer;
+    struct Segment *segment;
+    struct Chunk *next;
+} Chunk;
+
+typedef struct Segment {
+    StatementList *first;
+    size_t count;
+    unsigned int indent;
+    // The nesting depth of the statements.
+    size_t depth;
+    Chunk *chunks;
+    Chunk *last;
+    // Set (under "_segmentLock") once the task is done.
+    boolean done;
+} Segment;
+
+/**
+ * A statement being weighed, and the children left to weigh.
+ */
+typedef struct Weighing {
+    Statement *statement;
+    StatementList *list;
+    // Another list to weigh after the first one (the else branch of an "@if").
+    StatementList *second;
+    Statement *single;
+    TableRowList *rows;
+    TableCellList *cells;
+    size_t weight;
+    boolean insideDefine;
+} Weighing;
+
+static pthread_mutex_t _segmentLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t _segmentDone = PTHREAD_COND_INITIALIZER;
+// The segment that this thread is rendering, if any.
+static __thread Segment * _segment = NULL;
+
+static size_t _listWeight(StatementList *list) {
+    size_t weight = 0;
+    for (StatementList *it = list; it; it = it->next) {
+        weight += it->statement ? it->statement->weight : 0;
+    }
+    return weight;
+}
+
+/**
+ * Starts weighing a statement. Every define is registered right away, and
+ * every "@use" and "@each" is bound to its define, so the threads only ever
+ * read the registry. Returns false if the statement can't be generated in
+ * parallel: a deferred define body is parsed while it's generated, and a
+ * define inside another one is only registered when the outer one is used.
+ */
+static void _children(Weighing *w, Statement *s);
+
+static boolean _beginWeighing(Weighing **stack, size_t *count, size_t *capacity, Statement *s) {
+    const boolean insideDefine = *count > 0 && ((*stack)[*count - 1].insideDefine
+        || (*stack)[*count - 1].statement->type == STATEMENT_DEFINE);
+    if (*count == *capacity) {
+        *capacity *= 2;
+        *stack = realloc(*stack, *capacity * sizeof(Weighing));
+    }
+    Weighing *w = &(*stack)[(*count)++];
+    memset(w, 0, sizeof(Weighing));
+    w->statement = s;
+    w->weight = 1;
+    w->insideDefine = insideDefine;
+    switch (s->type) {
+        case STATEMENT_DEFINE:
+            if (insideDefine || (!s->define->body && s->define->lazyBody)) {
+                return false;
+            }
+            registerDefine(_defineRegistry, s->define);
+            w->list = s->define->body;
+            break;
+        case STATEMENT_USE:
+            s->use->define = findDefine(_defineRegistry, s->use->name);
+            break;
+        case STATEMENT_EACH:
+            s->each->define = findDefine(_defineRegistry, s->each->name);
+            break;
+        case STATEMENT_NAV:
+            for (NavItem *it = s->nav->items; it; it = it->next) {
+                ++w->weight;
+            }
+            break;
+        case STATEMENT_FORM:
+            for (FormItem *it = s->form->items; it; it = it->next) {
+                ++w->weight;
+            }
+            break;
+        default:
+            _children(w, s);
+            break;
+    }
+    return true;
+}
+
+/**
+ * Points a weighing at the children of a statement (but the body of a
+ * define, which is up to the caller).
+ */
+static void _children(Weighing *w, Statement *s) {
+    switch (s->type) {
+        case STATEMENT_FOOTER: w->list = s->footer->body; break;
+        case STATEMENT_CARD: w->list = s->card->body; break;
+        case STATEMENT_BUTTON: w->list = s->button->body; break;
+        case STATEMENT_ROW: w->list = s->row->columns; break;
+        case STATEMENT_COLUMN: w->list = s->column->body; break;
+        case STATEMENT_UNORDERED_LIST: w->list = s->unordered_list->items; break;
+        case STATEMENT_ORDERED_LIST: w->list = s->ordered_list->items; break;
+        case STATEMENT_TABLE: w->rows = s->table->rows; break;
+        case STATEMENT_BULLET_ITEM: w->single = s->bullet_item->body; break;
+        case STATEMENT_ORDERED_ITEM: w->single = s->ordered_item->body; break;
+        case STATEMENT_STATIC_HTML: w->single = s->static_html->original; break;
+        case STATEMENT_CONDITIONAL:
+            w->list = s->conditional->thenBody;
+            w->second = s->conditional->elseBody;
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * The next child of a statement being weighed, or NULL once there are none.
+ */
+static Statement * _nextChild(Weighing *w) {
+    for (;;) {
+        if (w->list) {
+            Statement *child = w->list->statement;
+            w->list = w->list->next;
+            if (child) {
+                return child;
+            }
+        }
+        else if (w->second) {
+            w->list = w->second;
+            w->second = NULL;
+        }
+        else if (w->single) {
+            Statement *child = w->single;
+            w->single = NULL;
+            return child;
+        }
+        else if (w->cells) {
+            w->list = w->cells->cell->content;
+            w->cells = w->cells->next;
+        }
+        else if (w->rows) {
+            w->cells = w->rows->row->cells;
+            w->rows = w->rows->next;
+        }
+        else {
+            return NULL;
+        }
+    }
+}
+
+/**
+ * Weighs every statement of the program (in post-order, with an explicit
+ * stack), and returns true if it can be generated in parallel.
+ */
+static boolean _weigh(Program *program) {
+    size_t count = 0;
+    size_t capacity = 64;
+    Weighing *stack = malloc(capacity * sizeof(Weighing));
+    boolean parallel = true;
+    for (StatementList *it = program->statements; it && parallel; it = it->next) {
+        if (!it->statement || !(parallel = _beginWeighing(&stack, &count, &capacity, it->statement))) {
+            continue;
+        }
+        while (count > 0 && parallel) {
+            Weighing *w = &stack[count - 1];
+            Statement *child = _nextChild(w);
+            if (child) {
+                parallel = _beginWeighing(&stack, &count, &capacity, child);
+                continue;
+            }
+            Statement *s = w->statement;
+            size_t weight = w->weight;
+            if (s->type == STATEMENT_USE && s->use->define) {
+                weight += s->use->define->weight;
+            }
+            else if (s->type == STATEMENT_EACH) {
+                // The records are unknown, so it's always a task of its own.
+                weight += s->each->define ? s->each->define->weight : 0;
+                weight = weight > _taskWeight ? weight : _taskWeight + 1;
+            }
+            else if (s->type == STATEMENT_DEFINE) {
+                s->define->weight = weight - 1;
+                weight = 1;
+            }
+            s->weight = weight;
+            if (--count > 0) {
+                stack[count - 1].weight += weight;
+            }
+        }
+    }
+    free(stack);
+    return parallel;
+}
+
+/**
+ * The style of a statement, if it can have one.
+ */
+static boolean _styleOf(Statement *s, ParameterList **style) {
+    switch (s->type) {
+        case STATEMENT_IMAGE: *style = s->image->style; return true;
+        case STATEMENT_NAV: *style = s->nav->style; return true;
+        case STATEMENT_FORM: *style = s->form->style; return true;
+        case STATEMENT_FOOTER: *style = s->footer->style; return true;
+        case STATEMENT_CARD: *style = s->card->style; return true;
+        case STATEMENT_BUTTON: *style = s->button->style; return true;
+        case STATEMENT_TABLE: *style = s->table->style; return true;
+        case STATEMENT_UNORDERED_LIST: *style = s->unordered_list->style; return true;
+        case STATEMENT_ORDERED_LIST: *style = s->ordered_list->style; return true;
+        case STATEMENT_ROW: *style = s->row->style; return true;
+        case STATEMENT_COLUMN: *style = s->column->style; return true;
+        default: return false;
+    }
+}
+
+/**
+ * The rule of a style that more than one page of the site has, if a site is
+ * being generated.
+ */
+static StyleRule * _sharedRule(ParameterList *style, const boolean row) {
+    if (!_siteSheet) {
+        return NULL;
+    }
+    StyleRule *rule = findStyleRule(_siteSheet, style, row);
+    return rule && rule->pages > 1 ? rule : NULL;
+}
+
+/**
+ * Extracts the style of every statement of a list (in document order, with
+ * an explicit stack) into the rule of its declarations, which is added to
+ * the style sheet if it's new. Styles without declarations are left as they
+ * are, but the ones of rows, which have a "display:flex" anyway. Once the
+ * head has been written, rules can only be found (e.g. for a deferred define
+ * body, parsed while it's generated), and the styles without one stay inline.
+ */
+static void _collectStyles(StatementList *list, const boolean add) {
+    size_t count = 1;
+    size_t capacity = 64;
+    Weighing *stack = calloc(capacity, sizeof(Weighing));
+    stack[0].list = list;
+    while (count > 0) {
+        Statement *s = _nextChild(&stack[count - 1]);
+        if (!s) {
+            --count;
+            continue;
+        }
+        ParameterList *style = NULL;
+        const boolean row = s->type == STATEMENT_ROW;
+        if (_styleOf(s, &style) && (row || (style && style->head))) {
+            StyleRule *rule = _sharedRule(style, row);
+            if (!rule) {
+                rule = add
+                    ? addStyleRule(_styleSheet, style, row)
+                    : findStyleRule(_styleSheet, style, row);
+            }
+            if (style) {
+                style->rule = rule;
+            }
+            else if (add) {
+                _emptyRowRule = rule;
+            }
+        }
+        if (count == capacity) {
+            capacity *= 2;
+            stack = realloc(stack, capacity * sizeof(Weighing));
+        }
+        Weighing *w = &stack[count++];
+        memset(w, 0, sizeof(Weighing));
+        if (s->type == STATEMENT_DEFINE) {
+            w->list = s->define->body;
+        }
+        else {
+            _children(w, s);
+        }
+    }
+    free(stack);
+}
+
+/**
+ * Writes the rule of a class (without its indentation).
+ */
+static void _emitRule(const StyleRule *rule) {
+    _emitFragment(RULE_SELECTOR);
+    _emit(rule->name, rule->nameLength);
+    _emitFragment(RULE_OPEN);
+    if (rule->row) {
+        _emitFragment(ROW_DISPLAY);
+    }
+    for (size_t j = 0; j < rule->declarationsLength;) {
+        const char *key = rule->declarations + j;
+        const size_t keyLength = strlen(key);
+        const char *value = key + keyLength + 1;
+        const size_t valueLength = strlen(value);
+        _emitCss(key, keyLength);
+        _emitFragment(PROPERTY_VALUE);
+        _emitCss(value, valueLength);
+        _emitFragment(PROPERTY_END);
+        j += keyLength + valueLength + 2;
+    }
+    _emitFragment(RULE_CLOSE);
+}
+
+/**
+ * Renders the rules of the style sheet into the style block of the head
+ * (nothing, if there are none), after the link to the stylesheet of the site
+ * if it has one. Its bytes are left out of what the output saves, so they're
+ * charged back to it.
+ */
+static void _renderStyleBlock(void) {
+    openOutputBuffer(&_styleBlock, -1, 0);
+    const unsigned int count = styleRules(_styleSheet);
+    OutputBuffer *target = _target;
+    const size_t savedBytes = _savedBytes;
+    _target = &_styleBlock;
+    if (_siteStylesheet) {
+        _emitFragment(_minify ? MINIFIED_STYLESHEET_LINK_OPEN : STYLESHEET_LINK_OPEN);
+        _emit(_siteStylesheet, strlen(_siteStylesheet));
+        _emitFragment(_minify ? MINIFIED_STYLESHEET_LINK_CLOSE : STYLESHEET_LINK_CLOSE);
+    }
+    if (count > 0) {
+        _emitFragment(_minify ? MINIFIED_STYLE_BLOCK_OPEN : STYLE_BLOCK_OPEN);
+        for (unsigned int k = 0; k < count; ++k) {
+            if (!_minify) {
+                _emitFragment(RULE_INDENTATION);
+            }
+            _emitRule(styleRule(_styleSheet, k));
+            if (!_minify) {
+                _emitFragment(NEWLINE_FRAGMENT);
+            }
+        }
+        _emitFragment(_minify ? MINIFIED_STYLE_BLOCK_CLOSE : STYLE_BLOCK_CLOSE);
+    }
+    _target = target;
+    _savedBytes = savedBytes;
+}
+
+/**
+ * Writes the rules that more than one page of the site shares into their own
+ * stylesheet, named after the hash of its content (so that browsers cache it
+ * for as long as it doesn't change). A stylesheet with that name already has
+ * that content, so it's only written if it's missing. Returns false if it
+ * couldn't be written.
+ */
+static boolean _writeSiteStylesheet(void) {
+    OutputBuffer css = { .descriptor = -1 };
+    openOutputBuffer(&css, -1, 0);
+    OutputBuffer *target = _target;
+    const size_t savedBytes = _savedBytes;
+    _target = &css;
+    unsigned int shared = 0;
+    for (unsigned int k = 0; k < styleRules(_siteSheet); ++k) {
+        const StyleRule *rule = styleRule(_siteSheet, k);
+        if (rule->pages > 1) {
+            _emitRule(rule);
+            if (!_minify) {
+                _emitFragment(NEWLINE_FRAGMENT);
+            }
+            ++shared;
+        }
+    }
+    if (_minify && shared > 0) {
+        _emitFragment(NEWLINE_FRAGMENT);
+    }
+    _target = target;
+    _savedBytes = savedBytes;
+    if (shared == 0) {
+        closeOutputBuffer(&css);
+        return true;
+    }
+    // The 32 bits of the FNV-1a hash of the stylesheet.
+    uint32_t hash = 2166136261u;
+    for (size_t k = 0; k < css.length; ++k) {
+        hash = (hash ^ (unsigned char) css.bytes[k]) * 16777619u;
+    }
+    char name[32];
+    snprintf(name, sizeof(name), "site.%08x.css", hash);
+    _siteStylesheet = strdup(name);
+    char *path = _outputPath("src/output", name);
+    boolean written = true;
+    if (access(path, F_OK) != 0) {
+        const int descriptor = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (descriptor < 0) {
+            logError(_logger, "The stylesheet \"%s\" could not be opened: %s.", path, strerror(errno));
+            written = false;
+        }
+        else {
+            css.descriptor = descriptor;
+            flushOutputBuffer(&css);
+            written = !css.failed;
+            if (!written) {
+                logError(_logger, "The stylesheet \"%s\" could not be written completely.", path);
+            }
+            close(descriptor);
+            if (!written) {
+                unlink(path);
+            }
+        }
+    }
+    logDebugging(_logger, "The site shares %u rules, in \"%s\".", shared, name);
+    free(path);
+    css.descriptor = -1;
+    closeOutputBuffer(&css);
+    return written;
+}
+
+static Chunk * _newChunk(void) {
+    Chunk *chunk = calloc(1, sizeof(Chunk));
+    openOutputBuffer(&chunk->buffer, -1, 0);
+    return chunk;
+}
+
+static Segment * _newSegment(StatementList *first, const size_t count, const unsigned int indent) {
+    Segment *segment = calloc(1, sizeof(Segment));
+    segment->first = first;
+    segment->count = count;
+    segment->indent = indent;
+    segment->depth = nestingDepth();
+    segment->chunks = _newChunk();
+    segment->last = segment->chunks;
+    return segment;
+}
+
+/**
+ * Generates the statements of a segment, on a thread of the pool.
+ */
+static void _runSegment(void *argument) {
+    Segment *segment = argument;
+    _segment = segment;
+    _target = &segment->last->buffer;
+    resumeNesting(segment->depth);
+    StatementList *it = segment->first;
+    for (size_t k = 0; k < segment->count; ++k, it = it->next) {
+        _generateStatement(segment->indent, it->statement);
+    }
+    _segment = NULL;
+    _target = &_outputBuffer;
+    settleThreadResources();
+    __atomic_add_fetch(&_threadSavedBytes, _savedBytes, __ATOMIC_RELAXED);
+    _savedBytes = 0;
+    pthread_mutex_lock(&_segmentLock);
+    segment->done = true;
+    pthread_cond_broadcast(&_segmentDone);
+    pthread_mutex_unlock(&_segmentLock);
+}
+
+/**
+ * Spawns a task for a run of statements: the chunk being written ends, the
+ * segment of the task goes after it, and a new chunk starts.
+ */
+static void _spawn(StatementList *first, const size_t count, const unsigned int indent) {
+    Segment *child = _newSegment(first, count, indent);
+    Chunk *chunk = _newChunk();
+    _segment->last->segment = child;
+    _segment->last->next = chunk;
+    _segment->last = chunk;
+    _target = &chunk->buffer;
+    submitTask(_pool, _runSegment, child);
+}
+
+/**
+ * Splits a list of statements in runs of about "_taskWeight" nodes, and
+ * returns how many there are (spawning a task per run, if asked to).
+ */
+static size_t _runs(StatementList *list, const unsigned int indent, const boolean spawn) {
+    size_t runs = 0;
+    size_t count = 0;
+    size_t weight = 0;
+    StatementList *first = NULL;
+    for (StatementList *it = list; it; it = it->next) {
+        const size_t w = it->statement ? it->statement->weight : 0;
+        if (count > 0 && weight + w > _taskWeight) {
+            if (spawn) {
+                _spawn(first, count, indent);
+            }
+            ++runs;
+            count = 0;
+            weight = 0;
+        }
+        if (count == 0) {
+            first = it;
+        }
+        ++count;
+        weight += w;
+    }
+    if (count > 0) {
+        if (spawn) {
+            _spawn(first, count, indent);
+        }
+        ++runs;
+    }
+    return runs;
+}
+
+/**
+ * While a task generates a list heavier than a task (and that makes more
+ * than one run), it spawns a task per run instead, and returns true. A list
+ * inside a capture or with bound parameters is always generated by the
+ * thread that finds it.
+ */
+static boolean _split(StatementList *list, const unsigned int indent, const size_t weight) {
+    if (!_segment || _capture || _bindings.values || weight <= _taskWeight || _runs(list, indent, false) < 2) {
+        return false;
+    }
+    _runs(list, indent, true);
+    return true;
+}
+
+static void _waitForSegment(Segment *segment) {
+    pthread_mutex_lock(&_segmentLock);
+    while (!segment->done) {
+        pthread_cond_wait(&_segmentDone, &_segmentLock);
+    }
+    pthread_mutex_unlock(&_segmentLock);
+}
+
+/**
+ * Writes out the segments in source order, each one as soon as it's done,
+ * and releases them. Segments nest as deep as the tasks that spawned them,
+ * so they're walked with an explicit stack of the chunks left to write.
+ */
+static void _writeSegments(Segment *root) {
+    size_t count = 0;
+    size_t capacity = 16;
+    Chunk **pending = malloc(capacity * sizeof(Chunk *));
+    Chunk *chunk = root->chunks;
+    free(root);
+    for (;;) {
+        if (!chunk) {
+            if (count == 0) {
+                break;
+            }
+            chunk = pending[--count];
+            if (count == 0 && _flushPolicy == FLUSH_STATEMENTS) {
+                flushOutputBuffer(&_outputBuffer);
+            }
+            continue;
+        }
+        if (chunk->buffer.length > 0) {
+            appendToOutputBuffer(&_outputBuffer, chunk->buffer.bytes, chunk->buffer.length);
+        }
+        closeOutputBuffer(&chunk->buffer);
+        Segment *segment = chunk->segment;
+        Chunk *next = chunk->next;
+        free(chunk);
+        chunk = next;
+        if (segment) {
+            if (count == capacity) {
+                capacity *= 2;
+                pending = realloc(pending, capacity * sizeof(Chunk *));
+            }
+            pending[count++] = next;
+            _waitForSegment(segment);
+            chunk = segment->chunks;
+            free(segment);
+        }
+    }
+    free(pending);
+}
+
+static void _startGeneratorThread(void) {
+    _expansionCache = createExpansionCache(_cacheBytes / _threads);
+}
+
+static void _stopGeneratorThread(void) {
+    const ExpansionCacheStatistics statistics = expansionCacheStatistics(_expansionCache);
+    pthread_mutex_lock(&_segmentLock);
+    _threadCacheStatistics.hits += statistics.hits;
+    _threadCacheStatistics.misses += statistics.misses;
+    _threadCacheStatistics.evictions += statistics.evictions;
+    _threadCacheStatistics.peakBytes += statistics.peakBytes;
+    pthread_mutex_unlock(&_segmentLock);
+    destroyExpansionCache(_expansionCache);
+    _expansionCache = NULL;
+    _freeWorkStack();
+}
+
+/**
+ * Generates the program on a pool of threads: the main thread only spawns
+ * the tasks of the top-level statements, and writes out their segments.
+ */
+static void _generateInParallel(Program *program) {
+    _pool = createThreadPool(_threads, _startGeneratorThread, _stopGeneratorThread);
+    Segment *root = _newSegment(NULL, 0, 1);
+    _segment = root;
+    _target = &root->last->buffer;
+    _runs(program->statements, 1, true);
+    _segment = NULL;
+    _target = &_outputBuffer;
+    _writeSegments(root);
+    const ThreadPoolStatistics statistics = threadPoolStatistics(_pool);
+    destroyThreadPool(_pool);
+    _pool = NULL;
+    _savedBytes += _threadSavedBytes;
+    logDebugging(_logger, "Parallel generation: %zu tasks on %u threads (%zu stolen).",
+        statistics.tasks, _threads, statistics.stolen);
+}
+
+/**
+ * Generates the output of the program.
+ */
+static void _generateProgram(Program *program) {
+    if (_threads > 1 && _flushPolicy != FLUSH_LINES) {
+        if (_weigh(program)) {
+            _generateInParallel(program);
+            return;
+        }
+        logDebugging(_logger, "The program is generated on a single thread (it has deferred or nested define bodies).");
+    }
+    if (_bytecode) {
+        const size_t base = _workCount;
+        _push(WORK_CODE, 1)->next = _compile(program->statements, NULL, PROGRAM_CODE)->instructions;
+        _run(base);
+        return;
+    }
+    for (StatementList *it = program->statements; it; it = it->next) {
+        if(it->statement){
+        	_generateStatement(1, it->statement);
+            if (_flushPolicy == FLUSH_STATEMENTS) {
+                flushOutputBuffer(&_outputBuffer);
+            }
+        }
+    }
+}
+
+/**
+ * Creates the prologue of the generated output, a Latex document that renders
+ * a tree thanks to the Forest package.
+ *
+ * @see https://ctan.dcc.uchile.cl/graphics/pgf/contrib/forest/forest-doc.pdf
+ */
+static void _generatePrologue(void) {
+    _beginNode("document");
+    if (_minify) {
+        _savedBytes += _fragments[PROLOGUE].length - _fragments[MINIFIED_PROLOGUE].length;
+    }
+    _savedBytes -= _styleBlock.length;
+    _beginLine(0);
+    _emitPrologue();
+    _endLine();
+}
+
+/**
+ * Writes the prologue, with the style block in its head if styles are
+ * extracted.
+ */
+static void _emitPrologue(void) {
+    if (!_extractStyles) {
+        _emitFragment(_minify ? MINIFIED_PROLOGUE : PROLOGUE);
+        return;
+    }
+    _emitFragment(_minify ? MINIFIED_PROLOGUE_HEAD : PROLOGUE_HEAD);
+    _emitSource(_styleBlock.bytes, _styleBlock.length);
+    _emitFragment(_minify ? MINIFIED_PROLOGUE_BODY : PROLOGUE_BODY);
+}
+
+static void _emit(const char * bytes, const size_t length) {
+    appendToOutputBuffer(_target, bytes, length);
+}
+
+/**
+ * Writes bytes of the program, which live until the output is closed. They
+ * are released as soon as they're generated while streaming, though.
+ */
+static void _emitSource(const char * bytes, const size_t length) {
+    if (_zeroCopy && !_streaming) {
+        appendBorrowedToOutputBuffer(_target, bytes, length);
+    }
+    else {
+        _emit(bytes, length);
+    }
+}
+
+/**
+ * Writes text, replacing the characters that HTML would take for markup in
+ * the context with their entities. The spans between them are written as
+ * they are, in one go.
+ */
+static void _emitEscaped(const char * bytes, const size_t length, const HtmlContext context, const boolean source) {
+    size_t k = 0;
+    for (;;) {
+        const size_t span = findHtmlEscape(bytes + k, length - k, context);
+        if (source) {
+            _emitSource(bytes + k, span);
+        }
+        else {
+            _emit(bytes + k, span);
+        }
+        k += span;
+        if (k == length) {
+            return;
+        }
+        const char * entity = htmlEntity(bytes[k]);
+        appendBorrowedToOutputBuffer(_target, entity, strlen(entity));
+        ++k;
+    }
+}
+
+/**
+ * Writes a string of the program, which is only scanned if it wasn't found
+ * clean when it was parsed.
+ */
+static void _emitLiteral(const char * string, const HtmlContext context, const boolean clean) {
+    if (clean) {
+        _emitSource(string, strlen(string));
+    }
+    else {
+        _emitEscaped(string, strlen(string), context, true);
+    }
+}
+
+static void _emitFragment(const FragmentType type) {
+    appendBorrowedToOutputBuffer(_target, _fragments[type].text, _fragments[type].length);
+}
+
+/**
+ * Starts a line with its indentation, sliced out of a static buffer.
+ */
+static void _beginLine(const unsigned int indentationLevel) {
+    _lineStart = _target->flushedBytes + _target->length;
+    size_t length = (size_t) indentationLevel * _indentationSize;
+    if (_minify) {
+        _savedBytes += length;
+        ++_minifiedLines;
+        return;
+    }
+    while (length > 0) {
+        const size_t slice = length < sizeof(_spaces) - 1 ? length : sizeof(_spaces) - 1;
+        appendBorrowedToOutputBuffer(_target, _spaces, slice);
+        length -= slice;
+    }
+}
+
+/**
+ * Ends a line, and charges its bytes: to the output (which is only written
+ * out in blocks, unless the flush policy asks for every line), or to the
+ * fragment being captured.
+ */
+static void _endLine(void) {
+    if (_minify) {
+        _savedBytes += _fragments[NEWLINE_FRAGMENT].length;
+    }
+    else {
+        _emitFragment(NEWLINE_FRAGMENT);
+    }
+    if (_capture) {
+        checkFragmentBytes(_target->length);
+        return;
+    }
+    chargeOutputBytes(_target->flushedBytes + _target->length - _lineStart);
+    if (_flushPolicy == FLUSH_LINES) {
+        flushOutputBuffer(_target);
+    }
+}
+
+/**
+ * Outputs a line made of a single fragment.
+ */
+static void _emitLine(const unsigned int indentationLevel, const FragmentType type) {
+    _beginLine(indentationLevel);
+    _emitFragment(type);
+    _endLine();
+}
+
+/**
+ * Writes a key or a value of an inline CSS. The minified output collapses
+ * every run of whitespace into a single space, and drops it at both ends and
+ * around commas (quoted strings are left as they are).
+ */
+static void _emitCss(const char * css, const size_t length) {
+    size_t k = 0;
+    while (_minify && k < length && !isspace((unsigned char) css[k])) {
+        ++k;
+    }
+    if (!_minify || k == length) {
+        _emitSource(css, length);
+        return;
+    }
+    _emitSource(css, k);
+    boolean pendingSpace = false;
+    char quote = '\0';
+    char last = k == 0 ? '\0' : css[k - 1];
+    for (; k < length; ++k) {
+        const char c = css[k];
+        if (quote == '\0' && isspace((unsigned char) c)) {
+            pendingSpace = true;
+            ++_savedBytes;
+            continue;
+        }
+        if (pendingSpace && last != '\0' && last != ',' && c != ',') {
+            _emitFragment(SPACE);
+            --_savedBytes;
+        }
+        pendingSpace = false;
+        if (c == '"' || c == '\'') {
+            quote = quote == '\0' ? c : (quote == c ? '\0' : quote);
+        }
+        _emit(&c, 1);
+        last = c;
+    }
+}
+
+/**
+ * Writes the properties of a style (e.g. "color:red;margin:0;").
+ */
+static void _emitProperties(ParameterList * style) {
+    for (Parameter *p = style ? style->head : NULL; p; p = p->next) {
+        _emitCss(p->key, p->keyLength);
+        _emitFragment(PROPERTY_VALUE);
+        _emitCss(p->value, p->valueLength);
+        _emitFragment(PROPERTY_END);
+    }
+}
+
+/**
+ * The rule that a style was extracted into, if styles are extracted and it
+ * was (a row without a style has the rule of empty rows).
+ */
+static const StyleRule * _ruleOf(ParameterList * style, const boolean row) {
+    if (!_extractStyles) {
+        return NULL;
+    }
+    return style ? style->rule : (row ? _emptyRowRule : NULL);
+}
+
+/**
+ * Writes the class of a rule, and charges the bytes it saves against the
+ * inline style it replaces (e.g. ' style="color:red;"'), which would have
+ * taken the given fragments besides the declarations.
+ */
+static void _emitClass(const StyleRule * rule, const size_t inlineFragments, const size_t classFragments) {
+    appendBorrowedToOutputBuffer(_target, rule->name, rule->nameLength);
+    _savedBytes += inlineFragments + rule->inlineLength;
+    _savedBytes -= classFragments + rule->nameLength;
+}
+
+/**
+ * Writes the opening fragment of a card or a column, with the class of its
+ * style added to its own (e.g. '<div class="card s1"'). Returns false if it's
+ * not one, or if its style has no class.
+ */
+static boolean _emitMergedClass(const FragmentType open, ParameterList * style) {
+    const StyleRule * rule = open == CARD_OPEN || open == COLUMN_OPEN ? _ruleOf(style, false) : NULL;
+    if (!rule) {
+        return false;
+    }
+    const FragmentType classOpen = open == CARD_OPEN ? CARD_CLASS_OPEN : COLUMN_CLASS_OPEN;
+    _emitFragment(classOpen);
+    _emitFragment(SPACE);
+    _emitClass(rule, _fragments[open].length + _fragments[STYLE_OPEN].length,
+        _fragments[classOpen].length + _fragments[SPACE].length);
+    _emitFragment(QUOTE);
+    return true;
+}
+
+/**
+ * Writes the opening tag of a row, whose style starts with "display:flex"
+ * (or its class, added to its own).
+ */
+static void _emitRowOpeningTag(ParameterList * style) {
+    const StyleRule * rule = _ruleOf(style, true);
+    if (!rule) {
+        _emitFragment(ROW_OPEN);
+        _emitProperties(style);
+        _emitFragment(STYLE_END);
+        return;
+    }
+    _emitFragment(ROW_CLASS_OPEN);
+    _emitFragment(SPACE);
+    _emitClass(rule, _fragments[ROW_OPEN].length, _fragments[ROW_CLASS_OPEN].length + _fragments[SPACE].length);
+    _emitFragment(STYLE_END);
+}
+
+/**
+ * Writes the style attribute of a tag, or the class of its style if it was
+ * extracted. The minified output leaves it out if it's empty.
+ */
+static void _emitStyle(ParameterList * style) {
+    const StyleRule * rule = _ruleOf(style, false);
+    if (rule) {
+        _emitFragment(CLASS_OPEN);
+        _emitClass(rule, _fragments[STYLE_OPEN].length, _fragments[CLASS_OPEN].length);
+        _emitFragment(QUOTE);
+        return;
+    }
+    if (_minify && (!style || !style->head)) {
+        _savedBytes += _fragments[STYLE_OPEN].length + _fragments[QUOTE].length;
+        return;
+    }
+    _emitFragment(STYLE_OPEN);
+    _emitProperties(style);
+    _emitFragment(QUOTE);
+}
+
+/**
+ * Writes the size of an image, if it's a local file whose size is known, and
+ * how it loads: the first one written is fetched before the rest, and the
+ * ones after the eager ones load once they're about to be shown.
+ */
+static void _emitImageAttributes(Image * image) {
+    unsigned int width = 0;
+    unsigned int height = 0;
+    if (_imageSizes && imageSize(_imageSizes, image->src, &width, &height)) {
+        char digits[16];
+        _emitFragment(IMG_WIDTH);
+        _emit(digits, (size_t) snprintf(digits, sizeof(digits), "%u", width));
+        _emitFragment(IMG_HEIGHT);
+        _emit(digits, (size_t) snprintf(digits, sizeof(digits), "%u", height));
+        _emitFragment(QUOTE);
+    }
+    if (!_imageHints) {
+        return;
+    }
+    const size_t written = _writtenImages++;
+    if (written == 0 && _eagerImages > 0) {
+        _emitFragment(IMG_PRIORITY);
+    }
+    if (written >= _eagerImages) {
+        _emitFragment(IMG_LAZY);
+    }
+}
+
+/**
+ * Writes the attributes of a tag, separated by spaces (e.g. 'a="b" c="d"').
+ */
+static void _emitAttributes(ParameterList * attributes) {
+    for (Parameter *p = attributes ? attributes->head : NULL; p; p = p->next) {
+        if (p != attributes->head) {
+            _emitFragment(SPACE);
+        }
+        _emitSource(p->key, p->keyLength);
+        _emitFragment(ATTRIBUTE_VALUE);
+        if (p->clean) {
+            _emitSource(p->value, p->valueLength);
+        }
+        else {
+            _emitEscaped(p->value, p->valueLength, ATTRIBUTE_CONTEXT, true);
+        }
+        _emitFragment(QUOTE);
+    }
+}
+
+/**
+ * Outputs the line that opens a tag with a style (e.g. '<ul style="...">').
+ */
+static void _emitOpening(const unsigned int indentationLevel, const FragmentType open, ParameterList * style) {
+    _beginLine(indentationLevel);
+    _emitOpeningTag(open, style);
+    _endLine();
+}
+
+static void _emitOpeningTag(const FragmentType open, ParameterList * style) {
+    if (!_emitMergedClass(open, style)) {
+        _emitFragment(open);
+        _emitStyle(style);
+    }
+    _emitFragment(TAG_END);
+}
+
+/**
+ * Outputs the line that opens a tag with a style and attributes (e.g.
+ * '<nav style="..." href="...">'). The minified output leaves out the space
+ * before the attributes if there are none.
+ */
+static void _emitOpeningWithAttributes(const unsigned int indentationLevel, const FragmentType open, ParameterList * style, ParameterList * attributes) {
+    _beginLine(indentationLevel);
+    _emitOpeningTagWithAttributes(open, style, attributes);
+    _endLine();
+}
+
+static void _emitOpeningTagWithAttributes(const FragmentType open, ParameterList * style, ParameterList * attributes) {
+    _emitFragment(open);
+    _emitStyle(style);
+    if (_minify && (!attributes || !attributes->head)) {
+        _savedBytes += _fragments[SPACE].length;
+    }
+    else {
+        _emitFragment(SPACE);
+        _emitAttributes(attributes);
+    }
+    _emitFragment(TAG_END);
+}
+
+/**
+ * Outputs an already rendered fragment, as is. A stable one lives as long as
+ * the program does (unlike the ones in the expansion cache, which can be
+ * evicted).
+ */
+static void _outputBytes(const char * bytes, const size_t length, const boolean stable) {
+    if (_capture) {
+        if (checkFragmentBytes(_target->length + length)) {
+            _emit(bytes, length);
+        }
+        return;
+    }
+    if (chargeOutputBytes(length)) {
+        if (stable) {
+            _emitSource(bytes, length);
+        }
+        else {
+            _emit(bytes, length);
+        }
+        if (_flushPolicy == FLUSH_LINES) {
+            flushOutputBuffer(_target);
+        }
+    }
+}
+
+
+
+/** PUBLIC FUNCTIONS */
+
+boolean streamStatement(CompilerState * compilerState, void * statement, const boolean release) {
+	if (!_streaming) {
+		return false;
+	}
+	if (!_streamed) {
+		logDebugging(_logger, "Streaming the output...");
+		_compilerState = compilerState;
+		_symbolTable = compilerState->symbolTable;
+		_generatePrologue();
+		_streamed = true;
+	}
+	StatementList single = { .statement = statement, .next = NULL };
+	if (release) {
+		// A define is generated on every later "@use", after the arguments of
+		// other defines may have changed, so its body is never folded.
+		_fold(&single);
+	}
+	_generateStatement(1, single.statement);
+	if (_flushPolicy == FLUSH_STATEMENTS) {
+		flushOutputBuffer(&_outputBuffer);
+	}
+	if (!release) {
+		return false;
+	}
+	releaseStatement(single.statement);
+	return true;
+}
+
+void generate(CompilerState * compilerState) {
+	logDebugging(_logger, "Generating final output...");
+	_compilerState = compilerState;
+	_symbolTable = compilerState->symbolTable;
+	Program *program = compilerState->abstractSyntaxtTree;
+	if (!_streamed) {
+		_fold(program->statements);
+		if (_extractStyles) {
+			_styleSheet = createStyleSheet(_siteSheet ? styleRules(_siteSheet) : 0);
+			_collectStyles(program->statements, true);
+			_renderStyleBlock();
+		}
+		_generatePrologue();
+		_generateProgram(program);
+	}
+	_generateEpilogue();
+	flushOutputBuffer(&_outputBuffer);
+	_generated = true;
+	if (_failed) {
+		compilerState->succeed = false;
+	}
+	if (_extractStyles) {
+		// What's saved can be less than nothing (a style block that takes more
+		// than the styles it replaced), but the sum wraps around to the size of
+		// the plain output anyway.
+		const size_t bytes = _outputBuffer.flushedBytes;
+		const size_t plain = bytes + _savedBytes;
+		const size_t difference = plain < bytes ? bytes - plain : plain - bytes;
+		logInformation(_logger, "Extracted styles: %u classes. Output: %zu bytes, %zu %s than the %zu bytes %swith inline styles (%.1f%%).",
+			styleRules(_styleSheet), bytes, difference, plain < bytes ? "more" : "less", plain,
+			_minify ? "pretty-printed " : "", plain == 0 ? 0.0 : 100.0 * difference / plain);
+	}
+	else if (_minify) {
+		const size_t bytes = _outputBuffer.flushedBytes;
+		const size_t pretty = bytes + _savedBytes;
+		logInformation(_logger, "Minified output: %zu bytes, %zu less than the pretty-printed %zu bytes (%.1f%%).",
+			bytes, _savedBytes, pretty, pretty == 0 ? 0.0 : 100.0 * _savedBytes / pretty);
+	}
+	logDebugging(_logger, "Generation is done.");
+}
+
+void collectSiteStyles(CompilerState * compilerState, StyleSheet * site) {
+	Program * program = compilerState->abstractSyntaxtTree;
+	StyleSheet * styleSheet = _styleSheet;
+	StyleSheet * siteSheet = _siteSheet;
+	_styleSheet = site;
+	_siteSheet = NULL;
+	_collectStyles(program->statements, true);
+	nextStyleSheetPage(site);
+	_styleSheet = styleSheet;
+	_siteSheet = siteSheet;
+	_emptyRowRule = NULL;
+}
+
+boolean useSiteStyles(StyleSheet * site) {
+	if (_streaming) {
+		logWarning(_logger, "Streaming generation is disabled, because the styles of every page of a site are needed before any page is written.");
+		_streaming = false;
+	}
+	_extractStyles = true;
+	_siteSheet = site;
+	return _writeSiteStylesheet();
+}
+
+void holdOutputs(void) {
+	_holding = true;
+}
+
+boolean releaseOutputs(const boolean replace) {
+	// The module is shut down between compilations.
+	const boolean initialized = _logger != NULL;
+	if (!initialized) {
+		_logger = createLogger("Generator");
+	}
+	_holding = false;
+	const boolean settled = _settleHeld(replace);
+	if (!initialized) {
+		destroyLogger(_logger);
+		_logger = NULL;
+	}
+	return settled;
+}
+
+Bytecode * compileDocument(Program * program) {
+	if (_streamed) {
+		return NULL;
+	}
+	return _compile(program->statements, NULL, DOCUMENT_CODE);
+}
+
+Bytecode * compileDefine(Define * define) {
+	if (!_resolveDefine(&define, define->name)) {
+		return NULL;
+	}
+	if (!define->code) {
+		define->code = _compile(define->body, define->parameters->head, BODY_CODE);
+	}
+	return define->code;
+}
+
+Bytecode * compileStaticHtml(StaticHtml * staticHtml) {
+	StatementList single = { .statement = staticHtml->original, .next = NULL };
+	return _compile(&single, NULL, BODY_CODE);
+}
+
+Define * resolveUse(Use * use) {
+	return _resolveDefine(&use->define, use->name);
+}
+
+const DefineRegistry * generatedDefines() {
+	return _defineRegistry;
+}
+
+unsigned int generatedIndentation() {
+	return _minify ? 0 : (unsigned int) _indentationSize;
 }
@@ -2,23 +2,29 @@
 #define GENERATOR_HEADER
 
 #include "../../frontend/syntactic-analysis/AbstractSyntaxTree.h"
+#include "../../frontend/syntactic-analysis/SyntacticAnalyzer.h"
 #include "../../shared/CompilerState.h"
+#include "Bytecode.h"
+#include "ConstantFolding.h"
+#include "DefineRegistry.h"
+#include "ExpansionCache.h"
+#include "ImageSize.h"
+#include "JsonRecordStream.h"
+#include "OutputBuffer.h"
+#include "OutputSink.h"
+#include "StyleSheet.h"
+#include "../../shared/HtmlEscape.h"
 #include "../../shared/Logger.h"
+#include "../../shared/ResourceGovernor.h"
 #include "../../shared/String.h"
-#include <stdarg.h>
+#include "../../shared/ThreadPool.h"
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
 #include <stdio.h>
 #include <sys/stat.h>
 
-extern FILE * _outputFile;
-
-typedef struct DefineStatementList DefineStatementList;
-
-struct DefineStatementList {
-    Define *define;
-    DefineStatementList *next;
-};
-
-
 /** Initialize module's internal state. */
 void initializeGeneratorModule();
 
@@ -26,8 +32,81 @@ void initializeGeneratorModule();
 void shutdownGeneratorModule();
 
 /**
- * Generates the final output using the current compiler state.
+ * Generates a top-level statement as soon as it's parsed, if streaming is
+ * enabled (see "STREAMING_GENERATION"), and releases it if told so. Returns
+ * whether it did release it. Its signature is the one of the
+ * "streamStatement" of the compiler state.
+ */
+boolean streamStatement(CompilerState * compilerState, void * statement, const boolean release);
+
+/**
+ * Generates the final output using the current compiler state (only what
+ * hasn't been streamed yet).
  */
 void generate(CompilerState * compilerState);
 
+/**
+ * Adds the styles of a page of a site to the style sheet of the site, and
+ * counts them as the ones of that page (see "SITE_PAGES"). It doesn't need
+ * the module to be initialized.
+ */
+void collectSiteStyles(CompilerState * compilerState, StyleSheet * site);
+
+/**
+ * Generates the next page with the styles of the site, once they've all been
+ * collected: the rules that more than one page shares are linked from the
+ * head (in a stylesheet that's written if it's missing), and the rest stay in
+ * its style block. Returns false if the stylesheet couldn't be written.
+ */
+boolean useSiteStyles(StyleSheet * site);
+
+/**
+ * Writes the outputs of the following compilations into temporary files next
+ * to them, which are held until "releaseOutputs" (e.g. so that no page of a
+ * site is replaced unless every one of them is generated). It doesn't need
+ * the module to be initialized.
+ */
+void holdOutputs(void);
+
+/**
+ * Stops holding outputs, and renames the held ones over their files (the
+ * ones that changed), or removes them if told not to. Returns false if one
+ * of them couldn't be replaced.
+ */
+boolean releaseOutputs(const boolean replace);
+
+/**
+ * Compiles the whole document (the program, with its prologue and epilogue)
+ * into bytecode, once it has been generated. Returns NULL if the program was
+ * streamed, since its statements are gone. Like every code compiled by the
+ * generator, it's kept until the module is shut down.
+ */
+Bytecode * compileDocument(Program * program);
+
+/**
+ * The bytecode of the body of a define (compiled on the first call), or NULL
+ * if its deferred body can't be parsed.
+ */
+Bytecode * compileDefine(Define * define);
+
+/**
+ * Compiles the statement that a static fragment was folded from.
+ */
+Bytecode * compileStaticHtml(StaticHtml * staticHtml);
+
+/**
+ * The define that a "@use" expands, or NULL if there's none.
+ */
+Define * resolveUse(Use * use);
+
+/**
+ * The defines registered while the program was generated.
+ */
+const DefineRegistry * generatedDefines();
+
+/**
+ * The spaces of each indentation level of the output (none if it's minified).
+ */
+unsigned int generatedIndentation();
+
 #endif
@@ -0,0 +1,278 @@
+#include "GzipStream.h"
+
+/* MODULE INTERNAL STATE */
+
+// The most that deflate looks back, and so the dictionary of a block.
+#define WINDOW_SIZE 32768
+
+// A header without a name nor a time (so that the same output compresses
+// into the same file), from a Unix system.
+static const unsigned char _header[] = { 0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 3 };
+
+/**
+ * A block of the input, deflated on its own, and then written in the order
+ * it came.
+ */
+typedef struct GzipBlock {
+	char * input;
+	size_t inputLength;
+	// The end of the input before it.
+	char * dictionary;
+	size_t dictionaryLength;
+	unsigned char * output;
+	size_t outputLength;
+	uLong crc;
+	int level;
+	// Whether it ends the deflate stream.
+	boolean last;
+	// Guarded by the lock of the stream.
+	boolean done;
+	boolean failed;
+	GzipStream * stream;
+	struct GzipBlock * next;
+} GzipBlock;
+
+struct GzipStream {
+	int descriptor;
+	int level;
+	size_t blockSize;
+	// NULL if blocks are deflated on the calling thread.
+	ThreadPool * pool;
+	pthread_mutex_t lock;
+	pthread_cond_t done;
+	// The blocks not written yet, in order.
+	GzipBlock * first;
+	GzipBlock * last;
+	size_t pending;
+	size_t maximumPending;
+	// The block that's coming, and the end of the input so far.
+	char * input;
+	size_t length;
+	char window[WINDOW_SIZE];
+	size_t windowLength;
+	// The checksum and the length (modulo 2^32) of what's been written.
+	uLong crc;
+	uLong totalLength;
+	size_t compressedBytes;
+	boolean headerWritten;
+	// Whether nothing else is written (the file was ended, or emptied).
+	boolean ended;
+	boolean failed;
+};
+
+/* PRIVATE FUNCTIONS */
+
+static void _write(GzipStream * stream, const void * bytes, const size_t length) {
+	size_t offset = 0;
+	while (offset < length && !stream->failed) {
+		const ssize_t written = write(stream->descriptor, (const char *) bytes + offset, length - offset);
+		if (written < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			stream->failed = true;
+			break;
+		}
+		offset += written;
+	}
+	stream->compressedBytes += offset;
+}
+
+/**
+ * Deflates a block into raw deflate data that ends byte-aligned (or that
+ * ends the stream, if it's the last one), and computes its checksum.
+ */
+static void _deflate(void * argument) {
+	GzipBlock * block = argument;
+	block->crc = crc32(crc32(0L, Z_NULL, 0), (const Bytef *) block->input, (uInt) block->inputLength);
+	z_stream z;
+	memset(&z, 0, sizeof(z));
+	boolean failed = deflateInit2(&z, block->level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK;
+	if (!failed && block->dictionaryLength > 0) {
+		failed = deflateSetDictionary(&z, (const Bytef *) block->dictionary, (uInt) block->dictionaryLength) != Z_OK;
+	}
+	if (!failed) {
+		// Enough for the whole block and the end of it, almost always.
+		size_t capacity = deflateBound(&z, (uLong) block->inputLength) + 16;
+		block->output = malloc(capacity);
+		z.next_in = (Bytef *) block->input;
+		z.avail_in = (uInt) block->inputLength;
+		const int flush = block->last ? Z_FINISH : Z_SYNC_FLUSH;
+		for (;;) {
+			z.next_out = block->output + block->outputLength;
+			z.avail_out = (uInt) (capacity - block->outputLength);
+			const int result = deflate(&z, flush);
+			block->outputLength = capacity - z.avail_out;
+			if (result == Z_STREAM_ERROR) {
+				failed = true;
+				break;
+			}
+			if (block->last ? result == Z_STREAM_END : z.avail_out > 0) {
+				break;
+			}
+			capacity *= 2;
+			block->output = realloc(block->output, capacity);
+		}
+	}
+	deflateEnd(&z);
+	GzipStream * stream = block->stream;
+	pthread_mutex_lock(&stream->lock);
+	block->failed = failed;
+	block->done = true;
+	pthread_cond_broadcast(&stream->done);
+	pthread_mutex_unlock(&stream->lock);
+}
+
+/**
+ * Writes the blocks that are done in order, waiting for them until no more
+ * than the given amount of them are pending.
+ */
+static void _writeBlocks(GzipStream * stream, const size_t pending) {
+	while (stream->first != NULL) {
+		GzipBlock * block = stream->first;
+		pthread_mutex_lock(&stream->lock);
+		while (!block->done && stream->pending > pending) {
+			pthread_cond_wait(&stream->done, &stream->lock);
+		}
+		const boolean done = block->done;
+		pthread_mutex_unlock(&stream->lock);
+		if (!done) {
+			return;
+		}
+		if (!stream->headerWritten) {
+			_write(stream, _header, sizeof(_header));
+			stream->headerWritten = true;
+		}
+		stream->failed = stream->failed || block->failed;
+		_write(stream, block->output, block->outputLength);
+		stream->crc = crc32_combine(stream->crc, block->crc, (z_off_t) block->inputLength);
+		stream->totalLength += (uLong) block->inputLength;
+		stream->first = block->next;
+		if (stream->first == NULL) {
+			stream->last = NULL;
+		}
+		--stream->pending;
+		free(block->input);
+		free(block->dictionary);
+		free(block->output);
+		free(block);
+	}
+}
+
+/**
+ * Hands the block that's coming to the threads (or deflates it right away),
+ * and keeps its end as the dictionary of the next one.
+ */
+static void _submit(GzipStream * stream, const boolean last) {
+	GzipBlock * block = calloc(1, sizeof(GzipBlock));
+	block->input = stream->input;
+	block->inputLength = stream->length;
+	block->dictionaryLength = stream->windowLength;
+	block->dictionary = malloc(stream->windowLength + 1);
+	memcpy(block->dictionary, stream->window, stream->windowLength);
+	block->level = stream->level;
+	block->last = last;
+	block->stream = stream;
+	if (stream->length >= WINDOW_SIZE) {
+		memcpy(stream->window, stream->input + stream->length - WINDOW_SIZE, WINDOW_SIZE);
+		stream->windowLength = WINDOW_SIZE;
+	}
+	else {
+		const size_t kept = stream->windowLength + stream->length > WINDOW_SIZE ? WINDOW_SIZE - stream->length : stream->windowLength;
+		memmove(stream->window, stream->window + stream->windowLength - kept, kept);
+		memcpy(stream->window + kept, stream->input, stream->length);
+		stream->windowLength = kept + stream->length;
+	}
+	stream->input = malloc(stream->blockSize);
+	stream->length = 0;
+	if (stream->last == NULL) {
+		stream->first = block;
+	}
+	else {
+		stream->last->next = block;
+	}
+	stream->last = block;
+	++stream->pending;
+	if (stream->pool == NULL) {
+		_deflate(block);
+	}
+	else {
+		submitTask(stream->pool, _deflate, block);
+	}
+	_writeBlocks(stream, stream->maximumPending);
+}
+
+/* PUBLIC FUNCTIONS */
+
+GzipStream * createGzipStream(const int descriptor, const int level, const size_t blockSize, const unsigned int threads) {
+	GzipStream * stream = calloc(1, sizeof(GzipStream));
+	stream->descriptor = descriptor;
+	stream->level = level;
+	stream->blockSize = blockSize == 0 ? 1 : blockSize;
+	const unsigned int count = threads == 0 ? availableProcessors() : threads;
+	stream->pool = count > 1 ? createThreadPool(count, NULL, NULL) : NULL;
+	// Every thread has a block to deflate while another one is written.
+	stream->maximumPending = 2 * count;
+	pthread_mutex_init(&stream->lock, NULL);
+	pthread_cond_init(&stream->done, NULL);
+	stream->input = malloc(stream->blockSize);
+	stream->crc = crc32(0L, Z_NULL, 0);
+	return stream;
+}
+
+void writeGzipStream(GzipStream * stream, const char * bytes, const size_t length) {
+	size_t offset = 0;
+	while (offset < length && !stream->ended) {
+		const size_t count = length - offset < stream->blockSize - stream->length
+			? length - offset
+			: stream->blockSize - stream->length;
+		memcpy(stream->input + stream->length, bytes + offset, count);
+		stream->length += count;
+		offset += count;
+		if (stream->length == stream->blockSize) {
+			_submit(stream, false);
+		}
+	}
+}
+
+void discardGzipStream(GzipStream * stream) {
+	_writeBlocks(stream, 0);
+	stream->ended = true;
+	if (ftruncate(stream->descriptor, 0) != 0) {
+		stream->failed = true;
+	}
+}
+
+boolean finishGzipStream(GzipStream * stream) {
+	if (stream->ended) {
+		return !stream->failed;
+	}
+	_submit(stream, true);
+	_writeBlocks(stream, 0);
+	unsigned char trailer[8];
+	for (unsigned int k = 0; k < 4; ++k) {
+		trailer[k] = (unsigned char) (stream->crc >> (8 * k));
+		trailer[4 + k] = (unsigned char) (stream->totalLength >> (8 * k));
+	}
+	_write(stream, trailer, sizeof(trailer));
+	stream->ended = true;
+	return !stream->failed;
+}
+
+size_t gzipStreamCompressedBytes(const GzipStream * stream) {
+	return stream->compressedBytes;
+}
+
+void destroyGzipStream(GzipStream * stream) {
+	if (stream == NULL) {
+		return;
+	}
+	_writeBlocks(stream, 0);
+	if (stream->pool != NULL) {
+		destroyThreadPool(stream->pool);
+	}
+	pthread_mutex_destroy(&stream->lock);
+	pthread_cond_destroy(&stream->done);
+	free(stream->input);
+	free(stream);
+}
@@ -0,0 +1,59 @@
+#ifndef GZIP_STREAM_HEADER
+#define GZIP_STREAM_HEADER
+
+#include "../../shared/ThreadPool.h"
+#include "../../shared/Type.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <zlib.h>
+
+/**
+ * A gzip file written as its bytes come. They're cut into blocks that are
+ * deflated independently, on the threads of a pool if there's more than one
+ * (like "pigz" does): each block is primed with the last 32 KiB of the one
+ * before it, so it compresses almost as well as a single stream, and ends
+ * byte-aligned, so the blocks are written one after the other as they are.
+ * Their checksums are combined in order into the one of the whole file.
+ */
+typedef struct GzipStream GzipStream;
+
+/**
+ * Creates a stream that writes into the file descriptor, with a compression
+ * level from 0 to 9, in blocks of the given size (of uncompressed bytes), on
+ * the given amount of threads (0 means one per processor).
+ */
+GzipStream * createGzipStream(const int descriptor, const int level, const size_t blockSize, const unsigned int threads);
+
+/**
+ * Compresses the bytes, once a whole block of them has come.
+ */
+void writeGzipStream(GzipStream * stream, const char * bytes, const size_t length);
+
+/**
+ * Drops what the stream has compressed, and empties its file, e.g. if the
+ * compilation failed after some of it was streamed. Nothing else is written
+ * afterwards.
+ */
+void discardGzipStream(GzipStream * stream);
+
+/**
+ * Compresses what's left, and ends the file. Returns false if it couldn't be
+ * written completely.
+ */
+boolean finishGzipStream(GzipStream * stream);
+
+/**
+ * The compressed bytes written so far.
+ */
+size_t gzipStreamCompressedBytes(const GzipStream * stream);
+
+/**
+ * Releases the stream (but doesn't close its file).
+ */
+void destroyGzipStream(GzipStream * stream);
+
+#endif
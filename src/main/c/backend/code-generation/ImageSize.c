@@ -0,0 +1,289 @@
+#include "ImageSize.h"
+
+/* MODULE INTERNAL STATE */
+
+// Always a power of 2.
+static const size_t _buckets = 256;
+
+/**
+ * The size of an image, and the version of its file it was read from.
+ */
+typedef struct ImageEntry {
+	char * path;
+	struct timespec modified;
+	off_t length;
+	boolean known;
+	unsigned int width;
+	unsigned int height;
+	struct ImageEntry * next;
+} ImageEntry;
+
+struct ImageSizeCache {
+	char * root;
+	ImageEntry ** entries;
+	pthread_mutex_t lock;
+	ImageSizeCacheStatistics statistics;
+};
+
+/* PRIVATE FUNCTIONS */
+
+static unsigned int _bigEndian(const unsigned char * bytes, const size_t count) {
+	unsigned int value = 0;
+	for (size_t k = 0; k < count; ++k) {
+		value = (value << 8) | bytes[k];
+	}
+	return value;
+}
+
+static unsigned int _littleEndian(const unsigned char * bytes, const size_t count) {
+	unsigned int value = 0;
+	for (size_t k = count; k > 0; --k) {
+		value = (value << 8) | bytes[k - 1];
+	}
+	return value;
+}
+
+/**
+ * The path of the file of a "src" attribute (without its query nor its
+ * fragment), or NULL if it's not a local file (e.g. it has a scheme).
+ */
+static char * _localPath(const char * root, const char * src) {
+	const size_t length = strcspn(src, "?#");
+	if (length == 0 || strncmp(src, "//", 2) == 0) {
+		return NULL;
+	}
+	const size_t scheme = strcspn(src, ":/");
+	if (scheme < length && src[scheme] == ':') {
+		return NULL;
+	}
+	const char * relative = src[0] == '/' ? src + 1 : src;
+	const size_t relativeLength = length - (size_t) (relative - src);
+	const size_t rootLength = strlen(root);
+	char * path = malloc(rootLength + 1 + relativeLength + 1);
+	memcpy(path, root, rootLength);
+	path[rootLength] = '/';
+	memcpy(path + rootLength + 1, relative, relativeLength);
+	path[rootLength + 1 + relativeLength] = '\0';
+	return path;
+}
+
+/**
+ * Whether an Exif segment (after its "Exif\0\0" identifier) says that the
+ * image is turned a quarter, so its width and height are swapped when it's
+ * shown.
+ */
+static boolean _isTurned(const unsigned char * tiff, const size_t length) {
+	if (length < 8 || (memcmp(tiff, "II", 2) != 0 && memcmp(tiff, "MM", 2) != 0)) {
+		return false;
+	}
+	const boolean little = tiff[0] == 'I';
+	const size_t directory = little ? _littleEndian(tiff + 4, 4) : _bigEndian(tiff + 4, 4);
+	if (directory + 2 > length) {
+		return false;
+	}
+	const size_t count = little ? _littleEndian(tiff + directory, 2) : _bigEndian(tiff + directory, 2);
+	for (size_t k = 0; k < count; ++k) {
+		// Every entry is 12 bytes, and the segment may end before them.
+		if (directory + 2 + 12 * (k + 1) > length) {
+			return false;
+		}
+		const unsigned char * entry = tiff + directory + 2 + 12 * k;
+		if ((little ? _littleEndian(entry, 2) : _bigEndian(entry, 2)) == 0x0112) {
+			const unsigned int orientation = little ? _littleEndian(entry + 8, 2) : _bigEndian(entry + 8, 2);
+			return orientation >= 5 && orientation <= 8;
+		}
+	}
+	return false;
+}
+
+/**
+ * Walks the segments of a JPEG file up to its frame header, which has its
+ * size (and minds the orientation of an Exif segment before it).
+ */
+static boolean _readJpeg(FILE * file, unsigned int * width, unsigned int * height) {
+	boolean turned = false;
+	if (fseek(file, 2, SEEK_SET) != 0) {
+		return false;
+	}
+	for (;;) {
+		if (fgetc(file) != 0xFF) {
+			return false;
+		}
+		int marker = fgetc(file);
+		while (marker == 0xFF) {
+			marker = fgetc(file);
+		}
+		if (marker == EOF || marker == 0xD9 || marker == 0xDA) {
+			// The image ends, or its data starts, without a frame.
+			return false;
+		}
+		if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD8)) {
+			continue;
+		}
+		unsigned char bytes[2];
+		if (fread(bytes, 1, 2, file) != 2 || _bigEndian(bytes, 2) < 2) {
+			return false;
+		}
+		const size_t length = _bigEndian(bytes, 2) - 2;
+		if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC) {
+			unsigned char frame[5];
+			if (length < 5 || fread(frame, 1, 5, file) != 5) {
+				return false;
+			}
+			*height = _bigEndian(frame + 1, 2);
+			*width = _bigEndian(frame + 3, 2);
+			if (turned) {
+				const unsigned int side = *width;
+				*width = *height;
+				*height = side;
+			}
+			return *width > 0 && *height > 0;
+		}
+		if (marker == 0xE1 && length > 6) {
+			unsigned char * segment = malloc(length);
+			const boolean read = fread(segment, 1, length, file) == length;
+			if (read && memcmp(segment, "Exif\0\0", 6) == 0) {
+				turned = _isTurned(segment + 6, length - 6);
+			}
+			free(segment);
+			if (!read) {
+				return false;
+			}
+		}
+		else if (fseek(file, (long) length, SEEK_CUR) != 0) {
+			return false;
+		}
+	}
+}
+
+/**
+ * Reads the size of an image from the header of its file.
+ */
+static boolean _readSize(const char * path, unsigned int * width, unsigned int * height) {
+	FILE * file = fopen(path, "rb");
+	if (file == NULL) {
+		return false;
+	}
+	unsigned char head[30];
+	const size_t length = fread(head, 1, sizeof(head), file);
+	boolean known = false;
+	if (length >= 24 && memcmp(head, "\x89PNG\r\n\x1a\n", 8) == 0 && memcmp(head + 12, "IHDR", 4) == 0) {
+		*width = _bigEndian(head + 16, 4);
+		*height = _bigEndian(head + 20, 4);
+		known = true;
+	}
+	else if (length >= 10 && (memcmp(head, "GIF87a", 6) == 0 || memcmp(head, "GIF89a", 6) == 0)) {
+		*width = _littleEndian(head + 6, 2);
+		*height = _littleEndian(head + 8, 2);
+		known = true;
+	}
+	else if (length >= 30 && memcmp(head, "RIFF", 4) == 0 && memcmp(head + 8, "WEBP", 4) == 0) {
+		if (memcmp(head + 12, "VP8 ", 4) == 0 && memcmp(head + 23, "\x9d\x01\x2a", 3) == 0) {
+			*width = _littleEndian(head + 26, 2) & 0x3fff;
+			*height = _littleEndian(head + 28, 2) & 0x3fff;
+			known = true;
+		}
+		else if (memcmp(head + 12, "VP8L", 4) == 0 && head[20] == 0x2f) {
+			const unsigned int bits = _littleEndian(head + 21, 4);
+			*width = (bits & 0x3fff) + 1;
+			*height = ((bits >> 14) & 0x3fff) + 1;
+			known = true;
+		}
+		else if (memcmp(head + 12, "VP8X", 4) == 0) {
+			*width = _littleEndian(head + 24, 3) + 1;
+			*height = _littleEndian(head + 27, 3) + 1;
+			known = true;
+		}
+	}
+	else if (length >= 2 && head[0] == 0xFF && head[1] == 0xD8) {
+		known = _readJpeg(file, width, height);
+	}
+	fclose(file);
+	return known && *width > 0 && *height > 0;
+}
+
+static size_t _hash(const char * path) {
+	size_t hash = (size_t) 14695981039346656037ULL;
+	for (const char * c = path; *c != '\0'; ++c) {
+		hash = (hash ^ (unsigned char) *c) * (size_t) 1099511628211ULL;
+	}
+	return hash;
+}
+
+/* PUBLIC FUNCTIONS */
+
+ImageSizeCache * createImageSizeCache(const char * root) {
+	ImageSizeCache * cache = calloc(1, sizeof(ImageSizeCache));
+	cache->root = strdup(root);
+	cache->entries = calloc(_buckets, sizeof(ImageEntry *));
+	pthread_mutex_init(&cache->lock, NULL);
+	return cache;
+}
+
+boolean imageSize(ImageSizeCache * cache, const char * src, unsigned int * width, unsigned int * height) {
+	char * path = _localPath(cache->root, src);
+	struct stat st;
+	if (path == NULL || stat(path, &st) != 0 || !S_ISREG(st.st_mode)) {
+		free(path);
+		return false;
+	}
+	pthread_mutex_lock(&cache->lock);
+	ImageEntry ** bucket = &cache->entries[_hash(path) & (_buckets - 1)];
+	ImageEntry * entry = *bucket;
+	while (entry != NULL && strcmp(entry->path, path) != 0) {
+		entry = entry->next;
+	}
+	if (entry == NULL) {
+		entry = calloc(1, sizeof(ImageEntry));
+		entry->path = path;
+		entry->next = *bucket;
+		*bucket = entry;
+		path = NULL;
+	}
+	else if (entry->length == st.st_size && entry->modified.tv_sec == st.st_mtim.tv_sec
+		&& entry->modified.tv_nsec == st.st_mtim.tv_nsec) {
+		++cache->statistics.hits;
+		const boolean known = entry->known;
+		*width = entry->width;
+		*height = entry->height;
+		pthread_mutex_unlock(&cache->lock);
+		free(path);
+		return known;
+	}
+	++cache->statistics.misses;
+	entry->modified = st.st_mtim;
+	entry->length = st.st_size;
+	entry->known = _readSize(entry->path, &entry->width, &entry->height);
+	const boolean known = entry->known;
+	*width = entry->width;
+	*height = entry->height;
+	pthread_mutex_unlock(&cache->lock);
+	free(path);
+	return known;
+}
+
+ImageSizeCacheStatistics imageSizeCacheStatistics(ImageSizeCache * cache) {
+	pthread_mutex_lock(&cache->lock);
+	const ImageSizeCacheStatistics statistics = cache->statistics;
+	pthread_mutex_unlock(&cache->lock);
+	return statistics;
+}
+
+void destroyImageSizeCache(ImageSizeCache * cache) {
+	if (cache == NULL) {
+		return;
+	}
+	for (size_t k = 0; k < _buckets; ++k) {
+		ImageEntry * entry = cache->entries[k];
+		while (entry != NULL) {
+			ImageEntry * next = entry->next;
+			free(entry->path);
+			free(entry);
+			entry = next;
+		}
+	}
+	free(cache->entries);
+	free(cache->root);
+	pthread_mutex_destroy(&cache->lock);
+	free(cache);
+}
@@ -0,0 +1,45 @@
+#ifndef IMAGE_SIZE_HEADER
+#define IMAGE_SIZE_HEADER
+
+#include "../../shared/Type.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+/**
+ * The sizes of the local images that a program shows (see
+ * "IMAGE_DIMENSIONS"), read from the headers of PNG, JPEG, GIF and WebP
+ * files without decoding them. They're kept by path, and read again only if
+ * the file was modified since. It can be used from many threads at once.
+ */
+typedef struct ImageSizeCache ImageSizeCache;
+
+typedef struct ImageSizeCacheStatistics {
+	size_t hits;
+	size_t misses;
+} ImageSizeCacheStatistics;
+
+/**
+ * Creates an empty cache, whose images are relative to the given directory.
+ */
+ImageSizeCache * createImageSizeCache(const char * root);
+
+/**
+ * Finds the width and the height of the image of a "src" attribute. Returns
+ * false if it's not a local file, or if its format isn't known.
+ */
+boolean imageSize(ImageSizeCache * cache, const char * src, unsigned int * width, unsigned int * height);
+
+/**
+ * The lookups that found a size read before, and the ones that read a file.
+ */
+ImageSizeCacheStatistics imageSizeCacheStatistics(ImageSizeCache * cache);
+
+/**
+ * Releases the cache.
+ */
+void destroyImageSizeCache(ImageSizeCache * cache);
+
+#endif
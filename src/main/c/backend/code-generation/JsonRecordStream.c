@@ -0,0 +1,433 @@
+#include "JsonRecordStream.h"
+
+/* MODULE INTERNAL STATE */
+
+static const size_t _bufferSize = 64 * 1024;
+
+/**
+ * A growable string, reused from one record to the next.
+ */
+typedef struct {
+	char * bytes;
+	size_t length;
+	size_t capacity;
+	boolean present;
+} JsonValue;
+
+struct JsonRecordStream {
+	FILE * file;
+	char * buffer;
+	size_t position;
+	size_t filled;
+	// The amount of bytes of the file consumed before the buffer.
+	size_t offset;
+	unsigned long records;
+	boolean started;
+	boolean finished;
+	const char ** keys;
+	unsigned int keyCount;
+	JsonValue * values;
+	JsonValue key;
+	char error[160];
+};
+
+/* PRIVATE FUNCTIONS */
+
+static int _peek(JsonRecordStream * stream);
+static int _take(JsonRecordStream * stream);
+static void _skipSpaces(JsonRecordStream * stream);
+static boolean _fail(JsonRecordStream * stream, const char * what);
+static boolean _expect(JsonRecordStream * stream, const char expected, const char * what);
+static void _append(JsonValue * value, const char byte);
+static void _appendCodePoint(JsonValue * value, const unsigned long codePoint);
+static boolean _readHex(JsonRecordStream * stream, unsigned long * codePoint);
+static boolean _readString(JsonRecordStream * stream, JsonValue * into);
+static const char * _skipDigits(const char * c);
+static boolean _isScalar(const char * token);
+static boolean _readScalar(JsonRecordStream * stream, JsonValue * into);
+static boolean _skipContainer(JsonRecordStream * stream);
+static boolean _readValue(JsonRecordStream * stream, JsonValue * into);
+
+/**
+ * The next byte of the file without consuming it, or EOF.
+ */
+static int _peek(JsonRecordStream * stream) {
+	if (stream->position == stream->filled) {
+		stream->offset += stream->filled;
+		stream->position = 0;
+		stream->filled = fread(stream->buffer, sizeof(char), _bufferSize, stream->file);
+		if (stream->filled == 0) {
+			return EOF;
+		}
+	}
+	return (unsigned char) stream->buffer[stream->position];
+}
+
+/**
+ * Consumes the next byte of the file, or returns EOF.
+ */
+static int _take(JsonRecordStream * stream) {
+	const int byte = _peek(stream);
+	if (byte != EOF) {
+		++stream->position;
+	}
+	return byte;
+}
+
+static void _skipSpaces(JsonRecordStream * stream) {
+	int byte = _peek(stream);
+	while (byte == ' ' || byte == '\t' || byte == '\n' || byte == '\r') {
+		++stream->position;
+		byte = _peek(stream);
+	}
+}
+
+static boolean _fail(JsonRecordStream * stream, const char * what) {
+	snprintf(stream->error, sizeof(stream->error), "%s at byte %zu (record %lu)",
+		what, stream->offset + stream->position, stream->records + 1);
+	return false;
+}
+
+static boolean _expect(JsonRecordStream * stream, const char expected, const char * what) {
+	_skipSpaces(stream);
+	if (_take(stream) != expected) {
+		return _fail(stream, what);
+	}
+	return true;
+}
+
+static void _append(JsonValue * value, const char byte) {
+	if (value->length + 1 >= value->capacity) {
+		value->capacity = value->capacity == 0 ? 64 : 2 * value->capacity;
+		value->bytes = realloc(value->bytes, value->capacity);
+	}
+	value->bytes[value->length++] = byte;
+	value->bytes[value->length] = '\0';
+}
+
+/**
+ * Appends a code-point encoded in UTF-8.
+ */
+static void _appendCodePoint(JsonValue * value, const unsigned long codePoint) {
+	if (codePoint < 0x80) {
+		_append(value, (char) codePoint);
+	}
+	else if (codePoint < 0x800) {
+		_append(value, (char) (0xC0 | (codePoint >> 6)));
+		_append(value, (char) (0x80 | (codePoint & 0x3F)));
+	}
+	else if (codePoint < 0x10000) {
+		_append(value, (char) (0xE0 | (codePoint >> 12)));
+		_append(value, (char) (0x80 | ((codePoint >> 6) & 0x3F)));
+		_append(value, (char) (0x80 | (codePoint & 0x3F)));
+	}
+	else {
+		_append(value, (char) (0xF0 | (codePoint >> 18)));
+		_append(value, (char) (0x80 | ((codePoint >> 12) & 0x3F)));
+		_append(value, (char) (0x80 | ((codePoint >> 6) & 0x3F)));
+		_append(value, (char) (0x80 | (codePoint & 0x3F)));
+	}
+}
+
+/**
+ * Reads the 4 hexadecimal digits of a "\u" escape.
+ */
+static boolean _readHex(JsonRecordStream * stream, unsigned long * codePoint) {
+	*codePoint = 0;
+	for (unsigned int k = 0; k < 4; ++k) {
+		const int digit = _take(stream);
+		*codePoint <<= 4;
+		if ('0' <= digit && digit <= '9') {
+			*codePoint |= digit - '0';
+		}
+		else if ('a' <= digit && digit <= 'f') {
+			*codePoint |= digit - 'a' + 10;
+		}
+		else if ('A' <= digit && digit <= 'F') {
+			*codePoint |= digit - 'A' + 10;
+		}
+		else {
+			return _fail(stream, "Invalid unicode escape");
+		}
+	}
+	return true;
+}
+
+/**
+ * Reads a string (after its opening quote), decoding its escapes. If there
+ * is no destination, the string is only skipped.
+ */
+static boolean _readString(JsonRecordStream * stream, JsonValue * into) {
+	if (into != NULL) {
+		into->length = 0;
+		_append(into, '\0');
+		into->length = 0;
+		into->present = true;
+	}
+	for (;;) {
+		int byte = _take(stream);
+		if (byte == '"') {
+			return true;
+		}
+		if (byte == EOF || byte == '\n') {
+			return _fail(stream, "Unterminated string");
+		}
+		if (byte == '\\') {
+			byte = _take(stream);
+			unsigned long codePoint = 0;
+			switch (byte) {
+				case '"': case '\\': case '/': break;
+				case 'b': byte = '\b'; break;
+				case 'f': byte = '\f'; break;
+				case 'n': byte = '\n'; break;
+				case 'r': byte = '\r'; break;
+				case 't': byte = '\t'; break;
+				case 'u':
+					if (!_readHex(stream, &codePoint)) {
+						return false;
+					}
+					if (0xD800 <= codePoint && codePoint < 0xDC00) {
+						unsigned long low = 0;
+						if (_take(stream) != '\\' || _take(stream) != 'u' || !_readHex(stream, &low)
+								|| low < 0xDC00 || 0xE000 <= low) {
+							return _fail(stream, "Invalid surrogate pair");
+						}
+						codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+					}
+					if (into != NULL) {
+						_appendCodePoint(into, codePoint);
+					}
+					continue;
+				default:
+					return _fail(stream, "Invalid escape");
+			}
+		}
+		if (into != NULL) {
+			_append(into, (char) byte);
+		}
+	}
+}
+
+static const char * _skipDigits(const char * c) {
+	while ('0' <= *c && *c <= '9') {
+		++c;
+	}
+	return c;
+}
+
+/**
+ * Whether a token is one of "true", "false" and "null", or a number (a minus
+ * if it's negative, an integer without leading zeros, and then a fraction
+ * and an exponent if it has them).
+ */
+static boolean _isScalar(const char * token) {
+	if (strcmp(token, "true") == 0 || strcmp(token, "false") == 0 || strcmp(token, "null") == 0) {
+		return true;
+	}
+	const char * c = token[0] == '-' ? token + 1 : token;
+	if (*c == '0') {
+		++c;
+	}
+	else if ('1' <= *c && *c <= '9') {
+		c = _skipDigits(c);
+	}
+	else {
+		return false;
+	}
+	if (*c == '.') {
+		const char * fraction = c + 1;
+		c = _skipDigits(fraction);
+		if (c == fraction) {
+			return false;
+		}
+	}
+	if (*c == 'e' || *c == 'E') {
+		const char * exponent = c[1] == '+' || c[1] == '-' ? c + 2 : c + 1;
+		c = _skipDigits(exponent);
+		if (c == exponent) {
+			return false;
+		}
+	}
+	return *c == '\0';
+}
+
+/**
+ * Reads a number, or one of "true", "false" and "null", as is. A "null"
+ * leaves the destination absent.
+ */
+static boolean _readScalar(JsonRecordStream * stream, JsonValue * into) {
+	JsonValue scratch = {0};
+	JsonValue * value = into == NULL ? &scratch : into;
+	value->length = 0;
+	_append(value, '\0');
+	value->length = 0;
+	for (;;) {
+		const int byte = _peek(stream);
+		if (byte == '-' || byte == '+' || byte == '.' || ('0' <= byte && byte <= '9') || ('a' <= byte && byte <= 'z') || ('A' <= byte && byte <= 'Z')) {
+			_append(value, (char) byte);
+			++stream->position;
+		}
+		else {
+			break;
+		}
+	}
+	const boolean valid = _isScalar(value->bytes);
+	if (valid && into != NULL) {
+		into->present = strcmp(into->bytes, "null") != 0;
+	}
+	free(scratch.bytes);
+	return valid || _fail(stream, "Invalid value");
+}
+
+/**
+ * Skips an object or an array (after its opening bracket), no matter how
+ * deep it is.
+ */
+static boolean _skipContainer(JsonRecordStream * stream) {
+	unsigned long depth = 1;
+	while (depth > 0) {
+		const int byte = _take(stream);
+		if (byte == EOF) {
+			return _fail(stream, "Unexpected end of file");
+		}
+		if (byte == '"') {
+			if (!_readString(stream, NULL)) {
+				return false;
+			}
+		}
+		else if (byte == '{' || byte == '[') {
+			++depth;
+		}
+		else if (byte == '}' || byte == ']') {
+			--depth;
+		}
+	}
+	return true;
+}
+
+/**
+ * Reads the value of a field into the destination, or skips it if there's
+ * no destination. Only scalars can be kept.
+ */
+static boolean _readValue(JsonRecordStream * stream, JsonValue * into) {
+	_skipSpaces(stream);
+	const int byte = _peek(stream);
+	if (byte == '"') {
+		++stream->position;
+		return _readString(stream, into);
+	}
+	if (byte == '{' || byte == '[') {
+		if (into != NULL) {
+			return _fail(stream, "Expected a string, a number or a boolean");
+		}
+		++stream->position;
+		return _skipContainer(stream);
+	}
+	return _readScalar(stream, into);
+}
+
+/* PUBLIC FUNCTIONS */
+
+JsonRecordStream * openJsonRecordStream(const char * path, const char ** keys, const unsigned int keyCount) {
+	FILE * file = fopen(path, "rb");
+	if (file == NULL) {
+		return NULL;
+	}
+	JsonRecordStream * stream = calloc(1, sizeof(JsonRecordStream));
+	stream->file = file;
+	stream->buffer = malloc(_bufferSize);
+	stream->keys = keys;
+	stream->keyCount = keyCount;
+	stream->values = calloc(keyCount + 1, sizeof(JsonValue));
+	return stream;
+}
+
+JsonRecordStatus nextJsonRecord(JsonRecordStream * stream) {
+	if (stream->finished) {
+		return JSON_RECORD_END;
+	}
+	if (!stream->started) {
+		stream->started = true;
+		if (!_expect(stream, '[', "Expected an array")) {
+			return JSON_RECORD_ERROR;
+		}
+		_skipSpaces(stream);
+		if (_peek(stream) == ']') {
+			stream->finished = true;
+			return JSON_RECORD_END;
+		}
+	}
+	else {
+		_skipSpaces(stream);
+		const int byte = _take(stream);
+		if (byte == ']') {
+			stream->finished = true;
+			return JSON_RECORD_END;
+		}
+		if (byte != ',') {
+			_fail(stream, "Expected \",\" or \"]\"");
+			return JSON_RECORD_ERROR;
+		}
+	}
+	if (!_expect(stream, '{', "Expected an object")) {
+		return JSON_RECORD_ERROR;
+	}
+	for (unsigned int k = 0; k < stream->keyCount; ++k) {
+		stream->values[k].present = false;
+	}
+	_skipSpaces(stream);
+	if (_peek(stream) == '}') {
+		++stream->position;
+		++stream->records;
+		return JSON_RECORD_READ;
+	}
+	for (;;) {
+		if (!_expect(stream, '"', "Expected a key") || !_readString(stream, &stream->key)
+				|| !_expect(stream, ':', "Expected \":\"")) {
+			return JSON_RECORD_ERROR;
+		}
+		JsonValue * into = NULL;
+		for (unsigned int k = 0; k < stream->keyCount; ++k) {
+			if (strcmp(stream->keys[k], stream->key.bytes) == 0) {
+				into = &stream->values[k];
+				break;
+			}
+		}
+		if (!_readValue(stream, into)) {
+			return JSON_RECORD_ERROR;
+		}
+		_skipSpaces(stream);
+		const int byte = _take(stream);
+		if (byte == '}') {
+			break;
+		}
+		if (byte != ',') {
+			_fail(stream, "Expected \",\" or \"}\"");
+			return JSON_RECORD_ERROR;
+		}
+	}
+	++stream->records;
+	return JSON_RECORD_READ;
+}
+
+const char * jsonRecordValue(const JsonRecordStream * stream, const unsigned int k) {
+	return stream->values[k].present ? stream->values[k].bytes : NULL;
+}
+
+const char * jsonRecordError(const JsonRecordStream * stream) {
+	return stream->error;
+}
+
+void closeJsonRecordStream(JsonRecordStream * stream) {
+	if (stream == NULL) {
+		return;
+	}
+	fclose(stream->file);
+	for (unsigned int k = 0; k < stream->keyCount; ++k) {
+		free(stream->values[k].bytes);
+	}
+	free(stream->values);
+	free(stream->key.bytes);
+	free(stream->buffer);
+	free(stream);
+}
@@ -0,0 +1,52 @@
+#ifndef JSON_RECORD_STREAM_HEADER
+#define JSON_RECORD_STREAM_HEADER
+
+#include "../../shared/Type.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Reads the records of a JSON array of objects, one at a time, from a file.
+ * The file is consumed through a fixed-size buffer, and only the scalar
+ * fields whose key is requested are kept (and only until the next record);
+ * every other value is skipped as it streams by, so no record is ever held
+ * entirely in memory.
+ */
+typedef struct JsonRecordStream JsonRecordStream;
+
+typedef enum {
+	JSON_RECORD_READ = 0,
+	JSON_RECORD_END = 1,
+	JSON_RECORD_ERROR = 2
+} JsonRecordStatus;
+
+/**
+ * Opens the file, and prepares to extract the given keys of every record.
+ * Returns NULL if the file cannot be opened.
+ */
+JsonRecordStream * openJsonRecordStream(const char * path, const char ** keys, const unsigned int keyCount);
+
+/**
+ * Reads the next record. On success, "jsonRecordValue" holds the value of
+ * each requested key (or NULL if the record does not have it).
+ */
+JsonRecordStatus nextJsonRecord(JsonRecordStream * stream);
+
+/**
+ * The value of the k-th requested key in the last record read. It's only
+ * valid until the next record is read.
+ */
+const char * jsonRecordValue(const JsonRecordStream * stream, const unsigned int k);
+
+/**
+ * After an error, a description of it (including the byte offset).
+ */
+const char * jsonRecordError(const JsonRecordStream * stream);
+
+/**
+ * Closes the file and releases the stream.
+ */
+void closeJsonRecordStream(JsonRecordStream * stream);
+
+#endif
@@ -0,0 +1,534 @@
+#include "NativeGenerator.h"
+
+/* MODULE INTERNAL STATE */
+
+static Logger * _logger = NULL;
+// The name of the translation unit in "src/output" (NULL if it's disabled).
+static const char * _fileName = NULL;
+
+// The parts of the translation unit, in the order they're written out.
+static OutputBuffer _prototypes;
+static OutputBuffer _arguments;
+static OutputBuffer _functions;
+static OutputBuffer _header;
+
+/**
+ * The position of every define in the registry, sorted by address, so a
+ * "@use" finds the function of its define with a binary search.
+ */
+typedef struct DefineIndex {
+	const Define * define;
+	unsigned int k;
+} DefineIndex;
+
+static DefineIndex * _defineIndices = NULL;
+static unsigned int _defineCount = 0;
+
+// The constant bytes to write next. They're merged until something that
+// isn't constant comes (a label, a jump, a call or an argument).
+static OutputBuffer _chunk;
+// Whether the indentation where the function being translated runs is known
+// (the program always runs at the first level), so it's merged as well.
+static boolean _indentKnown = false;
+
+// The program is split in functions of this many calls at most, so the C
+// compiler doesn't have to optimize a single huge one.
+static const size_t _callsPerPart = 256;
+static unsigned int _programParts = 0;
+static size_t _calls = 0;
+
+static size_t _argumentArrays = 0;
+static size_t _labels = 0;
+static size_t _inlinedStatics = 0;
+static unsigned int _indentation = 0;
+// Whether the program has a statement that can't be translated.
+static boolean _untranslatable = false;
+
+/**
+ * What every translation unit starts with: the functions that write into the
+ * buffer of the caller. Bytes that don't fit are counted anyway, so the
+ * caller can tell how big the buffer had to be.
+ */
+static const char _runtime[] =
+	"static inline void _write(RenderBuffer * buffer, const char * bytes, const size_t length) {\n"
+	"\tif (buffer->length < buffer->capacity) {\n"
+	"\t\tconst size_t room = buffer->capacity - buffer->length;\n"
+	"\t\tmemcpy(buffer->bytes + buffer->length, bytes, length < room ? length : room);\n"
+	"\t}\n"
+	"\tbuffer->length += length;\n"
+	"}\n"
+	"\n"
+	"static inline void _indent(RenderBuffer * buffer, const unsigned int levels) {\n"
+	"\tstatic const char spaces[] = \"                                                                \";\n"
+	"\tsize_t length = (size_t) levels * INDENTATION_SIZE;\n"
+	"\twhile (length > 0) {\n"
+	"\t\tconst size_t slice = length < sizeof(spaces) - 1 ? length : sizeof(spaces) - 1;\n"
+	"\t\t_write(buffer, spaces, slice);\n"
+	"\t\tlength -= slice;\n"
+	"\t}\n"
+	"}\n"
+	"\n"
+	"static inline void _writeEscaped(RenderBuffer * buffer, const char * text) {\n"
+	"\tconst char * span = text;\n"
+	"\tfor (; *text; ++text) {\n"
+	"\t\tconst char * entity = *text == '<' ? \"&lt;\" : *text == '>' ? \"&gt;\" : *text == '&' ? \"&amp;\" : NULL;\n"
+	"\t\tif (entity) {\n"
+	"\t\t\t_write(buffer, span, (size_t) (text - span));\n"
+	"\t\t\t_write(buffer, entity, strlen(entity));\n"
+	"\t\t\tspan = text + 1;\n"
+	"\t\t}\n"
+	"\t}\n"
+	"\t_write(buffer, span, (size_t) (text - span));\n"
+	"}\n"
+	"\n"
+	"static inline int _holds(const char * argument, const char * literal) {\n"
+	"\treturn argument != NULL && strcmp(argument, literal) == 0;\n"
+	"}\n";
+
+/* PRIVATE FUNCTIONS */
+
+static void _print(OutputBuffer * buffer, const char * format, ...) {
+	char line[256];
+	va_list arguments;
+	va_start(arguments, format);
+	const int length = vsnprintf(line, sizeof(line), format, arguments);
+	va_end(arguments);
+	if (length < 0) {
+		return;
+	}
+	if ((size_t) length < sizeof(line)) {
+		appendToOutputBuffer(buffer, line, (size_t) length);
+		return;
+	}
+	char * longer = malloc((size_t) length + 1);
+	va_start(arguments, format);
+	vsnprintf(longer, (size_t) length + 1, format, arguments);
+	va_end(arguments);
+	appendToOutputBuffer(buffer, longer, (size_t) length);
+	free(longer);
+}
+
+/**
+ * Writes bytes as a C string literal, split in lines of 64 bytes. Anything
+ * but printable ASCII is written as a 3-digit octal escape, so the digits
+ * that follow it are never taken for a part of it.
+ */
+static void _literal(OutputBuffer * buffer, const char * bytes, const size_t length) {
+	appendToOutputBuffer(buffer, "\"", 1);
+	for (size_t k = 0; k < length; ++k) {
+		if (k > 0 && k % 64 == 0) {
+			appendToOutputBuffer(buffer, "\"\n\t\t\"", 5);
+		}
+		const unsigned char c = (unsigned char) bytes[k];
+		if (c == '"' || c == '\\' || c == '?') {
+			const char escaped[] = { '\\', (char) c };
+			appendToOutputBuffer(buffer, escaped, 2);
+		}
+		else if (c == '\n') {
+			appendToOutputBuffer(buffer, "\\n", 2);
+		}
+		else if (c < 0x20 || c >= 0x7F) {
+			_print(buffer, "\\%03o", c);
+		}
+		else {
+			appendToOutputBuffer(buffer, (const char *) &bytes[k], 1);
+		}
+	}
+	appendToOutputBuffer(buffer, "\"", 1);
+}
+
+static void _flushChunk(void) {
+	if (_chunk.length == 0) {
+		return;
+	}
+	_print(&_functions, "\t_write(buffer, ");
+	_literal(&_functions, _chunk.bytes, _chunk.length);
+	_print(&_functions, ", %zu);\n", _chunk.length);
+	discardOutputBuffer(&_chunk);
+	++_calls;
+}
+
+static void _beginLine(const unsigned int depth) {
+	if (_indentation == 0) {
+		return;
+	}
+	if (_indentKnown) {
+		for (size_t k = 0; k < (size_t) depth * _indentation; ++k) {
+			appendToOutputBuffer(&_chunk, " ", 1);
+		}
+		return;
+	}
+	_flushChunk();
+	_print(&_functions, "\t_indent(buffer, indent + %u);\n", depth);
+}
+
+static void _endLine(void) {
+	if (_indentation > 0) {
+		appendToOutputBuffer(&_chunk, "\n", 1);
+	}
+}
+
+static int _compareDefineIndices(const void * a, const void * b) {
+	const Define * x = ((const DefineIndex *) a)->define;
+	const Define * y = ((const DefineIndex *) b)->define;
+	return x < y ? -1 : x > y ? 1 : 0;
+}
+
+/**
+ * The position of a define in the registry, or -1 if it's not there.
+ */
+static long _defineIndex(const Define * define) {
+	const DefineIndex key = { .define = define, .k = 0 };
+	const DefineIndex * found = bsearch(&key, _defineIndices, _defineCount, sizeof(DefineIndex), _compareDefineIndices);
+	return found ? (long) found->k : -1;
+}
+
+/**
+ * The name of a define as a C identifier ("-" is not allowed in one).
+ */
+static void _identifier(OutputBuffer * buffer, const char * name) {
+	for (const char * c = name; *c; ++c) {
+		appendToOutputBuffer(buffer, *c == '-' ? "_" : c, 1);
+	}
+}
+
+/**
+ * Writes the array of arguments of a "@use", and returns its number.
+ */
+static size_t _argumentArray(ParameterList * parameters) {
+	const size_t number = _argumentArrays++;
+	_print(&_arguments, "static const char * const _arguments_%zu[] = {", number);
+	for (Parameter * p = parameters ? parameters->head : NULL; p; p = p->next) {
+		appendToOutputBuffer(&_arguments, p == parameters->head ? " " : ", ", p == parameters->head ? 1 : 2);
+		if (p->value) {
+			_literal(&_arguments, p->value, strlen(p->value));
+		}
+		else {
+			_print(&_arguments, "NULL");
+		}
+	}
+	_print(&_arguments, " };\n");
+	return number;
+}
+
+static void _call(const Instruction * instruction, const unsigned int depth) {
+	Define * define = resolveUse(instruction->statement->use);
+	const long k = define ? _defineIndex(define) : -1;
+	if (k < 0) {
+		return;
+	}
+	++_calls;
+	ParameterList * parameters = instruction->statement->use->parameters;
+	if (parameters && parameters->head) {
+		_print(&_functions, "\t_define_%ld(buffer, indent + %u, _arguments_%zu);\n", k, depth, _argumentArray(parameters));
+	}
+	else {
+		_print(&_functions, "\t_define_%ld(buffer, indent + %u, NULL);\n", k, depth);
+	}
+}
+
+static void _translate(const Bytecode * code, const unsigned int offset);
+static void _nextProgramPart(void);
+
+/**
+ * A statement left to the tree walker: static fragments are translated in
+ * place, defines were registered already, and "@each" reads its records
+ * while the program is generated, so it can't be translated.
+ */
+static void _visit(const Instruction * instruction, const unsigned int offset) {
+	Statement * statement = instruction->statement;
+	switch (statement->type) {
+		case STATEMENT_STATIC_HTML:
+			++_inlinedStatics;
+			_translate(compileStaticHtml(statement->static_html), offset + instruction->depth);
+			break;
+		case STATEMENT_EACH:
+			_untranslatable = true;
+			break;
+		default:
+			break;
+	}
+}
+
+/**
+ * Translates code into the body of a function, at a depth under where the
+ * function runs. The instructions that only enforce the limits of the
+ * generator (or flush its output) are left out, and jumps become gotos to
+ * labels numbered after the instruction they land on.
+ */
+static void _translate(const Bytecode * code, const unsigned int offset) {
+	const size_t labels = _labels;
+	_labels += code->count;
+	boolean * targets = calloc(code->count + 1, sizeof(boolean));
+	for (size_t k = 0; k < code->count; ++k) {
+		switch (code->instructions[k].opcode) {
+			case OP_BRANCH_UNLESS_EQUAL:
+			case OP_BRANCH_IF_EQUAL:
+			case OP_JUMP:
+				targets[k + code->instructions[k].jump] = true;
+				break;
+			default:
+				break;
+		}
+	}
+	for (size_t k = 0; k < code->count; ++k) {
+		const Instruction * instruction = &code->instructions[k];
+		const unsigned int depth = offset + instruction->depth;
+		if (_indentKnown && _calls >= _callsPerPart) {
+			_nextProgramPart();
+		}
+		if (targets[k]) {
+			_flushChunk();
+			_print(&_functions, "l%zu:;\n", labels + k);
+		}
+		switch (instruction->opcode) {
+			case OP_BEGIN_LINE:
+				_beginLine(depth);
+				break;
+			case OP_END_LINE:
+				_endLine();
+				break;
+			case OP_STATIC:
+				appendToOutputBuffer(&_chunk, instruction->bytes, instruction->length);
+				break;
+			case OP_LINE:
+			case OP_NODE:
+				_beginLine(depth);
+				appendToOutputBuffer(&_chunk, instruction->bytes, instruction->length);
+				_endLine();
+				break;
+			case OP_ARGUMENT:
+				_flushChunk();
+				_print(&_functions, "\tif (arguments[%zu]) {\n\t\t_writeEscaped(buffer, arguments[%zu]);\n\t}\n\telse {\n\t\t_write(buffer, ",
+					instruction->slot, instruction->slot);
+				_literal(&_functions, instruction->bytes, instruction->length);
+				_print(&_functions, ", %zu);\n\t}\n", instruction->length);
+				break;
+			case OP_BRANCH_UNLESS_EQUAL:
+			case OP_BRANCH_IF_EQUAL:
+				_flushChunk();
+				_print(&_functions, "\tif (%s_holds(arguments[%zu], ", instruction->opcode == OP_BRANCH_UNLESS_EQUAL ? "!" : "", instruction->slot);
+				_literal(&_functions, instruction->bytes, strlen(instruction->bytes));
+				_print(&_functions, ")) {\n\t\tgoto l%zu;\n\t}\n", labels + k + instruction->jump);
+				break;
+			case OP_JUMP:
+				_flushChunk();
+				_print(&_functions, "\tgoto l%zu;\n", labels + k + instruction->jump);
+				break;
+			case OP_CALL:
+				_flushChunk();
+				_call(instruction, depth);
+				break;
+			case OP_VISIT:
+				_visit(instruction, offset);
+				break;
+			case OP_ENTER:
+			case OP_LEAVE:
+			case OP_FLUSH:
+			case OP_RETURN:
+				break;
+		}
+	}
+	free(targets);
+}
+
+static void _beginFunction(const char * name, const unsigned int number, const boolean indentKnown) {
+	_print(&_functions, "\nstatic void _%s_%u(RenderBuffer * buffer, const unsigned int indent, const char * const * arguments) {\n", name, number);
+	_print(&_functions, "\t(void) indent;\n\t(void) arguments;\n");
+	_indentKnown = indentKnown;
+	_calls = 0;
+}
+
+static void _endFunction(void) {
+	_flushChunk();
+	_print(&_functions, "}\n");
+}
+
+/**
+ * Goes on with the program in a new function. It has no jumps, so it can be
+ * split anywhere.
+ */
+static void _nextProgramPart(void) {
+	_endFunction();
+	_print(&_prototypes, "static void _program_%u(RenderBuffer * buffer, const unsigned int indent, const char * const * arguments);\n", ++_programParts);
+	_beginFunction("program", _programParts, true);
+}
+
+/**
+ * Writes a part of the translation unit to its file.
+ */
+static boolean _writeFile(const char * name, OutputBuffer ** parts, const size_t count) {
+	const size_t length = strlen("src/output/") + strlen(name) + 1;
+	char * path = malloc(length);
+	snprintf(path, length, "src/output/%s", name);
+	FILE * file = fopen(path, "w");
+	free(path);
+	if (file == NULL) {
+		return false;
+	}
+	boolean written = true;
+	for (size_t k = 0; k < count; ++k) {
+		if (parts[k]->length > 0 && fwrite(parts[k]->bytes, 1, parts[k]->length, file) != parts[k]->length) {
+			written = false;
+		}
+	}
+	return fclose(file) == 0 && written;
+}
+
+/**
+ * The name of the header of the translation unit: its name with a ".h"
+ * extension instead of ".c" (or after it, if it has none).
+ */
+static char * _headerName(void) {
+	const size_t length = strlen(_fileName);
+	const boolean extension = length > 2 && strcmp(_fileName + length - 2, ".c") == 0;
+	const size_t base = extension ? length - 2 : length;
+	char * name = malloc(base + 3);
+	memcpy(name, _fileName, base);
+	memcpy(name + base, ".h", 3);
+	return name;
+}
+
+static void _writeHeader(const char * headerName, const DefineRegistry * registry) {
+	_print(&_header, "#ifndef ");
+	for (const char * c = headerName; *c; ++c) {
+		const char upper = (char) toupper((unsigned char) *c);
+		appendToOutputBuffer(&_header, isalnum((unsigned char) *c) ? &upper : "_", 1);
+	}
+	_print(&_header, "\n#define ");
+	for (const char * c = headerName; *c; ++c) {
+		const char upper = (char) toupper((unsigned char) *c);
+		appendToOutputBuffer(&_header, isalnum((unsigned char) *c) ? &upper : "_", 1);
+	}
+	_print(&_header,
+		"\n\n/* Generated by the compiler, do not edit. */\n\n"
+		"#include <stddef.h>\n\n"
+		"#ifndef RENDER_BUFFER\n"
+		"#define RENDER_BUFFER\n\n"
+		"/**\n"
+		" * Where a render function writes its output. Only the first \"capacity\"\n"
+		" * bytes are written, but \"length\" counts them all, so the output was\n"
+		" * complete if it's not greater than the capacity.\n"
+		" */\n"
+		"typedef struct RenderBuffer {\n"
+		"\tchar * bytes;\n"
+		"\tsize_t capacity;\n"
+		"\tsize_t length;\n"
+		"} RenderBuffer;\n\n"
+		"#endif\n\n"
+		"/** Writes the whole document of the program. */\n"
+		"void render_program(RenderBuffer * buffer);\n");
+	for (unsigned int k = 0; k < registeredDefines(registry); ++k) {
+		const Define * define = registeredDefine(registry, k);
+		_print(&_header, "\n/** Writes the body of \"%s\", with an argument per parameter (in order). */\nvoid render_", define->name);
+		_identifier(&_header, define->name);
+		_print(&_header, "(RenderBuffer * buffer, const char * const * arguments);\n");
+	}
+	_print(&_header, "\n#endif\n");
+}
+
+/* PUBLIC FUNCTIONS */
+
+void initializeNativeGeneratorModule() {
+	_logger = createLogger("NativeGenerator");
+	_fileName = getStringOrDefault("NATIVE_OUTPUT_FILE", "");
+	if (_fileName[0] == '\0') {
+		_fileName = NULL;
+	}
+	else if (getBooleanOrDefault("IMAGE_LOADING_HINTS", false)) {
+		logWarning(_logger, "The C translation unit is not generated, because its functions would write the images of a define the same way every time they're called.");
+		_fileName = NULL;
+	}
+	openOutputBuffer(&_prototypes, -1, 0);
+	openOutputBuffer(&_arguments, -1, 0);
+	openOutputBuffer(&_functions, -1, 0);
+	openOutputBuffer(&_header, -1, 0);
+	openOutputBuffer(&_chunk, -1, 0);
+}
+
+void shutdownNativeGeneratorModule() {
+	closeOutputBuffer(&_prototypes);
+	closeOutputBuffer(&_arguments);
+	closeOutputBuffer(&_functions);
+	closeOutputBuffer(&_header);
+	closeOutputBuffer(&_chunk);
+	free(_defineIndices);
+	_defineIndices = NULL;
+	_defineCount = 0;
+	if (_logger != NULL) {
+		destroyLogger(_logger);
+		_logger = NULL;
+	}
+}
+
+void generateNative(CompilerState * compilerState) {
+	if (_fileName == NULL) {
+		return;
+	}
+	Bytecode * document = compileDocument(compilerState->abstractSyntaxtTree);
+	if (document == NULL) {
+		logWarning(_logger, "The C translation unit is not generated, because the program was streamed.");
+		return;
+	}
+	_indentation = generatedIndentation();
+	const DefineRegistry * registry = generatedDefines();
+	_defineCount = registeredDefines(registry);
+	_defineIndices = calloc(_defineCount + 1, sizeof(DefineIndex));
+	for (unsigned int k = 0; k < _defineCount; ++k) {
+		_defineIndices[k].define = registeredDefine(registry, k);
+		_defineIndices[k].k = k;
+		_print(&_prototypes, "static void _define_%u(RenderBuffer * buffer, const unsigned int indent, const char * const * arguments);\n", k);
+	}
+	qsort(_defineIndices, _defineCount, sizeof(DefineIndex), _compareDefineIndices);
+
+	_print(&_prototypes, "static void _program_0(RenderBuffer * buffer, const unsigned int indent, const char * const * arguments);\n");
+	_beginFunction("program", 0, true);
+	_translate(document, 0);
+	_endFunction();
+	for (unsigned int k = 0; k < _defineCount; ++k) {
+		Bytecode * code = compileDefine(registeredDefine(registry, k));
+		_beginFunction("define", k, false);
+		if (code != NULL) {
+			_translate(code, 0);
+		}
+		_endFunction();
+	}
+	if (_untranslatable) {
+		logWarning(_logger, "The C translation unit is not generated, because \"@each\" reads its records while the program is generated.");
+		return;
+	}
+
+	char * headerName = _headerName();
+	OutputBuffer preamble;
+	openOutputBuffer(&preamble, -1, 0);
+	_print(&preamble, "/* Generated by the compiler, do not edit. */\n\n#include \"%s\"\n#include <string.h>\n\n#define INDENTATION_SIZE %u\n\n%s\n",
+		headerName, _indentation, _runtime);
+	OutputBuffer wrappers;
+	openOutputBuffer(&wrappers, -1, 0);
+	_print(&wrappers, "\nvoid render_program(RenderBuffer * buffer) {\n");
+	for (unsigned int k = 0; k <= _programParts; ++k) {
+		_print(&wrappers, "\t_program_%u(buffer, 0, NULL);\n", k);
+	}
+	_print(&wrappers, "}\n");
+	for (unsigned int k = 0; k < _defineCount; ++k) {
+		_print(&wrappers, "\nvoid render_");
+		_identifier(&wrappers, registeredDefine(registry, k)->name);
+		_print(&wrappers, "(RenderBuffer * buffer, const char * const * arguments) {\n\t_define_%u(buffer, 0, arguments);\n}\n", k);
+	}
+	_print(&_prototypes, "\n");
+	_writeHeader(headerName, registry);
+
+	OutputBuffer * unit[] = { &preamble, &_prototypes, &_arguments, &_functions, &wrappers };
+	OutputBuffer * header[] = { &_header };
+	if (!_writeFile(_fileName, unit, sizeof(unit) / sizeof(unit[0])) || !_writeFile(headerName, header, 1)) {
+		logError(_logger, "The C translation unit \"%s\" could not be written.", _fileName);
+		compilerState->succeed = false;
+	}
+	else {
+		logDebugging(_logger, "C translation unit: %u defines, with %zu static fragments inlined, in %zu bytes.",
+			_defineCount, _inlinedStatics, preamble.length + _prototypes.length + _arguments.length + _functions.length + wrappers.length);
+	}
+	closeOutputBuffer(&preamble);
+	closeOutputBuffer(&wrappers);
+	free(headerName);
+}
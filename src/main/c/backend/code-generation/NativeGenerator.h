@@ -0,0 +1,33 @@
+#ifndef NATIVE_GENERATOR_HEADER
+#define NATIVE_GENERATOR_HEADER
+
+#include "../../frontend/syntactic-analysis/AbstractSyntaxTree.h"
+#include "../../shared/CompilerState.h"
+#include "../../shared/Environment.h"
+#include "../../shared/Logger.h"
+#include "Bytecode.h"
+#include "DefineRegistry.h"
+#include "Generator.h"
+#include "OutputBuffer.h"
+#include <ctype.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Initialize module's internal state. */
+void initializeNativeGeneratorModule();
+
+/** Shutdown module's internal state. */
+void shutdownNativeGeneratorModule();
+
+/**
+ * Translates the program into a C translation unit (and its header), if it's
+ * enabled (see "NATIVE_OUTPUT_FILE"): one render function for the program,
+ * and one for every define, that write the same output as the generator into
+ * a buffer of the caller. It's built from the bytecode of the generator, so
+ * it runs once the output has been generated.
+ */
+void generateNative(CompilerState * compilerState);
+
+#endif
@@ -0,0 +1,276 @@
+#include "OutputBuffer.h"
+#include <limits.h>
+
+// The most pieces that a "writev" call takes (POSIX only requires 16, but
+// Linux and macOS take 1024).
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+/* PRIVATE FUNCTIONS */
+
+static const size_t _initialCapacity = 256;
+static const size_t _initialPieceCapacity = 64;
+
+// Bytes shorter than the piece that would describe them are cheaper to copy.
+static const size_t _minimumBorrowedLength = sizeof(struct iovec);
+
+/**
+ * How many of its own bytes the buffer is using.
+ */
+static size_t _usedBytes(OutputBuffer * buffer) {
+	return buffer->pieces == NULL ? buffer->length : buffer->copiedLength;
+}
+
+/**
+ * Adds a piece to a vectored buffer, or grows the last one if the bytes
+ * follow it.
+ */
+static void _addPiece(OutputBuffer * buffer, const char * bytes, const size_t length) {
+	if (buffer->pieceCount > 0) {
+		OutputPiece * last = &buffer->pieces[buffer->pieceCount - 1];
+		if ((bytes == NULL && last->bytes == NULL) || (bytes != NULL && last->bytes != NULL && last->bytes + last->length == bytes)) {
+			last->length += length;
+			return;
+		}
+	}
+	if (buffer->pieceCount == buffer->pieceCapacity) {
+		buffer->pieceCapacity *= 2;
+		buffer->pieces = realloc(buffer->pieces, buffer->pieceCapacity * sizeof(OutputPiece));
+	}
+	buffer->pieces[buffer->pieceCount++] = (OutputPiece) { bytes, length };
+}
+
+/**
+ * Writes out the pieces of a vectored buffer, up to IOV_MAX of them with
+ * every "writev" call (and the rest of a piece that was written partially
+ * first, with the next call).
+ */
+static size_t _writePieces(OutputBuffer * buffer) {
+	struct iovec vectors[IOV_MAX];
+	size_t written = 0;
+	size_t index = 0;
+	// The bytes of the current piece that were already written, and where
+	// its own bytes start, if it has them.
+	size_t done = 0;
+	size_t ownOffset = 0;
+	while (index < buffer->pieceCount) {
+		int count = 0;
+		size_t offset = ownOffset;
+		for (size_t k = index; k < buffer->pieceCount && count < IOV_MAX; ++k, ++count) {
+			const OutputPiece * piece = &buffer->pieces[k];
+			const char * bytes = piece->bytes == NULL ? buffer->bytes + offset : piece->bytes;
+			const size_t skipped = k == index ? done : 0;
+			if (piece->bytes == NULL) {
+				offset += piece->length;
+			}
+			vectors[count].iov_base = (void *) (bytes + skipped);
+			vectors[count].iov_len = piece->length - skipped;
+		}
+		const ssize_t result = writev(buffer->descriptor, vectors, count);
+		++buffer->writes;
+		if (result < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			buffer->failed = true;
+			break;
+		}
+		written += result;
+		size_t left = result;
+		while (left > 0) {
+			const OutputPiece * piece = &buffer->pieces[index];
+			if (left < piece->length - done) {
+				done += left;
+				break;
+			}
+			left -= piece->length - done;
+			done = 0;
+			if (piece->bytes == NULL) {
+				ownOffset += piece->length;
+			}
+			++index;
+		}
+	}
+	return written;
+}
+
+/**
+ * Whether the buffer is written out somewhere, instead of growing in memory.
+ */
+static boolean _written(OutputBuffer * buffer) {
+	return buffer->descriptor >= 0 || buffer->gzip != NULL;
+}
+
+/**
+ * Hands a run of the output that's written out to what also takes it: the
+ * gzip stream, and the hash.
+ */
+static void _consume(OutputBuffer * buffer, const char * bytes, const size_t length) {
+	if (buffer->gzip != NULL) {
+		writeGzipStream(buffer->gzip, bytes, length);
+	}
+	if (buffer->hashing) {
+		uint64_t hash = buffer->hash;
+		for (size_t k = 0; k < length; ++k) {
+			hash = (hash ^ (unsigned char) bytes[k]) * 1099511628211ULL;
+		}
+		buffer->hash = hash;
+	}
+}
+
+/**
+ * Hands the pending output to "_consume", in order.
+ */
+static void _consumePending(OutputBuffer * buffer) {
+	if (buffer->pieces == NULL) {
+		_consume(buffer, buffer->bytes, buffer->length);
+		return;
+	}
+	size_t offset = 0;
+	for (size_t k = 0; k < buffer->pieceCount; ++k) {
+		const OutputPiece * piece = &buffer->pieces[k];
+		if (piece->bytes == NULL) {
+			_consume(buffer, buffer->bytes + offset, piece->length);
+			offset += piece->length;
+		}
+		else {
+			_consume(buffer, piece->bytes, piece->length);
+		}
+	}
+}
+
+/* PUBLIC FUNCTIONS */
+
+void openOutputBuffer(OutputBuffer * buffer, const int descriptor, const size_t blockSize) {
+	buffer->bytes = NULL;
+	buffer->length = 0;
+	buffer->capacity = 0;
+	buffer->descriptor = descriptor;
+	buffer->blockSize = blockSize;
+	buffer->pieces = NULL;
+	buffer->pieceCount = 0;
+	buffer->pieceCapacity = 0;
+	buffer->copiedLength = 0;
+	buffer->writes = 0;
+	buffer->flushedBytes = 0;
+	buffer->copiedBytes = 0;
+	buffer->failed = false;
+	buffer->gzip = NULL;
+	buffer->hashing = false;
+	buffer->hash = 14695981039346656037ULL;
+	reserveOutputBuffer(buffer, blockSize);
+}
+
+void openVectoredOutputBuffer(OutputBuffer * buffer, const int descriptor, const size_t blockSize) {
+	openOutputBuffer(buffer, descriptor, blockSize);
+	buffer->pieceCapacity = _initialPieceCapacity;
+	buffer->pieces = malloc(_initialPieceCapacity * sizeof(OutputPiece));
+}
+
+void reserveOutputBuffer(OutputBuffer * buffer, const size_t length) {
+	const size_t used = _usedBytes(buffer);
+	if (buffer->capacity - used >= length) {
+		return;
+	}
+	size_t capacity = buffer->capacity == 0 ? _initialCapacity : buffer->capacity;
+	while (capacity - used < length) {
+		capacity *= 2;
+	}
+	buffer->bytes = realloc(buffer->bytes, capacity);
+	buffer->capacity = capacity;
+}
+
+void appendToOutputBuffer(OutputBuffer * buffer, const char * bytes, const size_t length) {
+	if (_written(buffer) && buffer->blockSize < buffer->length + length) {
+		flushOutputBuffer(buffer);
+	}
+	if (length == 0) {
+		return;
+	}
+	reserveOutputBuffer(buffer, length);
+	memcpy(buffer->bytes + _usedBytes(buffer), bytes, length);
+	buffer->length += length;
+	if (buffer->pieces != NULL) {
+		buffer->copiedLength += length;
+		_addPiece(buffer, NULL, length);
+	}
+	if (_written(buffer)) {
+		buffer->copiedBytes += length;
+	}
+}
+
+void appendBorrowedToOutputBuffer(OutputBuffer * buffer, const char * bytes, const size_t length) {
+	if (buffer->pieces == NULL || length < _minimumBorrowedLength) {
+		appendToOutputBuffer(buffer, bytes, length);
+		return;
+	}
+	if (_written(buffer) && buffer->blockSize < buffer->length + length) {
+		flushOutputBuffer(buffer);
+	}
+	_addPiece(buffer, bytes, length);
+	buffer->length += length;
+}
+
+void discardOutputBuffer(OutputBuffer * buffer) {
+	buffer->length = 0;
+	buffer->pieceCount = 0;
+	buffer->copiedLength = 0;
+}
+
+boolean flushOutputBuffer(OutputBuffer * buffer) {
+	if (buffer->gzip != NULL || buffer->hashing) {
+		_consumePending(buffer);
+	}
+	if (buffer->descriptor < 0) {
+		if (buffer->gzip != NULL) {
+			buffer->flushedBytes += buffer->length;
+			discardOutputBuffer(buffer);
+		}
+		return true;
+	}
+	if (buffer->pieces != NULL) {
+		buffer->flushedBytes += _writePieces(buffer);
+		discardOutputBuffer(buffer);
+		return !buffer->failed;
+	}
+	size_t offset = 0;
+	while (offset < buffer->length) {
+		const ssize_t written = write(buffer->descriptor, buffer->bytes + offset, buffer->length - offset);
+		++buffer->writes;
+		if (written < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			buffer->failed = true;
+			break;
+		}
+		offset += written;
+	}
+	buffer->flushedBytes += offset;
+	buffer->length = 0;
+	return !buffer->failed;
+}
+
+void closeOutputBuffer(OutputBuffer * buffer) {
+	flushOutputBuffer(buffer);
+	free(buffer->bytes);
+	free(buffer->pieces);
+	buffer->bytes = NULL;
+	buffer->pieces = NULL;
+	buffer->length = 0;
+	buffer->capacity = 0;
+	buffer->pieceCount = 0;
+	buffer->pieceCapacity = 0;
+	buffer->copiedLength = 0;
+}
+
+FlushPolicy flushPolicyFromString(const char * policy) {
+	if (strcmp(policy, "STATEMENTS") == 0) {
+		return FLUSH_STATEMENTS;
+	}
+	if (strcmp(policy, "LINES") == 0) {
+		return FLUSH_LINES;
+	}
+	return FLUSH_BLOCKS;
+}
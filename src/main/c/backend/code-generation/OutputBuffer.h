@@ -0,0 +1,126 @@
+#ifndef OUTPUT_BUFFER_HEADER
+#define OUTPUT_BUFFER_HEADER
+
+#include "../../shared/Type.h"
+#include "GzipStream.h"
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+/**
+ * When a buffer bound to a file is written out (besides when it's full and
+ * when it's closed).
+ */
+typedef enum {
+	// Only in big blocks.
+	FLUSH_BLOCKS = 0,
+	// After every top-level statement, for consumers that stream the output.
+	FLUSH_STATEMENTS = 1,
+	// After every line.
+	FLUSH_LINES = 2
+} FlushPolicy;
+
+/**
+ * A run of the pending output of a vectored buffer: either bytes that live
+ * somewhere else, or the next bytes copied into the buffer.
+ */
+typedef struct OutputPiece {
+	// NULL for bytes copied into the buffer.
+	const char * bytes;
+	size_t length;
+} OutputPiece;
+
+/**
+ * A growable byte buffer. If it's bound to a file descriptor, it is written
+ * out with one "write" call every time it holds a whole block; otherwise, it
+ * only grows in memory (e.g. to capture a fragment of the output).
+ *
+ * A vectored buffer also holds pieces of output that it doesn't copy, and
+ * writes them out along with its own bytes with "writev" calls.
+ *
+ * A buffer can also write a compressed copy of its output into a gzip stream,
+ * as it's written out. Then, without a file, it only writes that copy. And it
+ * can hash its output as it's written out, too.
+ */
+typedef struct OutputBuffer {
+	char * bytes;
+	// The bytes pending, copied or not.
+	size_t length;
+	size_t capacity;
+	// The file where the buffer is flushed, or -1 for a memory buffer.
+	int descriptor;
+	size_t blockSize;
+	// Only for vectored buffers: the pending output, in order, and how many
+	// of its own bytes it has taken.
+	OutputPiece * pieces;
+	size_t pieceCount;
+	size_t pieceCapacity;
+	size_t copiedLength;
+	// The amount of "write" calls, bytes written, and bytes copied so far.
+	size_t writes;
+	size_t flushedBytes;
+	size_t copiedBytes;
+	boolean failed;
+	GzipStream * gzip;
+	// Whether it hashes its output, and the FNV-1a hash of it so far.
+	boolean hashing;
+	uint64_t hash;
+} OutputBuffer;
+
+/**
+ * Prepares a buffer that is flushed into the file descriptor in blocks of
+ * the given size.
+ */
+void openOutputBuffer(OutputBuffer * buffer, const int descriptor, const size_t blockSize);
+
+/**
+ * Prepares a buffer like "openOutputBuffer", but that can borrow the bytes
+ * appended with "appendBorrowedToOutputBuffer" instead of copying them.
+ */
+void openVectoredOutputBuffer(OutputBuffer * buffer, const int descriptor, const size_t blockSize);
+
+/**
+ * Makes room for at least "length" more bytes.
+ */
+void reserveOutputBuffer(OutputBuffer * buffer, const size_t length);
+
+/**
+ * Appends the bytes, flushing the buffer first if they don't fit in the
+ * current block.
+ */
+void appendToOutputBuffer(OutputBuffer * buffer, const char * bytes, const size_t length);
+
+/**
+ * Appends bytes that stay where they are until the next flush, so the caller
+ * can't release nor change them before that. Buffers that aren't vectored
+ * copy them, and so do the rest when they're too short to be worth a piece
+ * of their own.
+ */
+void appendBorrowedToOutputBuffer(OutputBuffer * buffer, const char * bytes, const size_t length);
+
+/**
+ * Drops every pending byte, without writing it out.
+ */
+void discardOutputBuffer(OutputBuffer * buffer);
+
+/**
+ * Writes out every pending byte. Does nothing for memory buffers. Returns
+ * false if the file could not be written.
+ */
+boolean flushOutputBuffer(OutputBuffer * buffer);
+
+/**
+ * Flushes and releases the buffer (the file descriptor is left open).
+ */
+void closeOutputBuffer(OutputBuffer * buffer);
+
+/**
+ * Parses a flush policy ("BLOCKS", "STATEMENTS" or "LINES").
+ */
+FlushPolicy flushPolicyFromString(const char * policy);
+
+#endif
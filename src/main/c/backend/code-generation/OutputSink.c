@@ -0,0 +1,168 @@
+#include "OutputSink.h"
+
+/* PRIVATE FUNCTIONS */
+
+static const size_t _initialCapacity = 16;
+
+static void _write(OutputSink * sink, const char * bytes, const size_t length) {
+	appendToOutputBuffer(&sink->buffer, bytes, length);
+}
+
+static void _writeString(OutputSink * sink, const char * string) {
+	_write(sink, string, strlen(string));
+}
+
+/**
+ * Writes a JSON string, escaping the quotes, the backslashes and the control
+ * characters.
+ */
+static void _writeJsonString(OutputSink * sink, const char * bytes, const size_t length) {
+	_write(sink, "\"", 1);
+	size_t start = 0;
+	for (size_t k = 0; k < length; ++k) {
+		const unsigned char character = (unsigned char) bytes[k];
+		if (character != '"' && character != '\\' && character >= 0x20) {
+			continue;
+		}
+		_write(sink, bytes + start, k - start);
+		start = k + 1;
+		switch (character) {
+			case '"': _write(sink, "\\\"", 2); break;
+			case '\\': _write(sink, "\\\\", 2); break;
+			case '\n': _write(sink, "\\n", 2); break;
+			case '\r': _write(sink, "\\r", 2); break;
+			case '\t': _write(sink, "\\t", 2); break;
+			default: {
+				char escape[8];
+				snprintf(escape, sizeof(escape), "\\u%04x", character);
+				_write(sink, escape, 6);
+				break;
+			}
+		}
+	}
+	_write(sink, bytes + start, length - start);
+	_write(sink, "\"", 1);
+}
+
+/**
+ * Separates a child from the previous one, or opens the children of the
+ * current node if it's the first one.
+ */
+static void _beginJsonChild(OutputSink * sink) {
+	if (sink->depth == 0) {
+		return;
+	}
+	if (sink->children[sink->depth - 1]) {
+		_write(sink, ",", 1);
+	}
+	else {
+		_writeString(sink, ",\"children\":[");
+		sink->children[sink->depth - 1] = true;
+	}
+}
+
+/* PUBLIC FUNCTIONS */
+
+OutputSink * createOutputSink(const OutputSinkType type, const int descriptor, const size_t blockSize) {
+	OutputSink * sink = calloc(1, sizeof(OutputSink));
+	sink->type = type;
+	openOutputBuffer(&sink->buffer, descriptor, blockSize);
+	sink->capacity = _initialCapacity;
+	sink->children = malloc(_initialCapacity * sizeof(boolean));
+	return sink;
+}
+
+void beginSinkNode(OutputSink * sink, const char * type) {
+	if (sink->type == JSON_SINK) {
+		_beginJsonChild(sink);
+		_writeString(sink, "{\"type\":");
+		_writeJsonString(sink, type, strlen(type));
+	}
+	if (sink->depth == sink->capacity) {
+		sink->capacity *= 2;
+		sink->children = realloc(sink->children, sink->capacity * sizeof(boolean));
+	}
+	sink->children[sink->depth++] = false;
+}
+
+void addSinkProperty(OutputSink * sink, const char * key, const char * value) {
+	if (sink->type != JSON_SINK || value == NULL) {
+		return;
+	}
+	_write(sink, ",", 1);
+	_writeJsonString(sink, key, strlen(key));
+	_write(sink, ":", 1);
+	_writeJsonString(sink, value, strlen(value));
+}
+
+void addSinkProperties(OutputSink * sink, const char * key, ParameterList * properties) {
+	if (sink->type != JSON_SINK || properties == NULL || properties->head == NULL) {
+		return;
+	}
+	_write(sink, ",", 1);
+	_writeJsonString(sink, key, strlen(key));
+	_write(sink, ":{", 2);
+	for (Parameter * p = properties->head; p; p = p->next) {
+		if (p != properties->head) {
+			_write(sink, ",", 1);
+		}
+		_writeJsonString(sink, p->key, p->keyLength);
+		_write(sink, ":", 1);
+		_writeJsonString(sink, p->value, p->valueLength);
+	}
+	_write(sink, "}", 1);
+}
+
+void addSinkText(OutputSink * sink, const char * text, const size_t length) {
+	if (sink->type == JSON_SINK) {
+		_beginJsonChild(sink);
+		_writeJsonString(sink, text, length);
+		return;
+	}
+	if (length == 0) {
+		return;
+	}
+	if (sink->pendingLine) {
+		_write(sink, " ", 1);
+	}
+	_write(sink, text, length);
+	sink->pendingLine = true;
+}
+
+void endSinkNode(OutputSink * sink) {
+	if (sink->depth == 0) {
+		return;
+	}
+	const boolean children = sink->children[--sink->depth];
+	if (sink->type == JSON_SINK) {
+		_writeString(sink, children ? "]}" : "}");
+		if (sink->depth == 0) {
+			_write(sink, "\n", 1);
+		}
+		return;
+	}
+	// Every node that holds text ends its line, so the blocks of the page
+	// don't run into each other.
+	if (sink->pendingLine) {
+		_write(sink, "\n", 1);
+		sink->pendingLine = false;
+	}
+}
+
+void discardOutputSink(OutputSink * sink) {
+	discardOutputBuffer(&sink->buffer);
+	if (sink->buffer.descriptor >= 0 && ftruncate(sink->buffer.descriptor, 0) != 0) {
+		sink->buffer.failed = true;
+	}
+}
+
+boolean destroyOutputSink(OutputSink * sink) {
+	if (sink == NULL) {
+		return true;
+	}
+	closeOutputBuffer(&sink->buffer);
+	const boolean written = !sink->buffer.failed;
+	free(sink->children);
+	free(sink);
+	return written;
+}
@@ -0,0 +1,82 @@
+#ifndef OUTPUT_SINK_HEADER
+#define OUTPUT_SINK_HEADER
+
+#include "../../frontend/syntactic-analysis/AbstractSyntaxTree.h"
+#include "OutputBuffer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * The formats that the generator can write along with the HTML, from the same
+ * walk of the tree (see "JSON_OUTPUT_FILE" and "TEXT_OUTPUT_FILE").
+ */
+typedef enum {
+	// The expanded tree of the page: one object per node, with its type, its
+	// properties, and its children (nodes, or strings for their text).
+	JSON_SINK = 0,
+	// Only the text of the page, one line per node that holds text.
+	TEXT_SINK
+} OutputSinkType;
+
+/**
+ * A consumer of the nodes that the generator walks through. It's told when a
+ * node begins, its properties and text, and when it ends, and it writes its
+ * own format into its own file as they come.
+ */
+typedef struct OutputSink {
+	OutputSinkType type;
+	OutputBuffer buffer;
+	// JSON: for every open node, whether it has children yet.
+	boolean * children;
+	size_t depth;
+	size_t capacity;
+	// Text: whether the current line has any text yet.
+	boolean pendingLine;
+} OutputSink;
+
+/**
+ * Creates a sink that writes into the file descriptor, in blocks of the
+ * given size.
+ */
+OutputSink * createOutputSink(const OutputSinkType type, const int descriptor, const size_t blockSize);
+
+/**
+ * Begins a node nested in the current one (the first node is the root).
+ */
+void beginSinkNode(OutputSink * sink, const char * type);
+
+/**
+ * Adds a property to the node that just began, before any of its children.
+ * Null values are left out.
+ */
+void addSinkProperty(OutputSink * sink, const char * key, const char * value);
+
+/**
+ * Adds a list of properties (e.g. a style) as a single property.
+ */
+void addSinkProperties(OutputSink * sink, const char * key, ParameterList * properties);
+
+/**
+ * Adds text to the current node.
+ */
+void addSinkText(OutputSink * sink, const char * text, const size_t length);
+
+/**
+ * Ends the current node.
+ */
+void endSinkNode(OutputSink * sink);
+
+/**
+ * Drops what the sink hasn't written yet, and empties its file, e.g. if the
+ * compilation failed after some of it was streamed.
+ */
+void discardOutputSink(OutputSink * sink);
+
+/**
+ * Writes out what's pending and releases the sink (but doesn't close its
+ * file). Returns false if its output couldn't be written completely.
+ */
+boolean destroyOutputSink(OutputSink * sink);
+
+#endif
@@ -0,0 +1,220 @@
+#include "StyleSheet.h"
+
+/* MODULE INTERNAL STATE */
+
+static const unsigned int _initialSlots = 64;
+static const char _digits[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+/**
+ * A slot of the hash table: the hash of some declarations, and the position
+ * of their rule in order of addition (or 0 if the slot is empty).
+ */
+typedef struct {
+	size_t hash;
+	unsigned int position;
+} Slot;
+
+struct StyleSheet {
+	StyleRule ** rules;
+	unsigned int count;
+	unsigned int capacity;
+	Slot * slots;
+	// Always a power of 2.
+	unsigned int slotCount;
+	unsigned int firstClass;
+	// The page being counted, from 1.
+	unsigned int page;
+};
+
+/* PRIVATE FUNCTIONS */
+
+static size_t _hashBytes(size_t hash, const char * bytes, const size_t length);
+static size_t _hash(const ParameterList * style, const boolean row);
+static boolean _matches(const StyleRule * rule, const ParameterList * style, const boolean row);
+static unsigned int _findSlot(const StyleSheet * sheet, const ParameterList * style, const boolean row, const size_t hash);
+static void _grow(StyleSheet * sheet);
+
+/**
+ * Continues the FNV-1a hash of some bytes.
+ */
+static size_t _hashBytes(size_t hash, const char * bytes, const size_t length) {
+	for (size_t k = 0; k < length; ++k) {
+		hash = (hash ^ (unsigned char) bytes[k]) * (size_t) 1099511628211ULL;
+	}
+	return hash;
+}
+
+/**
+ * The hash of the declarations of a style, as they're copied into a rule
+ * (the terminators of the keys and values included).
+ */
+static size_t _hash(const ParameterList * style, const boolean row) {
+	size_t hash = (size_t) 14695981039346656037ULL;
+	hash = _hashBytes(hash, row ? "r" : "s", 1);
+	for (const Parameter * p = style ? style->head : NULL; p; p = p->next) {
+		hash = _hashBytes(hash, p->key, p->keyLength + 1);
+		hash = _hashBytes(hash, p->value, p->valueLength + 1);
+	}
+	return hash;
+}
+
+static boolean _matches(const StyleRule * rule, const ParameterList * style, const boolean row) {
+	if (rule->row != row) {
+		return false;
+	}
+	size_t k = 0;
+	for (const Parameter * p = style ? style->head : NULL; p; p = p->next) {
+		if (rule->declarationsLength - k < p->keyLength + p->valueLength + 2
+			|| memcmp(rule->declarations + k, p->key, p->keyLength + 1) != 0
+			|| memcmp(rule->declarations + k + p->keyLength + 1, p->value, p->valueLength + 1) != 0) {
+			return false;
+		}
+		k += p->keyLength + p->valueLength + 2;
+	}
+	return k == rule->declarationsLength;
+}
+
+/**
+ * The slot that holds the rule of the declarations, or the empty slot where
+ * it should go.
+ */
+static unsigned int _findSlot(const StyleSheet * sheet, const ParameterList * style, const boolean row, const size_t hash) {
+	const unsigned int mask = sheet->slotCount - 1;
+	unsigned int k = (unsigned int) hash & mask;
+	for (;;) {
+		const Slot * slot = &sheet->slots[k];
+		if (slot->position == 0) {
+			return k;
+		}
+		if (slot->hash == hash && _matches(sheet->rules[slot->position - 1], style, row)) {
+			return k;
+		}
+		k = (k + 1) & mask;
+	}
+}
+
+/**
+ * Doubles the hash table, so that it's never more than half full.
+ */
+static void _grow(StyleSheet * sheet) {
+	Slot * slots = sheet->slots;
+	const unsigned int slotCount = sheet->slotCount;
+	sheet->slotCount = 2 * slotCount;
+	sheet->slots = calloc(sheet->slotCount, sizeof(Slot));
+	const unsigned int mask = sheet->slotCount - 1;
+	for (unsigned int k = 0; k < slotCount; ++k) {
+		if (slots[k].position == 0) {
+			continue;
+		}
+		unsigned int j = (unsigned int) slots[k].hash & mask;
+		while (sheet->slots[j].position != 0) {
+			j = (j + 1) & mask;
+		}
+		sheet->slots[j] = slots[k];
+	}
+	free(slots);
+}
+
+/**
+ * Creates the rule of some declarations, named after its position.
+ */
+static StyleRule * _newRule(const ParameterList * style, const boolean row, unsigned int position) {
+	StyleRule * rule = calloc(1, sizeof(StyleRule));
+	for (const Parameter * p = style ? style->head : NULL; p; p = p->next) {
+		rule->declarationsLength += p->keyLength + p->valueLength + 2;
+	}
+	rule->declarations = malloc(rule->declarationsLength + 1);
+	size_t k = 0;
+	for (const Parameter * p = style ? style->head : NULL; p; p = p->next) {
+		memcpy(rule->declarations + k, p->key, p->keyLength + 1);
+		k += p->keyLength + 1;
+		memcpy(rule->declarations + k, p->value, p->valueLength + 1);
+		k += p->valueLength + 1;
+	}
+	// Each terminator stands for its colon or semicolon.
+	rule->inlineLength = rule->declarationsLength;
+	rule->row = row;
+	// The digits are written backwards, and then turned around.
+	char digits[sizeof(rule->name)];
+	size_t count = 0;
+	do {
+		digits[count++] = _digits[position % 36];
+		position /= 36;
+	} while (position > 0);
+	rule->name[rule->nameLength++] = 's';
+	while (count > 0) {
+		rule->name[rule->nameLength++] = digits[--count];
+	}
+	rule->name[rule->nameLength] = '\0';
+	return rule;
+}
+
+/* PUBLIC FUNCTIONS */
+
+StyleSheet * createStyleSheet(const unsigned int firstClass) {
+	StyleSheet * sheet = calloc(1, sizeof(StyleSheet));
+	sheet->slotCount = _initialSlots;
+	sheet->slots = calloc(sheet->slotCount, sizeof(Slot));
+	sheet->firstClass = firstClass;
+	sheet->page = 1;
+	return sheet;
+}
+
+void nextStyleSheetPage(StyleSheet * sheet) {
+	++sheet->page;
+}
+
+StyleRule * addStyleRule(StyleSheet * sheet, const ParameterList * style, const boolean row) {
+	const size_t hash = _hash(style, row);
+	const unsigned int k = _findSlot(sheet, style, row, hash);
+	if (sheet->slots[k].position != 0) {
+		StyleRule * rule = sheet->rules[sheet->slots[k].position - 1];
+		++rule->uses;
+		if (rule->lastPage != sheet->page) {
+			rule->lastPage = sheet->page;
+			++rule->pages;
+		}
+		return rule;
+	}
+	if (sheet->count == sheet->capacity) {
+		sheet->capacity = sheet->capacity == 0 ? 16 : 2 * sheet->capacity;
+		sheet->rules = realloc(sheet->rules, sheet->capacity * sizeof(StyleRule *));
+	}
+	StyleRule * rule = _newRule(style, row, sheet->firstClass + sheet->count);
+	rule->uses = 1;
+	rule->pages = 1;
+	rule->lastPage = sheet->page;
+	sheet->rules[sheet->count++] = rule;
+	sheet->slots[k].hash = hash;
+	sheet->slots[k].position = sheet->count;
+	if (2 * sheet->count > sheet->slotCount) {
+		_grow(sheet);
+	}
+	return rule;
+}
+
+StyleRule * findStyleRule(const StyleSheet * sheet, const ParameterList * style, const boolean row) {
+	const Slot * slot = &sheet->slots[_findSlot(sheet, style, row, _hash(style, row))];
+	return slot->position == 0 ? NULL : sheet->rules[slot->position - 1];
+}
+
+unsigned int styleRules(const StyleSheet * sheet) {
+	return sheet->count;
+}
+
+StyleRule * styleRule(const StyleSheet * sheet, const unsigned int k) {
+	return sheet->rules[k];
+}
+
+void destroyStyleSheet(StyleSheet * sheet) {
+	if (sheet == NULL) {
+		return;
+	}
+	for (unsigned int k = 0; k < sheet->count; ++k) {
+		free(sheet->rules[k]->declarations);
+		free(sheet->rules[k]);
+	}
+	free(sheet->slots);
+	free(sheet->rules);
+	free(sheet);
+}
@@ -0,0 +1,78 @@
+#ifndef STYLE_SHEET_HEADER
+#define STYLE_SHEET_HEADER
+
+#include "../../frontend/syntactic-analysis/AbstractSyntaxTree.h"
+#include "../../shared/Type.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * The rule of a class that the styles with the same declarations were
+ * extracted into (see "EXTRACT_STYLES").
+ */
+typedef struct StyleRule {
+	// The declarations, copied as "key\0value\0" pairs.
+	char * declarations;
+	size_t declarationsLength;
+	// Whether it's the style of a row, whose rule starts with its
+	// "display:flex" (so the same declarations make another rule).
+	boolean row;
+	// The generated class name (e.g. "s1f").
+	char name[16];
+	size_t nameLength;
+	// The bytes that its declarations take as they were written, once
+	// separated by colons and semicolons (e.g. "color:red;").
+	size_t inlineLength;
+	// The styles found with its declarations, and the pages where they were
+	// (see "nextStyleSheetPage").
+	size_t uses;
+	unsigned int pages;
+	unsigned int lastPage;
+} StyleRule;
+
+/**
+ * The distinct styles of a program (or of the pages of a site), indexed by
+ * their declarations in an open-addressing hash table. Rules are numbered in
+ * the order they're added, which names their classes.
+ */
+typedef struct StyleSheet StyleSheet;
+
+/**
+ * Creates an empty style sheet, whose first class takes the given number
+ * (so that it doesn't name the classes of another sheet again).
+ */
+StyleSheet * createStyleSheet(const unsigned int firstClass);
+
+/**
+ * Starts counting the rules found in another page.
+ */
+void nextStyleSheetPage(StyleSheet * sheet);
+
+/**
+ * The rule with the declarations of a style (of a row, or not), which is
+ * added if there's none yet. A null style has no declarations.
+ */
+StyleRule * addStyleRule(StyleSheet * sheet, const ParameterList * style, const boolean row);
+
+/**
+ * The rule with the declarations of a style, or NULL.
+ */
+StyleRule * findStyleRule(const StyleSheet * sheet, const ParameterList * style, const boolean row);
+
+/**
+ * The amount of rules.
+ */
+unsigned int styleRules(const StyleSheet * sheet);
+
+/**
+ * The k-th rule, in the order they were added.
+ */
+StyleRule * styleRule(const StyleSheet * sheet, const unsigned int k);
+
+/**
+ * Releases the style sheet (and its rules).
+ */
+void destroyStyleSheet(StyleSheet * sheet);
+
+#endif
@@ -0,0 +1,83 @@
+#include "DefineBodyScanner.h"
+
+/* PRIVATE FUNCTIONS */
+
+static boolean _startsWith(const char * current, const char * end, const char * prefix, const size_t length);
+static const char * _skipUntil(const char * current, const char * end, const char * delimiter, const size_t length, unsigned int * lines);
+
+/**
+ * Checks if the text at "current" starts with the specified prefix.
+ */
+static boolean _startsWith(const char * current, const char * end, const char * prefix, const size_t length) {
+	return (size_t) (end - current) >= length && memcmp(current, prefix, length) == 0;
+}
+
+/**
+ * Advances past the next occurrence of the delimiter, counting line-breaks.
+ * Escaped characters are skipped, so an escaped quote never closes a quoted
+ * value. Returns "end" if the delimiter is never found.
+ */
+static const char * _skipUntil(const char * current, const char * end, const char * delimiter, const size_t length, unsigned int * lines) {
+	while (current < end) {
+		if (_startsWith(current, end, delimiter, length)) {
+			return current + length;
+		}
+		if (*current == '\\' && length == 1 && current + 1 < end) {
+			++current;
+		}
+		if (*current == '\n') {
+			++*lines;
+		}
+		++current;
+	}
+	return end;
+}
+
+/* PUBLIC FUNCTIONS */
+
+DefineBodyScan scanDefineBody(const char * start, const char * end) {
+	DefineBodyScan scan = {
+		.closed = false,
+		.nested = false,
+		.end = end,
+		.lines = 0
+	};
+	const char * current = start;
+	while (current < end) {
+		switch (*current) {
+			case '\n':
+				++scan.lines;
+				++current;
+				break;
+			case '"':
+				current = _skipUntil(current + 1, end, "\"", 1, &scan.lines);
+				break;
+			case '\'':
+				current = _skipUntil(current + 1, end, "'", 1, &scan.lines);
+				break;
+			case '/':
+				if (_startsWith(current, end, "/*", 2)) {
+					current = _skipUntil(current + 2, end, "*/", 2, &scan.lines);
+				}
+				else {
+					++current;
+				}
+				break;
+			case '@':
+				if (_startsWith(current, end, "@enddefine", 10)) {
+					scan.closed = true;
+					scan.end = current;
+					return scan;
+				}
+				if (_startsWith(current, end, "@define", 7)) {
+					scan.nested = true;
+					return scan;
+				}
+				++current;
+				break;
+			default:
+				++current;
+		}
+	}
+	return scan;
+}
@@ -0,0 +1,31 @@
+#ifndef DEFINE_BODY_SCANNER_HEADER
+#define DEFINE_BODY_SCANNER_HEADER
+
+#include "../../shared/Type.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * The result of a cheap scan over the body of a "@define". The body spans
+ * from the scanned position up to (but excluding) the "@enddefine" that
+ * closes it.
+ */
+typedef struct {
+	// Whether the closing "@enddefine" was found before the end of input.
+	boolean closed;
+	// Whether the body contains another "@define" (it can't be deferred).
+	boolean nested;
+	// The byte where the closing "@enddefine" starts.
+	const char * end;
+	// The amount of line-breaks inside the body.
+	unsigned int lines;
+} DefineBodyScan;
+
+/**
+ * Finds the "@enddefine" that closes a body starting at "start", without
+ * tokenizing it. Quoted values, parameters and comments are skipped, so a
+ * "@enddefine" inside them does not close the body.
+ */
+DefineBodyScan scanDefineBody(const char * start, const char * end);
+
+#endif
@@ -19,6 +19,7 @@ void shutdownFlexActionsModule() {
 /* PRIVATE FUNCTIONS */
 
 static void _logLexicalAnalyzerContext(const char * functionName, LexicalAnalyzerContext * lexicalAnalyzerContext);
+static void _releaseContext(LexicalAnalyzerContext * lexicalAnalyzerContext, const boolean keepLexeme);
 
 /**
  * Logs a lexical-analyzer context in DEBUGGING level.
@@ -34,40 +35,59 @@ static void _logLexicalAnalyzerContext(const char * functionName, LexicalAnalyze
 	free(escapedLexeme);
 }
 
+/**
+ * Every lexeme gets a context of its own, which its action releases once
+ * it's done with it (so the memory of the scanner doesn't grow with the
+ * program). A lexeme that became the semantic value of its token belongs to
+ * the parser from then on.
+ */
+static void _releaseContext(LexicalAnalyzerContext * lexicalAnalyzerContext, const boolean keepLexeme) {
+	if (keepLexeme) {
+		lexicalAnalyzerContext->lexeme = NULL;
+	}
+	destroyLexicalAnalyzerContext(lexicalAnalyzerContext);
+}
+
 /* PUBLIC FUNCTIONS */
 
 void BeginMultilineCommentLexemeAction(LexicalAnalyzerContext * lexicalAnalyzerContext) {
 	if (_logIgnoredLexemes) {
 		_logLexicalAnalyzerContext(__FUNCTION__, lexicalAnalyzerContext);
 	}
+	_releaseContext(lexicalAnalyzerContext, false);
 }
 
 void EndMultilineCommentLexemeAction(LexicalAnalyzerContext * lexicalAnalyzerContext) {
 	if (_logIgnoredLexemes) {
 		_logLexicalAnalyzerContext(__FUNCTION__, lexicalAnalyzerContext);
 	}
+	_releaseContext(lexicalAnalyzerContext, false);
 }
 
 void IgnoredLexemeAction(LexicalAnalyzerContext * lexicalAnalyzerContext) {
 	if (_logIgnoredLexemes) {
 		_logLexicalAnalyzerContext(__FUNCTION__, lexicalAnalyzerContext);
 	}
+	_releaseContext(lexicalAnalyzerContext, false);
 }
 
 Token UnknownLexemeAction(LexicalAnalyzerContext * lexicalAnalyzerContext) {
 	_logLexicalAnalyzerContext(__FUNCTION__, lexicalAnalyzerContext);
+	_releaseContext(lexicalAnalyzerContext, false);
 	return UNKNOWN;
 }
 
 Token TagLexemeAction(LexicalAnalyzerContext *ctx, Token token) {
 	_logLexicalAnalyzerContext(__FUNCTION__, ctx);
 	ctx->semanticValue->token = token;
+	_releaseContext(ctx, false);
 	return token;
 }
 
 Token VariableLexemeAction(LexicalAnalyzerContext * ctx) {
 	_logLexicalAnalyzerContext(__FUNCTION__, ctx);
 	ctx->semanticValue->string = ctx->lexeme;
+	_releaseContext(ctx, true);
 	return VARIABLE;
 }
 
@@ -75,6 +95,7 @@ Token VariableLexemeAction(LexicalAnalyzerContext * ctx) {
 Token HeaderLexemeAction(LexicalAnalyzerContext * ctx, Token token) {
 	_logLexicalAnalyzerContext(__FUNCTION__, ctx);
 	ctx->semanticValue->token = token;
+	_releaseContext(ctx, false);
 	return token;
 }
 
@@ -83,30 +104,35 @@ Token OrderedItemLexemeAction(LexicalAnalyzerContext * ctx) {
 	_logLexicalAnalyzerContext(__FUNCTION__, ctx);
 	ctx->lexeme[ctx->length - 1] = '\0';
 	ctx->semanticValue->string = ctx->lexeme;
+	_releaseContext(ctx, true);
 	return ORDERED_ITEM;
 }
 
 Token BulletLexemeAction(LexicalAnalyzerContext * ctx) {
 	_logLexicalAnalyzerContext(__FUNCTION__, ctx);
 	ctx->semanticValue->string = ctx->lexeme;
+	_releaseContext(ctx, true);
 	return BULLET;
 }
 
 Token ListLexemeAction(LexicalAnalyzerContext * ctx, char *text, Token token) {
     _logLexicalAnalyzerContext(__FUNCTION__, ctx);
     ctx->semanticValue->token  = token;
+    _releaseContext(ctx, false);
     return token;
 }
 
 Token StyleLexemeAction(LexicalAnalyzerContext * ctx, Token token) {
 	_logLexicalAnalyzerContext(__FUNCTION__, ctx);
 	ctx->semanticValue->token = token;
+	_releaseContext(ctx, false);
 	return token;
 }
 
 Token ActionLexemeAction(LexicalAnalyzerContext * ctx, Token token) {
 	_logLexicalAnalyzerContext(__FUNCTION__, ctx);
 	ctx->semanticValue->token = token;
+	_releaseContext(ctx, false);
 	return token;
 }
 
@@ -114,42 +140,56 @@ Token ActionLexemeAction(LexicalAnalyzerContext * ctx, Token token) {
 Token ParenthesisLexemeAction(LexicalAnalyzerContext * ctx, Token token) {
 	_logLexicalAnalyzerContext(__FUNCTION__, ctx);
 	ctx->semanticValue->token = token;
+	_releaseContext(ctx, false);
 	return token;
 }
 
 Token ColonLexemeAction(LexicalAnalyzerContext * ctx){
 	_logLexicalAnalyzerContext(__FUNCTION__, ctx);
 	ctx->semanticValue->token = COLON;
+	_releaseContext(ctx, false);
 	return COLON;
 }
 Token CommaLexemeAction(LexicalAnalyzerContext * ctx){
 	_logLexicalAnalyzerContext(__FUNCTION__, ctx);
 	ctx->semanticValue->token = COMMA;
+	_releaseContext(ctx, false);
 	return COMMA;
 }
 
 Token EqualLexemeAction(LexicalAnalyzerContext * ctx){
 	_logLexicalAnalyzerContext(__FUNCTION__, ctx);
 	ctx->semanticValue->token = EQUALS;
+	_releaseContext(ctx, false);
 	return EQUALS;
 }
 
+Token NotEqualLexemeAction(LexicalAnalyzerContext * ctx){
+	_logLexicalAnalyzerContext(__FUNCTION__, ctx);
+	ctx->semanticValue->token = NOT_EQUALS;
+	_releaseContext(ctx, false);
+	return NOT_EQUALS;
+}
+
 
 Token TableLexemeAction(LexicalAnalyzerContext * ctx, Token token) {
 	_logLexicalAnalyzerContext(__FUNCTION__, ctx);
 	ctx->semanticValue->token = token;
+	_releaseContext(ctx, false);
 	return token;
 }
 
 Token QuotedValueLexemeAction(LexicalAnalyzerContext * ctx) {
 	_logLexicalAnalyzerContext(__FUNCTION__, ctx);
 	ctx->semanticValue->string = ctx->lexeme;
+	_releaseContext(ctx, true);
 	return QUOTED_VALUE;
 }
 
 Token QuotedParameterValueLexemeAction(LexicalAnalyzerContext * ctx) {
 	_logLexicalAnalyzerContext(__FUNCTION__, ctx);
 	ctx->semanticValue->string = ctx->lexeme;
+	_releaseContext(ctx, true);
 	return QUOTED_VALUE;
 }
 
@@ -157,6 +197,7 @@ Token QuotedParameterValueLexemeAction(LexicalAnalyzerContext * ctx) {
 Token IdentifierLexemeAction(LexicalAnalyzerContext * ctx) {
 	_logLexicalAnalyzerContext(__FUNCTION__, ctx);
 	ctx->semanticValue->string = ctx->lexeme;
+	_releaseContext(ctx, true);
 	return IDENTIFIER;
 }
 
@@ -164,6 +205,7 @@ Token UnquotedValueLexemeAction(LexicalAnalyzerContext *ctx) {
     _logLexicalAnalyzerContext(__FUNCTION__, ctx);
     ctx->lexeme[ctx->length - 1] = '\0';
     ctx->semanticValue->string = ctx->lexeme;
+    _releaseContext(ctx, true);
     return UNQUOTED_VALUE;
 }
 
@@ -171,5 +213,6 @@ Token UnquotedValueLexemeAction(LexicalAnalyzerContext *ctx) {
 Token NewlineLexemeAction(LexicalAnalyzerContext * ctx) {
 	_logLexicalAnalyzerContext(__FUNCTION__, ctx);
 	ctx->semanticValue->token = NEWLINE;
+	_releaseContext(ctx, false);
 	return NEWLINE;
 }
\ No newline at end of file
@@ -45,6 +45,7 @@ Token ParenthesisLexemeAction(LexicalAnalyzerContext * ctx, Token token);
 Token ColonLexemeAction(LexicalAnalyzerContext * ctx);
 Token CommaLexemeAction(LexicalAnalyzerContext * ctx);
 Token EqualLexemeAction(LexicalAnalyzerContext * ctx);
+Token NotEqualLexemeAction(LexicalAnalyzerContext * ctx);
 Token TableLexemeAction(LexicalAnalyzerContext * ctx, Token token);
 
 Token QuotedValueLexemeAction(LexicalAnalyzerContext * ctx);
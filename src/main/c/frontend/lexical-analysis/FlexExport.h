@@ -1,6 +1,54 @@
 #ifndef FLEX_EXPORT_HEADER
 #define FLEX_EXPORT_HEADER
 
+#include "../../shared/SourceCode.h"
+#include "DefineBodyScanner.h"
+
+/* MODULE INTERNAL STATE */
+
+static SourceCode * _sourceCode = NULL;
+static YY_BUFFER_STATE _sourceCodeBuffer = NULL;
+
+/* PRIVATE FUNCTIONS */
+
+static unsigned int _countLines(const char * start, const char * end);
+static void _dropCurrentBuffer(void);
+static void _resetScanner(const unsigned int line);
+
+/**
+ * Counts the line-breaks between two positions of the source code.
+ */
+static unsigned int _countLines(const char * start, const char * end) {
+	unsigned int lines = 0;
+	for (const char * current = start; current < end; ++current) {
+		if (*current == '\n') {
+			++lines;
+		}
+	}
+	return lines;
+}
+
+/**
+ * Releases the buffer being scanned (never the bytes of the source code), so
+ * the next "yy_scan_*" call can replace it.
+ */
+static void _dropCurrentBuffer(void) {
+	if (YY_CURRENT_BUFFER != NULL) {
+		yy_delete_buffer(YY_CURRENT_BUFFER);
+	}
+}
+
+/**
+ * Drops any partial state of the scanner after switching buffers, so it goes
+ * back to the INITIAL context at the specified line.
+ */
+static void _resetScanner(const unsigned int line) {
+	yylineno = line;
+	BEGIN(INITIAL);
+}
+
+/* PUBLIC FUNCTIONS */
+
 /**
  * Hook that allows to export a static function or variable from the inside of
  * Flex infrastructure, in this case, the current context (a.k.a. start
@@ -10,4 +58,58 @@ unsigned int flexCurrentContext(void) {
 	return YY_START;
 }
 
+/**
+ * Scans the source code in place, instead of reading the standard input.
+ */
+void flexScanSourceCode(SourceCode * sourceCode) {
+	_sourceCode = sourceCode;
+	_sourceCodeBuffer = yy_scan_buffer(sourceCode->bytes, sourceCode->length + 2);
+	yylineno = 1;
+}
+
+/**
+ * Scans the deferred body of a "@define". The parser receives a DEFINE_BODY
+ * token first, so it can tell a body apart from a whole program.
+ */
+void flexScanDefineBody(const char * bytes, const size_t length, const unsigned int line) {
+	_dropCurrentBuffer();
+	_sourceCodeBuffer = NULL;
+	yy_scan_bytes(bytes, length);
+	_resetScanner(line);
+	_startToken = DEFINE_BODY;
+}
+
+/**
+ * Skips the body of the "@define" whose header was just parsed, leaving the
+ * scanner right before the closing "@enddefine". The body is only scanned to
+ * find its end, and its range is stored in the lazy body. If the parser has
+ * already read a lookahead token, the body starts at the end of the previous
+ * token, and the lookahead must be discarded.
+ *
+ * Returns false (and does nothing) if the body can't be deferred: it holds
+ * a nested "@define" that must be visible right away, it is not closed, or
+ * the scanner is not over the source code.
+ */
+boolean flexDeferDefineBody(const boolean hasLookahead, LazyDefineBody * lazyBody) {
+	if (_sourceCodeBuffer == NULL || YY_CURRENT_BUFFER != _sourceCodeBuffer) {
+		return false;
+	}
+	*yy_c_buf_p = yy_hold_char;
+	const char * current = yytext + yyleng;
+	const char * start = hasLookahead ? _previousTokenEnd : current;
+	const char * end = _sourceCode->bytes + _sourceCode->length;
+	const DefineBodyScan scan = scanDefineBody(start, end);
+	if (!scan.closed || scan.nested) {
+		return false;
+	}
+	const unsigned int line = yylineno - _countLines(start, current);
+	lazyBody->offset = start - _sourceCode->bytes;
+	lazyBody->length = scan.end - start;
+	lazyBody->line = line;
+	_dropCurrentBuffer();
+	_sourceCodeBuffer = yy_scan_buffer((char *) scan.end, end - scan.end + 2);
+	_resetScanner(line + scan.lines);
+	return true;
+}
+
 #endif
@@ -4,6 +4,13 @@
 
 static Logger * _logger = NULL;
 
+// The statements waiting to be released. A statement defers its children
+// here instead of releasing them itself, so the tree is released with a heap
+// stack, however deep it nests.
+static Statement ** _pending = NULL;
+static size_t _pendingCount = 0;
+static size_t _pendingCapacity = 0;
+
 void initializeAbstractSyntaxTreeModule() {
 	_logger = createLogger("AbstractSyntxTree");
 }
@@ -12,29 +19,39 @@ void shutdownAbstractSyntaxTreeModule() {
 	if (_logger != NULL) {
 		destroyLogger(_logger);
 	}
+	free(_pending);
+	_pending = NULL;
+	_pendingCount = 0;
+	_pendingCapacity = 0;
 }
 
-/** PUBLIC FUNCTIONS */
+/** PRIVATE FUNCTIONS */
 
-void releaseProgram(Program* program) {
-	logDebugging(_logger, "Executing destructor: %s", __FUNCTION__);
-	if (program != NULL){
-        releaseStatementList(program->statements);
-        free(program);
+static void _defer(Statement* statement) {
+	if (statement == NULL) {
+		return;
+	}
+	if (_pendingCount == _pendingCapacity) {
+		_pendingCapacity = _pendingCapacity == 0 ? 64 : 2 * _pendingCapacity;
+		_pending = realloc(_pending, _pendingCapacity * sizeof(Statement*));
 	}
+	_pending[_pendingCount++] = statement;
 }
 
-void releaseStatementList(StatementList* list) {
+static void _deferList(StatementList* list) {
 	while (list != NULL) {
 		StatementList* next = list->next;
-		releaseStatement(list->statement);
+		_defer(list->statement);
 		free(list);
 		list = next;
 	}
 }
 
-void releaseStatement(Statement* statement) {
-	if (statement == NULL) return;
+/**
+ * Releases everything a statement owns, but its children (which are
+ * deferred).
+ */
+static void _releaseNode(Statement* statement) {
     switch (statement->type) {
 		case STATEMENT_PARAGRAPH:
         case STATEMENT_HEADER1:
@@ -47,24 +64,27 @@ void releaseStatement(Statement* statement) {
             break;
         case STATEMENT_IMAGE:
             releaseParameterList(statement->image->style);
+            free(statement->image->src);
+            free(statement->image->alt);
             free(statement->image);
             break;
         case STATEMENT_BUTTON:
             releaseParameterList(statement->button->style);
             releaseParameterList(statement->button->action);
-            releaseStatementList(statement->button->body);
+            _deferList(statement->button->body);
             free(statement->button);
             break;
         case STATEMENT_CARD:
             releaseParameterList(statement->card->style);
-            releaseStatementList(statement->card->body);
+            _deferList(statement->card->body);
             free(statement->card);
             break;
         case STATEMENT_DEFINE:
             if (statement->define->name) free(statement->define->name);
             releaseParameterList(statement->define->parameters);
             releaseParameterList(statement->define->style);
-            releaseStatementList(statement->define->body);
+            _deferList(statement->define->body);
+            free(statement->define->lazyBody);
             free(statement->define);
             break;
         case STATEMENT_USE:
@@ -86,54 +106,118 @@ void releaseStatement(Statement* statement) {
             break;
         case STATEMENT_FOOTER:
             releaseParameterList(statement->footer->style);
-            releaseStatementList(statement->footer->body);
+            _deferList(statement->footer->body);
             free(statement->footer);
             break;
         case STATEMENT_COLUMN:
             releaseParameterList(statement->column->style);
-            releaseStatementList(statement->column->body);
+            _deferList(statement->column->body);
             free(statement->column);
             break;
         case STATEMENT_ROW:
             releaseParameterList(statement->row->style);
-            releaseStatementList(statement->row->columns);
+            _deferList(statement->row->columns);
             free(statement->row);
             break;
         case STATEMENT_TABLE:
-            releaseTable(statement);
+            releaseParameterList(statement->table->style);
+            for (TableRowList* row = statement->table->rows; row != NULL;) {
+                TableRowList* nextRow = row->next;
+                for (TableCellList* cell = row->row->cells; cell != NULL;) {
+                    TableCellList* nextCell = cell->next;
+                    _deferList(cell->cell->content);
+                    free(cell->cell);
+                    free(cell);
+                    cell = nextCell;
+                }
+                free(row->row);
+                free(row);
+                row = nextRow;
+            }
+            free(statement->table);
             break;
         case STATEMENT_ORDERED_ITEM:
             if (statement->ordered_item->number) free(statement->ordered_item->number);
-            releaseStatement(statement->ordered_item->body);
+            _defer(statement->ordered_item->body);
             free(statement->ordered_item);
             break;
         case STATEMENT_BULLET_ITEM:
-            releaseStatement(statement->bullet_item->body);
+            _defer(statement->bullet_item->body);
             free(statement->bullet_item);
             break;
         case STATEMENT_ORDERED_LIST:
             releaseParameterList(statement->ordered_list->style);
-            releaseStatementList(statement->ordered_list->items);
+            _deferList(statement->ordered_list->items);
             free(statement->ordered_list);
             break;
         case STATEMENT_UNORDERED_LIST:
             releaseParameterList(statement->unordered_list->style);
-            releaseStatementList(statement->unordered_list->items);
+            _deferList(statement->unordered_list->items);
             free(statement->unordered_list);
+            break;
+        case STATEMENT_STATIC_HTML:
+            _defer(statement->static_html->original);
+            releaseStaticRenders(statement->static_html->renders);
+            free(statement->static_html);
+            break;
+        case STATEMENT_EACH:
+            free(statement->each->name);
+            free(statement->each->path);
+            free(statement->each);
+            break;
+        case STATEMENT_CONDITIONAL:
+            free(statement->conditional->parameter);
+            free(statement->conditional->literal);
+            _deferList(statement->conditional->thenBody);
+            _deferList(statement->conditional->elseBody);
+            free(statement->conditional);
             break;
         
 		default:
 			break;
 	}
-
 	free(statement);
 }
 
+/**
+ * Releases the statements deferred until the stack goes back to the given
+ * height.
+ */
+static void _releasePending(const size_t base) {
+	while (_pendingCount > base) {
+		_releaseNode(_pending[--_pendingCount]);
+	}
+}
+
+/** PUBLIC FUNCTIONS */
+
+void releaseProgram(Program* program) {
+	logDebugging(_logger, "Executing destructor: %s", __FUNCTION__);
+	if (program != NULL){
+        releaseStatementList(program->statements);
+        free(program);
+	}
+}
+
+void releaseStatementList(StatementList* list) {
+	const size_t base = _pendingCount;
+	_deferList(list);
+	_releasePending(base);
+}
+
+void releaseStatement(Statement* statement) {
+	const size_t base = _pendingCount;
+	_defer(statement);
+	_releasePending(base);
+}
+
 void releaseParameterList(ParameterList* list) {
     if (!list) return;
     Parameter* current = list->head;
     while (current) {
         Parameter* next = current->next;
+        free(current->key);
+        free(current->value);
         free(current);
         current = next;
     }
@@ -206,3 +290,12 @@ void releaseTableCellContent(TableCell* cell) {
     if (!cell) return;
     releaseStatementList(cell->content);
 }
+
+void releaseStaticRenders(StaticRender* render) {
+    while (render) {
+        StaticRender* next = render->next;
+        free(render->html);
+        free(render);
+        render = next;
+    }
+}
@@ -29,6 +29,9 @@ typedef struct TableRow TableRow;
 typedef struct TableCell TableCell;
 typedef struct TableRowList TableRowList;
 typedef struct TableCellList TableCellList;
+typedef struct StaticHtml StaticHtml;
+typedef struct Conditional Conditional;
+typedef struct Each Each;
 
 struct Program {
     StatementList* statements;
@@ -59,6 +62,9 @@ enum StatementType {
     STATEMENT_TABLE,
     STATEMENT_ORDERED_ITEM,
     STATEMENT_BULLET_ITEM,
+    STATEMENT_STATIC_HTML,
+    STATEMENT_CONDITIONAL,
+    STATEMENT_EACH,
 };
 
 typedef struct Statement {
@@ -80,41 +86,77 @@ typedef struct Statement {
         UnorderedList* unordered_list;
         BulletItem* bullet_item;
         Table* table;
-
+        StaticHtml* static_html;
+        Conditional* conditional;
+        Each* each;
     };
+    // How many nodes it takes to generate it (see "Define"), weighed before a
+    // parallel generation to split the program in tasks of similar size.
+    size_t weight;
 } Statement;
 
 typedef struct Parameter {
     char* key;
     char* value;
+    // Kept so the generator can copy them without looking for the end.
+    size_t keyLength;
+    size_t valueLength;
+    // Whether the value can be written in an attribute without escaping it
+    // (worked out once, when it's parsed; false means it must be scanned).
+    boolean clean;
     struct Parameter* next;
 } Parameter;
 
 typedef struct ParameterList {
     Parameter* head;
+    // The rule of the class that the generator extracted it into, if it's a
+    // style (see "StyleSheet.h").
+    struct StyleRule* rule;
 } ParameterList;
 
+/**
+ * A "@define" body whose parsing was deferred until its first "@use". It is
+ * the byte range of the body inside the source code, and the line where it
+ * starts (for error reporting).
+ */
+typedef struct LazyDefineBody {
+    size_t offset;
+    size_t length;
+    unsigned int line;
+} LazyDefineBody;
+
 typedef struct Define {
     char* name;
     ParameterList* parameters;
     ParameterList* style;
     StatementList* body;
+    LazyDefineBody* lazyBody;
+    // The weight of its body, which every "@use" of it adds to its own.
+    size_t weight;
+    // Its body compiled by the generator, once it's first expanded (see
+    // "Bytecode.h").
+    struct Bytecode* code;
 } Define;
 
 
+// The nodes below know whether their literals can be written without
+// escaping them, so the generator doesn't scan the clean ones again.
 typedef struct Text {
     char* content;
+    boolean clean;
 } Text;
 
 typedef struct Image {
 	char* src;
 	char* alt;
 	ParameterList* style;
+	boolean clean;
 } Image;
 
 typedef struct FormItem {
     char* label;
     char* placeholder;
+    boolean clean;
     struct FormItem* next;
 } FormItem;
 
@@ -127,6 +169,7 @@ typedef struct Form {
 typedef struct NavItem {
     char* label;
     char* link;
+    boolean clean;
     struct NavItem* next;
 } NavItem;
 
@@ -152,8 +195,21 @@ typedef struct Card {
 typedef struct Use {
     char* name;
     ParameterList* parameters;
+    // The define it calls, once the generator has found it.
+    Define* define;
 } Use;
 
+/**
+ * An "@each", that uses a define once per record of a JSON data file (an
+ * array of objects), binding every parameter to the field of the same name.
+ */
+typedef struct Each {
+    char* name;
+    char* path;
+    // The define it expands, once the generator has found it.
+    Define* define;
+} Each;
+
 typedef struct Footer {
     ParameterList* style;
     StatementList* body;
@@ -200,6 +256,7 @@ typedef struct OrderedList {
 
 typedef struct OrderedItem {
     char* number;
+    boolean clean;
     Statement* body;
 } OrderedItem;
 
@@ -213,6 +270,45 @@ typedef struct BulletItem {
     Statement* body;
 } BulletItem;
 
+/**
+ * An "@if" inside a "@define" body, that compares one of its parameters with
+ * a literal. Every "@use" binds the parameters to literals, so the branch is
+ * chosen while the body is expanded, and the other one is never rendered.
+ */
+typedef struct Conditional {
+    char* parameter;
+    char* literal;
+    boolean negated;
+    StatementList* thenBody;
+    StatementList* elseBody;
+} Conditional;
+
+/**
+ * The HTML of a static subtree, already rendered at some indentation level
+ * (or at every level, if the output is minified).
+ */
+typedef struct StaticRender {
+    unsigned int indentation;
+    char* html;
+    size_t length;
+    // The nodes expanded to render it.
+    size_t nodes;
+    // The bytes that minifying it left out, besides the indentation of its
+    // lines (which depends on where it's used).
+    size_t savedBytes;
+    size_t lines;
+    struct StaticRender* next;
+} StaticRender;
+
+/**
+ * A subtree without variables, collapsed by the constant folding pass. The
+ * original subtree is kept, and it's rendered once per indentation level.
+ */
+typedef struct StaticHtml {
+    Statement* original;
+    StaticRender* renders;
+} StaticHtml;
+
 
 
 void initializeAbstractSyntaxTreeModule();
@@ -230,5 +326,6 @@ void releaseTable(Statement* statement);
 void releaseTableRowList(TableRowList* list);
 void releaseTableRow(TableRow* row);
 void releaseTableCellList(TableCellList* list);
+void releaseStaticRenders(StaticRender* render);
 
 #endif
\ No newline at end of file
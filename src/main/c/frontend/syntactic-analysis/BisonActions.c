@@ -3,8 +3,13 @@
 /* MODULE INTERNAL STATE */
 
 static Logger * _logger = NULL;
+static boolean _lazyDefines = false;
+// The defines parsed so far, and when the last top-level statement was.
+static size_t _parsedDefines = 0;
+static size_t _topLevelDefines = 0;
 
 void initializeBisonActionsModule() {
+	_lazyDefines = getBooleanOrDefault("LAZY_DEFINES", _lazyDefines);
 	_logger = createLogger("BisonActions");
 }
 
@@ -17,10 +22,13 @@ void shutdownBisonActionsModule() {
 /** IMPORTED FUNCTIONS */
 
 extern unsigned int flexCurrentContext(void);
+extern boolean flexDeferDefineBody(const boolean hasLookahead, LazyDefineBody * lazyBody);
 
 /* PRIVATE FUNCTIONS */
 
 static void _logSyntacticAnalyzerAction(const char * functionName);
+static boolean _checkConditionals(CompilerState * compilerState, Define * define, StatementList * body);
+static Symbol * _lookupFunction(CompilerState * compilerState, const char * name);
 
 /**
  * Logs a syntactic-analyzer action in DEBUGGING level.
@@ -29,6 +37,86 @@ static void _logSyntacticAnalyzerAction(const char * functionName) {
 	logDebugging(_logger, "%s", functionName);
 }
 
+/**
+ * Finds the define that a "@use" (or an "@each") calls, or NULL if there's
+ * none. A deferred body is parsed once the whole program has been, but it
+ * only sees the defines declared before its own, as if it had been parsed
+ * right away (the symbol table lists the newest symbols first).
+ */
+static Symbol * _lookupFunction(CompilerState * compilerState, const char * name) {
+	Symbol * symbol = compilerState->symbolTable->head;
+	const Define * define = currentLazyDefine();
+	if (define != NULL) {
+		while (symbol != NULL && (symbol->type != SYM_FUN || strcmp(symbol->name, define->name) != 0)) {
+			symbol = symbol->next;
+		}
+		symbol = symbol == NULL ? NULL : symbol->next;
+	}
+	while (symbol != NULL && strcmp(symbol->name, name) != 0) {
+		symbol = symbol->next;
+	}
+	return symbol != NULL && symbol->type == SYM_FUN ? symbol : NULL;
+}
+
+/**
+ * Checks that every "@if" of a define body tests one of its parameters.
+ * Nested defines are checked on their own. The body is walked in pre-order
+ * with an explicit stack of the lists being visited, so it can nest
+ * arbitrarily deep.
+ */
+static boolean _checkConditionals(CompilerState * compilerState, Define * define, StatementList * body) {
+	boolean valid = true;
+	size_t capacity = 64;
+	size_t count = 0;
+	StatementList ** pending = malloc(capacity * sizeof(StatementList *));
+	pending[count++] = body;
+	while (count > 0) {
+		StatementList * it = pending[count - 1];
+		if (it == NULL) {
+			--count;
+			continue;
+		}
+		pending[count - 1] = it->next;
+		Statement * statement = it->statement;
+		if (statement == NULL) {
+			continue;
+		}
+		if (capacity < count + 2) {
+			capacity *= 2;
+			pending = realloc(pending, capacity * sizeof(StatementList *));
+		}
+		switch (statement->type) {
+			case STATEMENT_CONDITIONAL: {
+				Parameter * parameter = define->parameters->head;
+				while (parameter != NULL && strcmp(parameter->key, statement->conditional->parameter) != 0) {
+					parameter = parameter->next;
+				}
+				if (parameter == NULL) {
+					addUnknownConditionParameterError(compilerState->errorManager, define->name, statement->conditional->parameter);
+					compilerState->succeed = false;
+					valid = false;
+				}
+				pending[count++] = statement->conditional->elseBody;
+				pending[count++] = statement->conditional->thenBody;
+				break;
+			}
+			case STATEMENT_FOOTER:
+				pending[count++] = statement->footer->body;
+				break;
+			case STATEMENT_ROW:
+				pending[count++] = statement->row->columns;
+				break;
+			case STATEMENT_COLUMN:
+				pending[count++] = statement->column->body;
+				break;
+			default:
+				break;
+		}
+	}
+	free(pending);
+	return valid;
+}
+
 /* PUBLIC FUNCTIONS */
 
 
@@ -59,6 +147,21 @@ StatementList* appendStatementToList(StatementList* list, Statement* stmt) {
     return head;
 }
 
+/**
+ * Hands a top-level statement to the compiler state to be streamed, and
+ * only appends it if it's kept. A statement that holds a define (or is one)
+ * is never released, because the generator keeps referring to the define.
+ */
+StatementList* TopLevelStatementSemanticAction(CompilerState* compilerState, StatementList* list, Statement* stmt) {
+    const boolean holdsDefines = _parsedDefines != _topLevelDefines;
+    _topLevelDefines = _parsedDefines;
+    if (stmt != NULL && compilerState->succeed && compilerState->streamStatement != NULL
+            && compilerState->streamStatement(compilerState, stmt, !holdsDefines)) {
+        return list;
+    }
+    return list == NULL ? createSingleStatementList(stmt) : appendStatementToList(list, stmt);
+}
+
 ParameterList* createParameterList() {
     ParameterList* list = calloc(1, sizeof(ParameterList));
     return list;
@@ -68,6 +171,9 @@ void appendParameter(ParameterList* list, char* key, char* value) {
     Parameter* param = calloc(1, sizeof(Parameter));
     param->key = key;
     param->value = value;
+    param->keyLength = key ? strlen(key) : 0;
+    param->valueLength = value ? strlen(value) : 0;
+    param->clean = isHtmlClean(value, ATTRIBUTE_CONTEXT);
     param->next = NULL;
 
     if (list->head == NULL) {
@@ -80,8 +186,13 @@ void appendParameter(ParameterList* list, char* key, char* value) {
     }
 }
 
-Statement* DefineSemanticAction(CompilerState *st, char* name, ParameterList* parameters, ParameterList* style, StatementList* body){
+Statement* DefineSemanticAction(CompilerState *st, char* name, ParameterList* parameters, ParameterList* style, LazyDefineBody* lazyBody, StatementList* body){
     _logSyntacticAnalyzerAction("DefineSemanticAction");
+    if (lazyBody == NULL && body == NULL) {
+        addEmptyDefineBodyError(st->errorManager, name);
+        st->succeed = false;
+        return NULL;
+    }
     if (parameters == NULL) {
         parameters = createParameterList();
     }
@@ -104,6 +215,12 @@ Statement* DefineSemanticAction(CompilerState *st, char* name, ParameterList* pa
     define->parameters = parameters;
     define->style      = style;
     define->body       = body;
+    define->lazyBody   = lazyBody;
+    _checkConditionals(st, define, body);
+    ++_parsedDefines;
+    if (lazyBody != NULL) {
+        registerLazyDefine(define);
+    }
 
     Statement* stmt = calloc(1, sizeof(Statement));
     stmt->type   = STATEMENT_DEFINE;
@@ -111,9 +228,40 @@ Statement* DefineSemanticAction(CompilerState *st, char* name, ParameterList* pa
     return stmt;
 }
 
+LazyDefineBody* LazyDefineBodySemanticAction(CompilerState* compilerState, const boolean hasLookahead) {
+    _logSyntacticAnalyzerAction("LazyDefineBodySemanticAction");
+    if (!_lazyDefines) {
+        return NULL;
+    }
+    LazyDefineBody* lazyBody = calloc(1, sizeof(LazyDefineBody));
+    if (!flexDeferDefineBody(hasLookahead, lazyBody)) {
+        free(lazyBody);
+        return NULL;
+    }
+    logDebugging(_logger, "Deferred define body: %zu bytes at line %u.", lazyBody->length, lazyBody->line);
+    return lazyBody;
+}
+
+Program* DefineBodySemanticAction(CompilerState* compilerState, StatementList* body) {
+    _logSyntacticAnalyzerAction("DefineBodySemanticAction");
+    if (body == NULL) {
+        addEmptyDefineBodyError(compilerState->errorManager, currentLazyDefine()->name);
+        compilerState->succeed = false;
+        return NULL;
+    }
+    currentLazyDefine()->body = body;
+    _checkConditionals(compilerState, currentLazyDefine(), body);
+    if (flexCurrentContext() != 0) {
+        logError(_logger, "The final context is not the default(0): %d", flexCurrentContext());
+        compilerState->succeed = false;
+    }
+    return NULL;
+}
+
 Statement* HeaderSemanticAction(char* value, int level) {
     Text* t = calloc(1, sizeof(Text));
     t->content = value;
+    t->clean = isHtmlClean(value, TEXT_CONTEXT);
     Statement* s = calloc(1, sizeof(Statement));
     switch (level) {
       case 1: s->type = STATEMENT_HEADER1; break;
@@ -127,6 +275,7 @@ Statement* HeaderSemanticAction(char* value, int level) {
 Statement* ParagraphSemanticAction(char* value) {
     Text* t = calloc(1, sizeof(Text));
     t->content = value;
+    t->clean = isHtmlClean(value, TEXT_CONTEXT);
     Statement* s = calloc(1, sizeof(Statement));
     s->type = STATEMENT_PARAGRAPH;
     s->text = t;
@@ -139,6 +288,7 @@ Statement* ParagraphVariableSemanticAction(CompilerState* st, char* variableName
     if (st->inDefineBody) {
         Text* t = calloc(1, sizeof(Text));
         t->content = variableName;
+        t->clean = isHtmlClean(variableName, TEXT_CONTEXT);
         Statement* s = calloc(1, sizeof(Statement));
         s->type = STATEMENT_PARAGRAPH;
         s->text = t;
@@ -154,6 +304,7 @@ Statement* ParagraphVariableSemanticAction(CompilerState* st, char* variableName
 
     Text* t = calloc(1, sizeof(Text));
     t->content = val;   
+    t->clean = isHtmlClean(val, TEXT_CONTEXT);
     Statement* s = calloc(1, sizeof(Statement));
     logDebugging(_logger, "ParagraphVariable: name=\"%s\" → value=\"%s\"", variableName, val);
     s->type = STATEMENT_PARAGRAPH;
@@ -169,6 +320,7 @@ Statement* ImageSemanticAction(ParameterList* style, char* src, char* alt) {
     image->style = style;
     image->src = src;
     image->alt = alt;
+    image->clean = isHtmlClean(src, ATTRIBUTE_CONTEXT) && isHtmlClean(alt, ATTRIBUTE_CONTEXT);
 
     Statement* stmt = calloc(1, sizeof(Statement));
     stmt->type = STATEMENT_IMAGE;
@@ -213,8 +365,8 @@ Statement* CardSemanticAction(ParameterList* style, StatementList* body) {
 Statement* UseSemanticAction(CompilerState *st, char* name, ParameterList* parameters) {
     _logSyntacticAnalyzerAction("UseSemanticAction");
 
-    Symbol* funEntry = symbolTableLookup(st->symbolTable, name);
-    if (!funEntry || funEntry->type != SYM_FUN) {
+    Symbol* funEntry = _lookupFunction(st, name);
+    if (!funEntry) {
         useUndefinedFunction(st->errorManager, name);
         st->succeed = false;
         return NULL;
@@ -271,6 +423,7 @@ FormItem* FormItemSemanticAction(char* label, char* placeholder) {
     FormItem* item = calloc(1, sizeof(FormItem));
     item->label = label;
     item->placeholder = placeholder;
+    item->clean = isHtmlClean(label, TEXT_CONTEXT) && isHtmlClean(placeholder, ATTRIBUTE_CONTEXT);
     return item;
 }
 
@@ -297,6 +450,7 @@ NavItem* NavItemSemanticAction(char* label, char* link) {
     NavItem* item = calloc(1, sizeof(NavItem));
     item->label = label;
     item->link = link;
+    item->clean = isHtmlClean(label, TEXT_CONTEXT) && isHtmlClean(link, ATTRIBUTE_CONTEXT);
     return item;
 }
 
@@ -436,6 +590,7 @@ Statement* OrderedListSemanticAction(CompilerState* st ,ParameterList* style, St
 Statement* OrderedItemSemanticAction(char* number, Statement* body) {
     OrderedItem* item = calloc(1, sizeof(OrderedItem));
     item->number = number;
+    item->clean = isHtmlClean(number, ATTRIBUTE_CONTEXT);
     item->body = body;
 
     Statement* stmt = calloc(1, sizeof(Statement));
@@ -484,3 +639,45 @@ Statement* HeaderVariableSemanticAction(CompilerState* st, char* variableName, i
     return HeaderSemanticAction(val, level);
 }
 
+Statement* EachSemanticAction(CompilerState *st, char* name, char* keyword, char* path) {
+    _logSyntacticAnalyzerAction("EachSemanticAction");
+    if (strcmp(keyword, "in") != 0) {
+        addInvalidEachError(st->errorManager, name, keyword);
+        st->succeed = false;
+        return NULL;
+    }
+    free(keyword);
+    Symbol* funEntry = _lookupFunction(st, name);
+    if (!funEntry) {
+        useUndefinedFunction(st->errorManager, name);
+        st->succeed = false;
+        return NULL;
+    }
+    Each* each = calloc(1, sizeof(Each));
+    each->name = name;
+    each->path = path;
+
+    Statement* stmt = calloc(1, sizeof(Statement));
+    stmt->type = STATEMENT_EACH;
+    stmt->each = each;
+    return stmt;
+}
+
+Statement* ConditionalSemanticAction(CompilerState *st, char* parameter, const boolean negated, char* literal, StatementList* thenBody, StatementList* elseBody) {
+    _logSyntacticAnalyzerAction("ConditionalSemanticAction");
+    if (!st->inDefineBody) {
+        addConditionalOutsideDefineError(st->errorManager, parameter);
+        st->succeed = false;
+    }
+    Conditional* conditional = calloc(1, sizeof(Conditional));
+    conditional->parameter = parameter;
+    conditional->literal   = literal;
+    conditional->negated   = negated;
+    conditional->thenBody  = thenBody;
+    conditional->elseBody  = elseBody;
+
+    Statement* stmt = calloc(1, sizeof(Statement));
+    stmt->type        = STATEMENT_CONDITIONAL;
+    stmt->conditional = conditional;
+    return stmt;
+}
@@ -2,6 +2,8 @@
 #define BISON_ACTIONS_HEADER
 
 #include "../../shared/CompilerState.h"
+#include "../../shared/Environment.h"
+#include "../../shared/HtmlEscape.h"
 #include "../../shared/Logger.h"
 #include "../../shared/symbol-table/symbolTable.h"
 #include "AbstractSyntaxTree.h"
@@ -23,6 +25,7 @@ void appendParameter(ParameterList* list, char* key, char* value);
 
 StatementList* createSingleStatementList(Statement* stmt);
 StatementList* appendStatementToList(StatementList* list, Statement* stmt);
+StatementList* TopLevelStatementSemanticAction(CompilerState* compilerState, StatementList* list, Statement* stmt);
 
 
 Statement* HeaderSemanticAction(char* value, int level);
@@ -35,10 +38,16 @@ Statement* ButtonSemanticAction(ParameterList* style, ParameterList* action, Sta
 
 Statement* CardSemanticAction(ParameterList* style, StatementList* body);
 
-Statement* DefineSemanticAction(CompilerState *st, char* name, ParameterList* parameters, ParameterList* style, StatementList* body);
+Statement* DefineSemanticAction(CompilerState *st, char* name, ParameterList* parameters, ParameterList* style, LazyDefineBody* lazyBody, StatementList* body);
+LazyDefineBody* LazyDefineBodySemanticAction(CompilerState* compilerState, const boolean hasLookahead);
+Program* DefineBodySemanticAction(CompilerState* compilerState, StatementList* body);
 
 Statement* UseSemanticAction(CompilerState *st, char* name, ParameterList* parameters);
 
+Statement* EachSemanticAction(CompilerState *st, char* name, char* keyword, char* path);
+
+Statement* ConditionalSemanticAction(CompilerState *st, char* parameter, const boolean negated, char* literal, StatementList* thenBody, StatementList* elseBody);
+
 
 FormItem* FormItemSemanticAction(char* label, char* placeholder);
 FormItem* appendFormItem(FormItem* list, FormItem* newItem);
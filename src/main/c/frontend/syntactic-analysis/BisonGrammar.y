@@ -1,5 +1,10 @@
 %{
 #include "BisonActions.h"
+#include "../../shared/ResourceGovernor.h"
+
+// The stacks of the parser are grown on the heap (by doubling) up to this
+// many states, so programs can nest far deeper than the default of Bison.
+#define YYMAXDEPTH ((YYPTRDIFF_T) maximumParserDepth())
 %}
 
 %define api.value.union.name SemanticValue
@@ -20,11 +25,14 @@
     struct TableCell* table_cell;
     struct TableRowList* table_row_list;
     struct TableCellList* table_cell_list;
+    struct LazyDefineBody* lazy_define_body;
 }
 
 %token <token> DEFINE USE FORM IMG FOOTER ROW COLUMN NAV ITEM END END_DEFINE BUTTON CARD LIST_BEGIN TABLE_BEGIN
 %token <token> OPEN_PAREN CLOSE_PAREN OPEN_BRACE CLOSE_BRACE COLON COMMA OPEN_BRACKET CLOSE_BRACKET PIPE 
 %token <token> NEWLINE HEADER_1 HEADER_2 HEADER_3
+%token <token> DEFINE_BODY
+%token <token> IF ELSE NOT_EQUALS EACH
 
 %token <token>  UNKNOWN EQUALS
 
@@ -34,7 +42,10 @@
 
 %type <program> program
 %type <statement> statement 
-%type <statement_list> statement_list content maybe_content column_list unordered_list_items ordered_list_items 
+%type <statement_list> program_statements statement_list content maybe_content column_list unordered_list_items ordered_list_items 
+%type <statement_list> define_body conditional_body maybe_else
+%type <token> comparison
+%type <lazy_define_body> lazy_define_body
 
 %type <parameter_list> style_parameters action_parameters
 %type <parameter_list> style_parameter_list identifier_list parameters use_parameters use_parameter_list
@@ -57,6 +68,8 @@
 %type <statement> table
 %type <statement> ordered_list
 %type <statement> unordered_list
+%type <statement> conditional
+%type <statement> each
 
 %type <table_row_list> table_row_list
 %type <table_row> table_row
@@ -67,9 +80,16 @@
 
 program:
       /* vacío */ { $$ = StatementSemanticAction(currentCompilerState(), NULL); }
-    | statement_list  { $$ = StatementSemanticAction(currentCompilerState(), $1); }
+    | program_statements  { $$ = StatementSemanticAction(currentCompilerState(), $1); }
+    | DEFINE_BODY define_body { $$ = DefineBodySemanticAction(currentCompilerState(), $2); }
 ;
 
+/* The top-level statements, which can be streamed as soon as they're reduced. */
+program_statements:
+    statement { $$ = TopLevelStatementSemanticAction(currentCompilerState(), NULL, $1); }
+  | program_statements statement { $$ = TopLevelStatementSemanticAction(currentCompilerState(), $1, $2); }
+  ;
+
 
 statement_list:
     statement { $$ = createSingleStatementList($1); }
@@ -91,16 +111,56 @@ statement:
     | table { $$ = $1; }
     | ordered_list { $$ = $1; }
     | unordered_list { $$ = $1; }
+    | conditional { $$ = $1; }
+    | each { $$ = $1; }
 ;
 
 define:
-    DEFINE IDENTIFIER maybe_parameters maybe_style statement_list END_DEFINE
+    DEFINE IDENTIFIER maybe_parameters maybe_style lazy_define_body define_body END_DEFINE
     {
         $$ = DefineSemanticAction(
-                currentCompilerState(), $2, $3, $4, $5);
+                currentCompilerState(), $2, $3, $4, $5, $6);
+    }
+;
+
+/* Skips the body when lazy parsing is enabled, discarding the lookahead. */
+lazy_define_body:
+    /* vacío */ {
+        $$ = LazyDefineBodySemanticAction(currentCompilerState(), yychar != YYEMPTY);
+        if ($$ != NULL) {
+            yyclearin;
+        }
+    }
+;
+
+define_body:
+      /* vacío */ { $$ = NULL; }
+    | statement_list { $$ = $1; }
+;
+
+
+conditional:
+    IF OPEN_PAREN IDENTIFIER comparison QUOTED_VALUE CLOSE_PAREN conditional_body maybe_else END
+    {
+        $$ = ConditionalSemanticAction(
+                currentCompilerState(), $3, $4 == NOT_EQUALS, $5, $7, $8);
     }
 ;
 
+comparison:
+      EQUALS { $$ = EQUALS; }
+    | NOT_EQUALS { $$ = NOT_EQUALS; }
+;
+
+conditional_body:
+      /* vacío */ { $$ = NULL; }
+    | statement_list { $$ = $1; }
+;
+
+maybe_else:
+      /* vacío */ { $$ = NULL; }
+    | ELSE conditional_body { $$ = $2; }
+;
 
 maybe_parameters:
       /* vacío */ { $$ = createParameterList(); }
@@ -162,6 +222,13 @@ use_parameter_list:
 ;
 
 
+each:
+    EACH IDENTIFIER IDENTIFIER QUOTED_VALUE {
+        $$ = EachSemanticAction(currentCompilerState(), $2, $3, $4);
+    }
+;
+
+
 form:
     FORM maybe_style maybe_action form_item_list END {
         $$ = FormSemanticAction($2, $3, $4);
@@ -4,9 +4,15 @@
 /* MODULE INTERNAL STATE */
 
 static CompilerState * _currentCompilerState = NULL;
+static Define * _currentLazyDefine = NULL;
+static Define ** _lazyDefines = NULL;
+static unsigned int _lazyDefinesCount = 0;
+static unsigned int _lazyDefinesCapacity = 0;
 static Logger * _logger = NULL;
+static boolean _strictDefines = false;
 
 void initializeSyntacticAnalyzerModule() {
+	_strictDefines = getBooleanOrDefault("STRICT_DEFINES", _strictDefines);
 	_logger = createLogger("SyntacticAnalyzer");
 }
 
@@ -14,11 +20,17 @@ void shutdownSyntacticAnalyzerModule() {
 	if (_logger != NULL) {
 		destroyLogger(_logger);
 	}
+	free(_lazyDefines);
+	_lazyDefines = NULL;
+	_lazyDefinesCount = 0;
+	_lazyDefinesCapacity = 0;
 }
 
 /** IMPORTED FUNCTIONS */
 
 extern LexicalAnalyzerContext * createLexicalAnalyzerContext();
+extern void flexScanSourceCode(SourceCode * sourceCode);
+extern void flexScanDefineBody(const char * bytes, const size_t length, const unsigned int line);
 
 /**
  * Bison exported functions.
@@ -40,19 +52,17 @@ void yyerror(const char * string) {
 	destroyLexicalAnalyzerContext(lexicalAnalyzerContext); //agregando esto frenan los leaks
 }
 
-/* PUBLIC FUNCTIONS */
+/* PRIVATE FUNCTIONS */
 
-CompilerState * currentCompilerState() {
-	return _currentCompilerState;
-}
+static SyntacticAnalysisStatus _toSyntacticAnalysisStatus(CompilerState * compilerState, const int code);
+static SyntacticAnalysisStatus _parseLazyDefineBodies(CompilerState * compilerState);
 
-SyntacticAnalysisStatus parse(CompilerState * compilerState) {
-	logDebugging(_logger, "Parsing...");
-	_currentCompilerState = compilerState;
-	const int code = yyparse();
-	_currentCompilerState = NULL;
+/**
+ * Maps the code returned by Bison to an analysis status. Any status other
+ * than ACCEPT marks the compilation as failed.
+ */
+static SyntacticAnalysisStatus _toSyntacticAnalysisStatus(CompilerState * compilerState, const int code) {
 	SyntacticAnalysisStatus syntacticAnalysisStatus;
-	logDebugging(_logger, "Parsing is done.");
 	switch (code) {
 		case 0:
 			if (compilerState->succeed == true) {
@@ -75,3 +85,69 @@ SyntacticAnalysisStatus parse(CompilerState * compilerState) {
 	compilerState->succeed = false;
 	return syntacticAnalysisStatus;
 }
+
+/**
+ * In strict mode, every deferred body is parsed right after the program, so
+ * errors inside "@define"s that are never used are still reported.
+ */
+static SyntacticAnalysisStatus _parseLazyDefineBodies(CompilerState * compilerState) {
+	for (unsigned int k = 0; k < _lazyDefinesCount; ++k) {
+		const SyntacticAnalysisStatus status = parseLazyDefineBody(compilerState, _lazyDefines[k]);
+		if (status != ACCEPT) {
+			return status;
+		}
+	}
+	return ACCEPT;
+}
+
+/* PUBLIC FUNCTIONS */
+
+CompilerState * currentCompilerState() {
+	return _currentCompilerState;
+}
+
+Define * currentLazyDefine() {
+	return _currentLazyDefine;
+}
+
+void registerLazyDefine(Define * define) {
+	if (_lazyDefinesCount == _lazyDefinesCapacity) {
+		_lazyDefinesCapacity = _lazyDefinesCapacity == 0 ? 16 : 2 * _lazyDefinesCapacity;
+		_lazyDefines = realloc(_lazyDefines, _lazyDefinesCapacity * sizeof(Define *));
+	}
+	_lazyDefines[_lazyDefinesCount++] = define;
+}
+
+SyntacticAnalysisStatus parse(CompilerState * compilerState) {
+	logDebugging(_logger, "Parsing...");
+	_currentCompilerState = compilerState;
+	if (compilerState->sourceCode != NULL) {
+		flexScanSourceCode(compilerState->sourceCode);
+	}
+	const int code = yyparse();
+	_currentCompilerState = NULL;
+	logDebugging(_logger, "Parsing is done.");
+	const SyntacticAnalysisStatus status = _toSyntacticAnalysisStatus(compilerState, code);
+	if (status == ACCEPT && _strictDefines) {
+		return _parseLazyDefineBodies(compilerState);
+	}
+	return status;
+}
+
+SyntacticAnalysisStatus parseLazyDefineBody(CompilerState * compilerState, Define * define) {
+	if (define->lazyBody == NULL || define->body != NULL) {
+		return ACCEPT;
+	}
+	logDebugging(_logger, "Parsing the body of \"%s\"...", define->name);
+	const LazyDefineBody * lazyBody = define->lazyBody;
+	const boolean inDefineBody = compilerState->inDefineBody;
+	_currentCompilerState = compilerState;
+	_currentLazyDefine = define;
+	compilerState->inDefineBody = true;
+	flexScanDefineBody(compilerState->sourceCode->bytes + lazyBody->offset, lazyBody->length, lazyBody->line);
+	const int code = yyparse();
+	compilerState->inDefineBody = inDefineBody;
+	_currentLazyDefine = NULL;
+	_currentCompilerState = NULL;
+	return _toSyntacticAnalysisStatus(compilerState, code);
+}
@@ -2,7 +2,9 @@
 #define SYNTACTIC_ANALYZER_HEADER
 
 #include "../../shared/CompilerState.h"
+#include "../../shared/Environment.h"
 #include "../../shared/Logger.h"
+#include "AbstractSyntaxTree.h"
 
 /** Bison imported functions. */
 
@@ -29,9 +31,28 @@ typedef enum {
  */
 CompilerState * currentCompilerState();
 
+/**
+ * Retrieves the "@define" whose body is being parsed by
+ * "parseLazyDefineBody", or NULL outside of that parse.
+ */
+Define * currentLazyDefine();
+
+/**
+ * Records a "@define" whose body was deferred, so that the strict mode can
+ * validate it even if it is never used.
+ */
+void registerLazyDefine(Define * define);
+
 /**
  * Executes the parsing phase of the compiler.
  */
 SyntacticAnalysisStatus parse(CompilerState * compilerState);
 
+/**
+ * Parses the deferred body of a "@define" (see LAZY_DEFINES), caching the
+ * resulting statements in the node itself. Does nothing if the body was
+ * already parsed.
+ */
+SyntacticAnalysisStatus parseLazyDefineBody(CompilerState * compilerState, Define * define);
+
 #endif
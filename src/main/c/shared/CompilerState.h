@@ -4,6 +4,7 @@
 #include "Type.h"
 #include "symbol-table/symbolTable.h"
 #include "ErrorManager.h"
+#include "SourceCode.h"
 
 /**
  * The general status of a compilation.
@@ -26,11 +27,20 @@ typedef struct CompilerState{
 
 	bool inDefineBody;
 
+	// The complete input program (lazy "@define" bodies refer to it).
+	SourceCode * sourceCode;
+
 	SymbolTable * symbolTable;
 
 	// The computed value of the entire program (only for the calculator).
 	int value;
 	ErrorManager* errorManager;
+
+	// Called with every top-level statement as soon as it's parsed (if set),
+	// so it can be generated before the rest of the program. It can release
+	// the statement if told so, and returns whether it did (otherwise, the
+	// statement is kept in the AST).
+	boolean (*streamStatement)(struct CompilerState * compilerState, void * statement, const boolean release);
 } CompilerState;
 
 #endif
@@ -15,6 +15,38 @@ const boolean getBooleanOrDefault(const char * name, const boolean defaultValue)
 	}
 }
 
+const size_t getSizeOrDefault(const char * name, const size_t defaultValue) {
+	const char * value = getStringOrDefault(name, NULL);
+	if (value == NULL || *value < '0' || '9' < *value) {
+		return defaultValue;
+	}
+	char * end = NULL;
+	const unsigned long long size = strtoull(value, &end, 10);
+	if (*end != '\0') {
+		return defaultValue;
+	}
+	return (size_t) size;
+}
+
+void exportArgumentsToEnvironment(const int count, const char ** arguments) {
+	for (int k = 1; k < count; ++k) {
+		const char * argument = arguments[k];
+		if (strncmp(argument, "--", 2) != 0 || argument[2] == '\0') {
+			continue;
+		}
+		argument += 2;
+		const char * separator = strchr(argument, '=');
+		const size_t length = separator == NULL ? strlen(argument) : (size_t) (separator - argument);
+		char * name = calloc(length + 1, sizeof(char));
+		for (size_t i = 0; i < length; ++i) {
+			const char c = argument[i];
+			name[i] = c == '-' ? '_' : ('a' <= c && c <= 'z' ? c - 'a' + 'A' : c);
+		}
+		setenv(name, separator == NULL ? "true" : separator + 1, 1);
+		free(name);
+	}
+}
+
 const char * getStringOrDefault(const char * name, const char * defaultValue) {
 	const char * value = getenv(name);
 	if (value == NULL) {
@@ -12,6 +12,21 @@
  */
 const boolean getBooleanOrDefault(const char * name, const boolean defaultValue);
 
+/**
+ * Analog to "getStringOrDefault", but parsing the value as a non-negative
+ * decimal integer. The default value is used when the variable is undefined
+ * or does not hold a valid number.
+ */
+const size_t getSizeOrDefault(const char * name, const size_t defaultValue);
+
+/**
+ * Turns every command-line option "--some-option=value" into the environment
+ * variable "SOME_OPTION" (with the value "true" if there's none), so that any
+ * variable can also be set from the command-line (e.g. "--minify"). Other
+ * arguments are ignored.
+ */
+void exportArgumentsToEnvironment(const int count, const char ** arguments);
+
 /**
  * Gets the value of an environment variable by name, or returns a default
  * value if the variable is undefined.
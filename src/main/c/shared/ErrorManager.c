@@ -2,9 +2,14 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <pthread.h>
+
+// Errors can be reported from the threads of a parallel generation.
+static pthread_mutex_t _lock = PTHREAD_MUTEX_INITIALIZER;
 
 
 static void newErrorNode(ErrorManager* em, ErrorType type, char * msg, printErrorFunction errorFunction);
+static void appendErrorNode(ErrorManager* em, ErrorType type, char * msg, printErrorFunction errorFunction);
 static void printErrorExistsFunction(int errorNumber, ErrorNode* node);
 static void printErrorUndifinedVariable(int errorNumber, ErrorNode* node);
 static void printErrorExistsVariable(int errorNumber, ErrorNode* node);
@@ -12,12 +17,35 @@ static void printErrorUndifinedFunction(int errorNumber, ErrorNode* node);
 static void printErrorExistsFunction(int errorNumber, ErrorNode* node);
 static void printErrorTooManyArgs(int errNo, ErrorNode* node);
 static void printErrorTooFewArgs(int errNo, ErrorNode* node);
+static void printErrorEmptyDefineBody(int errNo, ErrorNode* node);
+static void printErrorResourceLimit(int errNo, ErrorNode* node);
+static void printErrorInvalidEach(int errNo, ErrorNode* node);
+static void printErrorInvalidDataFile(int errNo, ErrorNode* node);
+static void printErrorConditionalOutsideDefine(int errNo, ErrorNode* node);
+static void printErrorUnknownConditionParameter(int errNo, ErrorNode* node);
+static void printErrorTooManyErrors(int errNo, ErrorNode* node);
 
 ErrorManager * newErrorManager(){
     return calloc(1,sizeof(ErrorManager));
 }
 
-static void newErrorNode(ErrorManager* em, ErrorType type, char * msg, printErrorFunction errorFunction){
+static void appendErrorNode(ErrorManager* em, ErrorType type, char * msg, printErrorFunction errorFunction){
+    if(em->maximumErrors > 0 && em->errorCount >= em->maximumErrors){
+        if(em->last == NULL || em->last->type != TOO_MANY_ERRORS){
+            char buf[16];
+            snprintf(buf, sizeof(buf), "%d", em->maximumErrors);
+            ErrorNode * limitNode = calloc(1, sizeof(ErrorNode));
+            if(limitNode != NULL){
+                limitNode->msg = strdup(buf);
+                limitNode->type = TOO_MANY_ERRORS;
+                limitNode->printError = printErrorTooManyErrors;
+                em->last->next = limitNode;
+                em->last = limitNode;
+            }
+        }
+        free(msg);
+        return;
+    }
     ErrorNode * newNode = malloc(sizeof(ErrorNode));
     if(newNode == NULL){
         return;
@@ -32,10 +60,17 @@ static void newErrorNode(ErrorManager* em, ErrorType type, char * msg, printErro
         em->last = newNode;
     }else{
         em->last->next = newNode;
+        em->last = newNode;
     }
     em->errorCount += 1;
 }
 
+static void newErrorNode(ErrorManager* em, ErrorType type, char * msg, printErrorFunction errorFunction){
+    pthread_mutex_lock(&_lock);
+    appendErrorNode(em, type, msg, errorFunction);
+    pthread_mutex_unlock(&_lock);
+}
+
 static void printError(int errorNumber, ErrorNode* node){
     static char* messages[] = {
         "Undefined variable.",
@@ -90,6 +125,41 @@ static void printErrorTooFewArgs(int errNo, ErrorNode* node) {
     return;
 }
 
+static void printErrorEmptyDefineBody(int errNo, ErrorNode* node) {
+    printf("[Error %d]: Function \"%s\" has an empty body.\n", errNo, node->msg);
+    return;
+}
+
+static void printErrorConditionalOutsideDefine(int errNo, ErrorNode* node) {
+    printf("[Error %d]: Condition on \"%s\" outside of a function body.\n", errNo, node->msg);
+    return;
+}
+
+static void printErrorUnknownConditionParameter(int errNo, ErrorNode* node) {
+    printf("[Error %d]: Condition on an unknown parameter: %s.\n", errNo, node->msg);
+    return;
+}
+
+static void printErrorInvalidEach(int errNo, ErrorNode* node) {
+    printf("[Error %d]: Invalid iteration: %s.\n", errNo, node->msg);
+    return;
+}
+
+static void printErrorInvalidDataFile(int errNo, ErrorNode* node) {
+    printf("[Error %d]: Invalid data file %s.\n", errNo, node->msg);
+    return;
+}
+
+static void printErrorResourceLimit(int errNo, ErrorNode* node) {
+    printf("[Error %d]: Resource limit exceeded: %s.\n", errNo, node->msg);
+    return;
+}
+
+static void printErrorTooManyErrors(int errNo, ErrorNode* node) {
+    printf("[Error %d]: Too many errors (limit: %s), the rest are omitted.\n", errNo, node->msg);
+    return;
+}
+
 
 void showErrors(ErrorManager* em){
     if(em->errorsShown){
@@ -171,3 +241,46 @@ void addTooFewArgumentsError(ErrorManager* em, const char* funcName, int declare
     strcpy(msg, buf);
     newErrorNode(em, TOO_FEW_ARGS, msg, printErrorTooFewArgs);
 }
+
+void addEmptyDefineBodyError(ErrorManager* em, const char* funcName) {
+    char* msg = malloc(strlen(funcName) + 1);
+    strcpy(msg, funcName);
+    newErrorNode(em, EMPTY_DEFINE_BODY, msg, printErrorEmptyDefineBody);
+}
+
+void addConditionalOutsideDefineError(ErrorManager* em, const char* paramName) {
+    char* msg = malloc(strlen(paramName) + 1);
+    strcpy(msg, paramName);
+    newErrorNode(em, CONDITIONAL_OUTSIDE_DEFINE, msg, printErrorConditionalOutsideDefine);
+}
+
+void addUnknownConditionParameterError(ErrorManager* em, const char* funcName, const char* paramName) {
+    char buf[128];
+    snprintf(buf, sizeof(buf), "%s does not declare \"%s\"", funcName, paramName);
+    char* msg = malloc(strlen(buf) + 1);
+    strcpy(msg, buf);
+    newErrorNode(em, UNKNOWN_CONDITION_PARAMETER, msg, printErrorUnknownConditionParameter);
+}
+
+void addInvalidEachError(ErrorManager* em, const char* funcName, const char* keyword) {
+    char buf[128];
+    snprintf(buf, sizeof(buf), "expected \"in\" after \"@each %s\", but got \"%s\"", funcName, keyword);
+    char* msg = malloc(strlen(buf) + 1);
+    strcpy(msg, buf);
+    newErrorNode(em, INVALID_EACH, msg, printErrorInvalidEach);
+}
+
+void addInvalidDataFileError(ErrorManager* em, const char* path, const char* reason) {
+    size_t length = strlen(path) + strlen(reason) + 5;
+    char* msg = malloc(length);
+    snprintf(msg, length, "\"%s\": %s", path, reason);
+    newErrorNode(em, INVALID_DATA_FILE, msg, printErrorInvalidDataFile);
+}
+
+void addResourceLimitError(ErrorManager* em, const char* resource, unsigned long long limit) {
+    char buf[128];
+    snprintf(buf, sizeof(buf), "%s (limit: %llu)", resource, limit);
+    char* msg = malloc(strlen(buf) + 1);
+    strcpy(msg, buf);
+    newErrorNode(em, RESOURCE_LIMIT_EXCEEDED, msg, printErrorResourceLimit);
+}
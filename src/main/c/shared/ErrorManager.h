@@ -10,7 +10,14 @@ typedef enum ErrorType {
     OUT_OF_INDEX,
     TOO_MANY_ARGS,        
     TOO_FEW_ARGS,        
-    INVALID_ORDERED_LIST_ITEM
+    INVALID_ORDERED_LIST_ITEM,
+    EMPTY_DEFINE_BODY,
+    RESOURCE_LIMIT_EXCEEDED,
+    TOO_MANY_ERRORS,
+    CONDITIONAL_OUTSIDE_DEFINE,
+    UNKNOWN_CONDITION_PARAMETER,
+    INVALID_EACH,
+    INVALID_DATA_FILE
 } ErrorType;
 
 typedef struct ErrorNode {
@@ -23,6 +30,8 @@ typedef struct ErrorNode {
 typedef struct ErrorManager {
     int errorCount;
     int errorsShown;
+    // Errors after this many are dropped (0 means no limit).
+    int maximumErrors;
     ErrorNode* first;
     ErrorNode* last;
 } ErrorManager;
@@ -41,5 +50,11 @@ void useParameterIndexOutOfRange(ErrorManager* em, char* name, int idx);
 void addInvalidOrderedListError(ErrorManager *em, const char *numeroRecibido, int numeroEsperado);
 void addTooManyArgumentsError(ErrorManager* em, const char* funcName, int declared, int passed);
 void addTooFewArgumentsError(ErrorManager* em, const char* funcName, int declared, int passed);
+void addEmptyDefineBodyError(ErrorManager* em, const char* funcName);
+void addConditionalOutsideDefineError(ErrorManager* em, const char* paramName);
+void addUnknownConditionParameterError(ErrorManager* em, const char* funcName, const char* paramName);
+void addInvalidEachError(ErrorManager* em, const char* funcName, const char* keyword);
+void addInvalidDataFileError(ErrorManager* em, const char* path, const char* reason);
+void addResourceLimitError(ErrorManager* em, const char* resource, unsigned long long limit);
 
 #endif
\ No newline at end of file
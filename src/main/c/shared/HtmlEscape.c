@@ -0,0 +1,97 @@
+#include "HtmlEscape.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/* PRIVATE FUNCTIONS */
+
+/**
+ * Whether a character must be escaped in each context, for the bytes that
+ * don't fill a whole vector.
+ */
+static boolean _mustEscape(const unsigned char character, const HtmlContext context) {
+	switch (character) {
+		case '<':
+		case '>':
+		case '&':
+			return true;
+		case '"':
+		case '\'':
+			return context == ATTRIBUTE_CONTEXT;
+		default:
+			return false;
+	}
+}
+
+/* PUBLIC FUNCTIONS */
+
+size_t findHtmlEscape(const char * bytes, const size_t length, const HtmlContext context) {
+	size_t k = 0;
+	// In the content of a tag, the quotes are looked up as another "<", so
+	// both contexts run the same comparisons.
+	const char quote = context == ATTRIBUTE_CONTEXT ? '"' : '<';
+	const char apostrophe = context == ATTRIBUTE_CONTEXT ? '\'' : '<';
+#if defined(__AVX2__)
+	const __m256i lessThan = _mm256_set1_epi8('<');
+	const __m256i greaterThan = _mm256_set1_epi8('>');
+	const __m256i ampersand = _mm256_set1_epi8('&');
+	const __m256i quotes = _mm256_set1_epi8(quote);
+	const __m256i apostrophes = _mm256_set1_epi8(apostrophe);
+	for (; k + 32 <= length; k += 32) {
+		const __m256i block = _mm256_loadu_si256((const __m256i *) (bytes + k));
+		const __m256i found = _mm256_or_si256(
+			_mm256_or_si256(_mm256_cmpeq_epi8(block, lessThan), _mm256_cmpeq_epi8(block, greaterThan)),
+			_mm256_or_si256(_mm256_cmpeq_epi8(block, ampersand),
+				_mm256_or_si256(_mm256_cmpeq_epi8(block, quotes), _mm256_cmpeq_epi8(block, apostrophes))));
+		const unsigned int mask = (unsigned int) _mm256_movemask_epi8(found);
+		if (mask != 0) {
+			return k + __builtin_ctz(mask);
+		}
+	}
+#elif defined(__SSE2__)
+	const __m128i lessThan = _mm_set1_epi8('<');
+	const __m128i greaterThan = _mm_set1_epi8('>');
+	const __m128i ampersand = _mm_set1_epi8('&');
+	const __m128i quotes = _mm_set1_epi8(quote);
+	const __m128i apostrophes = _mm_set1_epi8(apostrophe);
+	for (; k + 16 <= length; k += 16) {
+		const __m128i block = _mm_loadu_si128((const __m128i *) (bytes + k));
+		const __m128i found = _mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi8(block, lessThan), _mm_cmpeq_epi8(block, greaterThan)),
+			_mm_or_si128(_mm_cmpeq_epi8(block, ampersand),
+				_mm_or_si128(_mm_cmpeq_epi8(block, quotes), _mm_cmpeq_epi8(block, apostrophes))));
+		const unsigned int mask = (unsigned int) _mm_movemask_epi8(found);
+		if (mask != 0) {
+			return k + __builtin_ctz(mask);
+		}
+	}
+#endif
+	for (; k < length; ++k) {
+		if (_mustEscape((unsigned char) bytes[k], context)) {
+			return k;
+		}
+	}
+	return length;
+}
+
+boolean isHtmlClean(const char * string, const HtmlContext context) {
+	if (string == NULL) {
+		return true;
+	}
+	const size_t length = strlen(string);
+	return findHtmlEscape(string, length, context) == length;
+}
+
+const char * htmlEntity(const char character) {
+	switch (character) {
+		case '<': return "&lt;";
+		case '>': return "&gt;";
+		case '&': return "&amp;";
+		case '"': return "&quot;";
+		case '\'': return "&#39;";
+		default: return NULL;
+	}
+}
@@ -0,0 +1,36 @@
+#ifndef HTML_ESCAPE_HEADER
+#define HTML_ESCAPE_HEADER
+
+#include "Type.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Where a piece of text is written, which decides the characters that HTML
+ * would take for markup: "<", ">" and "&" in the content of a tag, and the
+ * quotes too inside the value of an attribute.
+ */
+typedef enum {
+	TEXT_CONTEXT = 0,
+	ATTRIBUTE_CONTEXT = 1
+} HtmlContext;
+
+/**
+ * The position of the first character that must be escaped in the context,
+ * or the length if there's none. It scans 16 or 32 bytes at a time where the
+ * processor can.
+ */
+size_t findHtmlEscape(const char * bytes, const size_t length, const HtmlContext context);
+
+/**
+ * Whether a string can be written in the context as it is (NULL is).
+ */
+boolean isHtmlClean(const char * string, const HtmlContext context);
+
+/**
+ * The read-only entity that replaces a character found by "findHtmlEscape"
+ * (e.g. "&lt;" for "<").
+ */
+const char * htmlEntity(const char character);
+
+#endif
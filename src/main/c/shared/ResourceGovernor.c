@@ -0,0 +1,235 @@
+#include "ResourceGovernor.h"
+
+/* MODULE INTERNAL STATE */
+
+// How many lexemes or nodes are charged between two looks at the clock.
+static const unsigned int _clockPeriod = 4096;
+// How many output bytes a thread charges before settling them.
+static const size_t _settlementBytes = 64 * 1024;
+
+static Logger * _logger = NULL;
+static CompilerState * _compilerState = NULL;
+static boolean _exceeded = false;
+
+static size_t _maximumInputBytes = 0;
+static size_t _maximumParserDepth = 0;
+static size_t _maximumNestingDepth = 0;
+static size_t _maximumExpandedNodes = 0;
+static size_t _maximumOutputBytes = 0;
+static size_t _maximumErrors = 0;
+static size_t _maximumMilliseconds = 0;
+
+// The counters shared by every thread, settled from the ones of each thread.
+static size_t _deepestNesting = 0;
+static size_t _expandedNodes = 0;
+static size_t _outputBytes = 0;
+static pthread_mutex_t _lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Every thread counts on its own, and only settles its counts with the shared
+// ones once in a while (so threads don't contend for them on every node).
+static __thread size_t _nestingDepth = 0;
+static __thread size_t _threadDeepestNesting = 0;
+static __thread size_t _threadExpandedNodes = 0;
+static __thread size_t _pendingExpandedNodes = 0;
+static __thread size_t _pendingOutputBytes = 0;
+static __thread unsigned int _ticks = 0;
+static struct timespec _start;
+
+void initializeResourceGovernorModule() {
+	_logger = createLogger("ResourceGovernor");
+	_maximumInputBytes = getSizeOrDefault("MAXIMUM_INPUT_BYTES", 0);
+	_maximumNestingDepth = getSizeOrDefault("MAXIMUM_NESTING_DEPTH", 10000);
+	_maximumParserDepth = getSizeOrDefault("MAXIMUM_PARSER_DEPTH", 10000000);
+	_maximumExpandedNodes = getSizeOrDefault("MAXIMUM_EXPANDED_NODES", 0);
+	_maximumOutputBytes = getSizeOrDefault("MAXIMUM_OUTPUT_BYTES", 1024 * 1024 * 1024);
+	_maximumErrors = getSizeOrDefault("MAXIMUM_ERRORS", 100);
+	_maximumMilliseconds = getSizeOrDefault("MAXIMUM_COMPILATION_TIME", 0);
+	// A site compiles every page in the same process, each one on its own.
+	_exceeded = false;
+	_deepestNesting = 0;
+	_expandedNodes = 0;
+	_outputBytes = 0;
+	_nestingDepth = 0;
+	_threadDeepestNesting = 0;
+	_threadExpandedNodes = 0;
+	_pendingExpandedNodes = 0;
+	_pendingOutputBytes = 0;
+	_ticks = 0;
+	clock_gettime(CLOCK_MONOTONIC, &_start);
+}
+
+void shutdownResourceGovernorModule() {
+	settleThreadResources();
+	if (_logger != NULL) {
+		logDebugging(_logger, "Expanded nodes: %zu (deepest nesting: %zu), output bytes: %zu.",
+			_expandedNodes, _deepestNesting, _outputBytes);
+		destroyLogger(_logger);
+	}
+	_compilerState = NULL;
+}
+
+/* PRIVATE FUNCTIONS */
+
+static boolean _exceed(const char * resource, const size_t limit);
+static boolean _checkClock(const size_t ticks);
+static boolean _chargeNodes(const size_t count);
+
+/**
+ * Reports the exceeded limit (only the first one) and fails the compilation.
+ */
+static boolean _exceed(const char * resource, const size_t limit) {
+	pthread_mutex_lock(&_lock);
+	if (!_exceeded) {
+		__atomic_store_n(&_exceeded, true, __ATOMIC_RELAXED);
+		logError(_logger, "Resource limit exceeded: %s (limit: %zu).", resource, limit);
+		if (_compilerState != NULL) {
+			_compilerState->succeed = false;
+			addResourceLimitError(_compilerState->errorManager, resource, limit);
+		}
+	}
+	pthread_mutex_unlock(&_lock);
+	return false;
+}
+
+/**
+ * Looks at the clock once every "_clockPeriod" ticks.
+ */
+static boolean _checkClock(const size_t ticks) {
+	if (_maximumMilliseconds == 0 || (_ticks += ticks) < _clockPeriod) {
+		return true;
+	}
+	_ticks = 0;
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	const long long elapsed = (now.tv_sec - _start.tv_sec) * 1000LL + (now.tv_nsec - _start.tv_nsec) / 1000000;
+	if ((size_t) elapsed > _maximumMilliseconds) {
+		return _exceed("compilation time in milliseconds", _maximumMilliseconds);
+	}
+	return true;
+}
+
+/**
+ * Charges expanded nodes. The limit is checked against the nodes settled by
+ * every thread, plus the ones of this thread (so it's exact with one thread).
+ */
+static boolean _chargeNodes(const size_t count) {
+	_threadExpandedNodes += count;
+	_pendingExpandedNodes += count;
+	if (_maximumExpandedNodes != 0
+			&& _maximumExpandedNodes < __atomic_load_n(&_expandedNodes, __ATOMIC_RELAXED) + _pendingExpandedNodes) {
+		return _exceed("expanded nodes", _maximumExpandedNodes);
+	}
+	if (_pendingExpandedNodes >= _clockPeriod) {
+		__atomic_add_fetch(&_expandedNodes, _pendingExpandedNodes, __ATOMIC_RELAXED);
+		_pendingExpandedNodes = 0;
+	}
+	return _checkClock(count);
+}
+
+/* PUBLIC FUNCTIONS */
+
+void governCompilation(CompilerState * compilerState) {
+	_compilerState = compilerState;
+	if (compilerState->errorManager != NULL) {
+		compilerState->errorManager->maximumErrors = (int) _maximumErrors;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &_start);
+}
+
+size_t maximumInputBytes() {
+	return _maximumInputBytes == 0 ? SIZE_MAX - 2 : _maximumInputBytes;
+}
+
+size_t maximumParserDepth() {
+	// Without a limit, the stack grows until memory runs out (it's kept well
+	// below PTRDIFF_MAX, so its size in bytes can't overflow).
+	return _maximumParserDepth == 0 ? PTRDIFF_MAX / 1024 : _maximumParserDepth;
+}
+
+boolean chargeInputBytes(const size_t length) {
+	if (_maximumInputBytes != 0 && _maximumInputBytes < length) {
+		return _exceed("input bytes", _maximumInputBytes);
+	}
+	return !resourceLimitExceeded();
+}
+
+boolean chargeLexeme() {
+	return !resourceLimitExceeded() && _checkClock(1);
+}
+
+boolean enterNesting() {
+	if (resourceLimitExceeded()) {
+		return false;
+	}
+	if (++_nestingDepth > _threadDeepestNesting) {
+		_threadDeepestNesting = _nestingDepth;
+	}
+	if (_maximumNestingDepth != 0 && _maximumNestingDepth < _nestingDepth) {
+		--_nestingDepth;
+		return _exceed("nesting depth", _maximumNestingDepth);
+	}
+	if (!_chargeNodes(1)) {
+		--_nestingDepth;
+		return false;
+	}
+	return true;
+}
+
+boolean chargeExpandedNodes(const size_t count) {
+	if (resourceLimitExceeded()) {
+		return false;
+	}
+	return _chargeNodes(count);
+}
+
+size_t expandedNodes() {
+	return _threadExpandedNodes;
+}
+
+size_t nestingDepth() {
+	return _nestingDepth;
+}
+
+void resumeNesting(const size_t depth) {
+	_nestingDepth = depth;
+}
+
+void leaveNesting() {
+	--_nestingDepth;
+}
+
+boolean chargeOutputBytes(const size_t length) {
+	_pendingOutputBytes += length;
+	if (_maximumOutputBytes != 0
+			&& _maximumOutputBytes < __atomic_load_n(&_outputBytes, __ATOMIC_RELAXED) + _pendingOutputBytes) {
+		return _exceed("output bytes", _maximumOutputBytes);
+	}
+	if (_pendingOutputBytes >= _settlementBytes) {
+		__atomic_add_fetch(&_outputBytes, _pendingOutputBytes, __ATOMIC_RELAXED);
+		_pendingOutputBytes = 0;
+	}
+	return !resourceLimitExceeded();
+}
+
+boolean checkFragmentBytes(const size_t length) {
+	if (_maximumOutputBytes != 0 && _maximumOutputBytes < length) {
+		return _exceed("output bytes", _maximumOutputBytes);
+	}
+	return !resourceLimitExceeded();
+}
+
+void settleThreadResources() {
+	__atomic_add_fetch(&_expandedNodes, _pendingExpandedNodes, __ATOMIC_RELAXED);
+	__atomic_add_fetch(&_outputBytes, _pendingOutputBytes, __ATOMIC_RELAXED);
+	_pendingExpandedNodes = 0;
+	_pendingOutputBytes = 0;
+	pthread_mutex_lock(&_lock);
+	if (_deepestNesting < _threadDeepestNesting) {
+		_deepestNesting = _threadDeepestNesting;
+	}
+	pthread_mutex_unlock(&_lock);
+}
+
+boolean resourceLimitExceeded() {
+	return __atomic_load_n(&_exceeded, __ATOMIC_RELAXED);
+}
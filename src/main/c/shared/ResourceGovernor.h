@@ -0,0 +1,117 @@
+#ifndef RESOURCE_GOVERNOR_HEADER
+#define RESOURCE_GOVERNOR_HEADER
+
+#include "CompilerState.h"
+#include "Environment.h"
+#include "ErrorManager.h"
+#include "Logger.h"
+#include "Type.h"
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+/**
+ * Guards a compilation against pathological inputs (e.g. a chain of defines
+ * that expands exponentially). Every limit is read from the environment, and
+ * the first one exceeded is reported through the error manager and marks the
+ * compilation as failed. After that, every check fails, so the phases can
+ * unwind without any further work.
+ *
+ * The checks can be made from many threads: every thread keeps its own
+ * nesting depth and counts, and settles its counts with the shared ones
+ * every few thousand nodes (or bytes), and with "settleThreadResources".
+ * With a single thread, every limit is exact.
+ */
+
+/** Initialize module's internal state. */
+void initializeResourceGovernorModule();
+
+/** Shutdown module's internal state. */
+void shutdownResourceGovernorModule();
+
+/**
+ * Starts governing a compilation: the wall-clock starts to run, and the
+ * limit of errors is applied to its error manager.
+ */
+void governCompilation(CompilerState * compilerState);
+
+/**
+ * The maximum amount of bytes of the input program (SIZE_MAX if unlimited).
+ */
+size_t maximumInputBytes();
+
+/**
+ * The maximum amount of states in the stack of the parser, which is grown on
+ * the heap as the program nests deeper.
+ */
+size_t maximumParserDepth();
+
+/**
+ * Checks the length of the input program.
+ */
+boolean chargeInputBytes(const size_t length);
+
+/**
+ * Charges one token to the lexical analysis. Only looks at the clock once
+ * every few thousand calls.
+ */
+boolean chargeLexeme();
+
+/**
+ * Charges one expanded node to the generation, and enters one level of
+ * nesting, which must be left with "leaveNesting".
+ */
+boolean enterNesting();
+
+/**
+ * Charges the nodes of a fragment that was expanded before, and is being
+ * reused as is (so the limit holds no matter how the output is cached).
+ */
+boolean chargeExpandedNodes(const size_t count);
+
+/**
+ * The amount of nodes expanded so far by this thread.
+ */
+size_t expandedNodes();
+
+/**
+ * The nesting depth of this thread.
+ */
+size_t nestingDepth();
+
+/**
+ * Starts counting the nesting of this thread from the given depth (e.g. to
+ * generate on a thread a subtree found by another one at that depth).
+ */
+void resumeNesting(const size_t depth);
+
+/**
+ * Leaves a level of nesting entered with "enterNesting".
+ */
+void leaveNesting();
+
+/**
+ * Charges bytes written to the output.
+ */
+boolean chargeOutputBytes(const size_t length);
+
+/**
+ * Checks the length of a fragment rendered in memory. Every fragment is
+ * written at least once, so it cannot be longer than the output.
+ */
+boolean checkFragmentBytes(const size_t length);
+
+/**
+ * Adds the counts of this thread to the shared ones, which must be done
+ * before the thread stops charging resources.
+ */
+void settleThreadResources();
+
+/**
+ * Whether a limit has been exceeded.
+ */
+boolean resourceLimitExceeded();
+
+#endif
@@ -0,0 +1,53 @@
+#include "SourceCode.h"
+
+/* PRIVATE FUNCTIONS */
+
+static const size_t _initialCapacity = 64 * 1024;
+
+/* PUBLIC FUNCTIONS */
+
+SourceCode * readSourceCode(FILE * stream, const size_t maximumLength) {
+	size_t capacity = _initialCapacity;
+	size_t length = 0;
+	char * bytes = malloc(capacity);
+	if (bytes == NULL) {
+		return NULL;
+	}
+	while (length <= maximumLength) {
+		if (capacity - length <= 2) {
+			capacity *= 2;
+			char * grown = realloc(bytes, capacity);
+			if (grown == NULL) {
+				free(bytes);
+				return NULL;
+			}
+			bytes = grown;
+		}
+		size_t chunk = capacity - length - 2;
+		if (maximumLength - length < chunk) {
+			chunk = maximumLength - length + 1;
+		}
+		const size_t read = fread(bytes + length, sizeof(char), chunk, stream);
+		if (read == 0) {
+			break;
+		}
+		length += read;
+	}
+	if (ferror(stream)) {
+		free(bytes);
+		return NULL;
+	}
+	bytes[length] = '\0';
+	bytes[length + 1] = '\0';
+	SourceCode * sourceCode = calloc(1, sizeof(SourceCode));
+	sourceCode->bytes = bytes;
+	sourceCode->length = length;
+	return sourceCode;
+}
+
+void destroySourceCode(SourceCode * sourceCode) {
+	if (sourceCode != NULL) {
+		free(sourceCode->bytes);
+		free(sourceCode);
+	}
+}
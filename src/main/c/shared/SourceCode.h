@@ -0,0 +1,30 @@
+#ifndef SOURCE_CODE_HEADER
+#define SOURCE_CODE_HEADER
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * The complete input program, held in memory. The bytes are followed by two
+ * NUL characters, so Flex can scan them in place (see "yy_scan_buffer"),
+ * and any later phase can refer to a byte range of the original source.
+ */
+typedef struct {
+	char * bytes;
+	size_t length;
+} SourceCode;
+
+/**
+ * Reads the entire stream into heap-memory, but never more than one byte past
+ * the maximum length (so the caller can tell that the input is too long
+ * without holding all of it). Returns NULL if the stream could not be read.
+ */
+SourceCode * readSourceCode(FILE * stream, const size_t maximumLength);
+
+/**
+ * Destroy a source code and its resources.
+ */
+void destroySourceCode(SourceCode * sourceCode);
+
+#endif
@@ -0,0 +1,244 @@
+#include "ThreadPool.h"
+#include <unistd.h>
+
+/* MODULE INTERNAL STATE */
+
+static const size_t _initialQueueCapacity = 64;
+
+typedef struct Job {
+	Task task;
+	void * argument;
+} Job;
+
+/**
+ * The tasks of a thread, in a growable ring buffer guarded by its own lock.
+ * The owner pushes and pops at the bottom, and thieves take from the top.
+ */
+typedef struct Queue {
+	pthread_mutex_t lock;
+	Job * jobs;
+	// Always a power of 2.
+	size_t capacity;
+	// Where the oldest task is.
+	size_t top;
+	size_t count;
+} Queue;
+
+typedef struct Worker {
+	ThreadPool * pool;
+	unsigned int index;
+	pthread_t thread;
+} Worker;
+
+struct ThreadPool {
+	unsigned int threads;
+	Worker * workers;
+	Queue * queues;
+	ThreadHook start;
+	ThreadHook stop;
+	// Guards everything below.
+	pthread_mutex_t lock;
+	// Signalled when a task is queued, or the pool is stopping.
+	pthread_cond_t available;
+	// Signalled when every task queued has been run.
+	pthread_cond_t idle;
+	// Tasks in the queues that no thread has claimed yet.
+	size_t queued;
+	size_t running;
+	boolean stopping;
+	unsigned int nextQueue;
+	size_t tasks;
+	size_t stolen;
+};
+
+// The thread of a pool that is running on this thread, if any.
+static __thread Worker * _worker = NULL;
+
+/* PRIVATE FUNCTIONS */
+
+static void _push(Queue * queue, const Job job);
+static boolean _pop(Queue * queue, Job * job);
+static boolean _steal(Queue * queue, Job * job);
+static void * _work(void * argument);
+
+static void _push(Queue * queue, const Job job) {
+	pthread_mutex_lock(&queue->lock);
+	if (queue->count == queue->capacity) {
+		const size_t capacity = 2 * queue->capacity;
+		Job * jobs = malloc(capacity * sizeof(Job));
+		for (size_t k = 0; k < queue->count; ++k) {
+			jobs[k] = queue->jobs[(queue->top + k) & (queue->capacity - 1)];
+		}
+		free(queue->jobs);
+		queue->jobs = jobs;
+		queue->capacity = capacity;
+		queue->top = 0;
+	}
+	queue->jobs[(queue->top + queue->count) & (queue->capacity - 1)] = job;
+	++queue->count;
+	pthread_mutex_unlock(&queue->lock);
+}
+
+/**
+ * Takes the newest task of a queue (its owner does).
+ */
+static boolean _pop(Queue * queue, Job * job) {
+	pthread_mutex_lock(&queue->lock);
+	const boolean found = queue->count > 0;
+	if (found) {
+		--queue->count;
+		*job = queue->jobs[(queue->top + queue->count) & (queue->capacity - 1)];
+	}
+	pthread_mutex_unlock(&queue->lock);
+	return found;
+}
+
+/**
+ * Takes the oldest task of a queue (another thread does).
+ */
+static boolean _steal(Queue * queue, Job * job) {
+	pthread_mutex_lock(&queue->lock);
+	const boolean found = queue->count > 0;
+	if (found) {
+		*job = queue->jobs[queue->top];
+		queue->top = (queue->top + 1) & (queue->capacity - 1);
+		--queue->count;
+	}
+	pthread_mutex_unlock(&queue->lock);
+	return found;
+}
+
+/**
+ * The loop of every thread: it claims one of the tasks queued (so there's
+ * always one left for it somewhere), and then looks for it in its own queue
+ * first, and in the queues of the others after that.
+ */
+static void * _work(void * argument) {
+	Worker * worker = argument;
+	ThreadPool * pool = worker->pool;
+	_worker = worker;
+	if (pool->start != NULL) {
+		pool->start();
+	}
+	pthread_mutex_lock(&pool->lock);
+	for (;;) {
+		while (pool->queued == 0 && !pool->stopping) {
+			pthread_cond_wait(&pool->available, &pool->lock);
+		}
+		if (pool->queued == 0) {
+			break;
+		}
+		--pool->queued;
+		++pool->running;
+		pthread_mutex_unlock(&pool->lock);
+
+		Job job;
+		boolean stolen = false;
+		while (!_pop(&pool->queues[worker->index], &job)) {
+			for (unsigned int k = 1; k < pool->threads && !stolen; ++k) {
+				stolen = _steal(&pool->queues[(worker->index + k) % pool->threads], &job);
+			}
+			if (stolen) {
+				break;
+			}
+		}
+		job.task(job.argument);
+
+		pthread_mutex_lock(&pool->lock);
+		--pool->running;
+		++pool->tasks;
+		if (stolen) {
+			++pool->stolen;
+		}
+		if (pool->queued == 0 && pool->running == 0) {
+			pthread_cond_broadcast(&pool->idle);
+		}
+	}
+	pthread_mutex_unlock(&pool->lock);
+	if (pool->stop != NULL) {
+		pool->stop();
+	}
+	_worker = NULL;
+	return NULL;
+}
+
+/* PUBLIC FUNCTIONS */
+
+ThreadPool * createThreadPool(const unsigned int threads, ThreadHook start, ThreadHook stop) {
+	ThreadPool * pool = calloc(1, sizeof(ThreadPool));
+	pool->threads = threads == 0 ? 1 : threads;
+	pool->start = start;
+	pool->stop = stop;
+	pthread_mutex_init(&pool->lock, NULL);
+	pthread_cond_init(&pool->available, NULL);
+	pthread_cond_init(&pool->idle, NULL);
+	pool->queues = calloc(pool->threads, sizeof(Queue));
+	pool->workers = calloc(pool->threads, sizeof(Worker));
+	for (unsigned int k = 0; k < pool->threads; ++k) {
+		pthread_mutex_init(&pool->queues[k].lock, NULL);
+		pool->queues[k].capacity = _initialQueueCapacity;
+		pool->queues[k].jobs = malloc(_initialQueueCapacity * sizeof(Job));
+	}
+	for (unsigned int k = 0; k < pool->threads; ++k) {
+		pool->workers[k].pool = pool;
+		pool->workers[k].index = k;
+		pthread_create(&pool->workers[k].thread, NULL, _work, &pool->workers[k]);
+	}
+	return pool;
+}
+
+void submitTask(ThreadPool * pool, Task task, void * argument) {
+	const Job job = { task, argument };
+	unsigned int index;
+	if (_worker != NULL && _worker->pool == pool) {
+		index = _worker->index;
+	}
+	else {
+		pthread_mutex_lock(&pool->lock);
+		index = pool->nextQueue++ % pool->threads;
+		pthread_mutex_unlock(&pool->lock);
+	}
+	_push(&pool->queues[index], job);
+	pthread_mutex_lock(&pool->lock);
+	++pool->queued;
+	pthread_cond_signal(&pool->available);
+	pthread_mutex_unlock(&pool->lock);
+}
+
+ThreadPoolStatistics threadPoolStatistics(ThreadPool * pool) {
+	pthread_mutex_lock(&pool->lock);
+	const ThreadPoolStatistics statistics = { pool->tasks, pool->stolen };
+	pthread_mutex_unlock(&pool->lock);
+	return statistics;
+}
+
+void destroyThreadPool(ThreadPool * pool) {
+	if (pool == NULL) {
+		return;
+	}
+	pthread_mutex_lock(&pool->lock);
+	while (pool->queued > 0 || pool->running > 0) {
+		pthread_cond_wait(&pool->idle, &pool->lock);
+	}
+	pool->stopping = true;
+	pthread_cond_broadcast(&pool->available);
+	pthread_mutex_unlock(&pool->lock);
+	for (unsigned int k = 0; k < pool->threads; ++k) {
+		pthread_join(pool->workers[k].thread, NULL);
+	}
+	for (unsigned int k = 0; k < pool->threads; ++k) {
+		pthread_mutex_destroy(&pool->queues[k].lock);
+		free(pool->queues[k].jobs);
+	}
+	pthread_cond_destroy(&pool->idle);
+	pthread_cond_destroy(&pool->available);
+	pthread_mutex_destroy(&pool->lock);
+	free(pool->queues);
+	free(pool->workers);
+	free(pool);
+}
+
+unsigned int availableProcessors() {
+	const long processors = sysconf(_SC_NPROCESSORS_ONLN);
+	return processors < 1 ? 1 : (unsigned int) processors;
+}
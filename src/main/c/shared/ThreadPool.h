@@ -0,0 +1,56 @@
+#ifndef THREAD_POOL_HEADER
+#define THREAD_POOL_HEADER
+
+#include "Type.h"
+#include <pthread.h>
+#include <stdlib.h>
+
+/**
+ * A fixed set of threads that run tasks. Every thread keeps its own queue:
+ * it runs the tasks it submits itself last-in first-out (they're the ones
+ * that are still hot in its cache), and when it runs out of tasks, it steals
+ * the oldest task of another thread (which tends to be the largest one).
+ * Tasks submitted from outside the pool are dealt to the threads in turns.
+ */
+typedef struct ThreadPool ThreadPool;
+
+typedef void (*Task)(void * argument);
+
+/**
+ * Called by every thread of the pool when it starts, and when it stops (e.g.
+ * to set up and tear down its thread-local state).
+ */
+typedef void (*ThreadHook)(void);
+
+typedef struct ThreadPoolStatistics {
+	size_t tasks;
+	size_t stolen;
+} ThreadPoolStatistics;
+
+/**
+ * Starts the threads. The hooks can be NULL.
+ */
+ThreadPool * createThreadPool(const unsigned int threads, ThreadHook start, ThreadHook stop);
+
+/**
+ * Queues a task. It can be called from any thread, including the threads of
+ * the pool while they run a task.
+ */
+void submitTask(ThreadPool * pool, Task task, void * argument);
+
+/**
+ * The amount of tasks run so far, and how many of them were stolen.
+ */
+ThreadPoolStatistics threadPoolStatistics(ThreadPool * pool);
+
+/**
+ * Waits until every task queued has been run, and stops the threads.
+ */
+void destroyThreadPool(ThreadPool * pool);
+
+/**
+ * The amount of processors online (at least 1).
+ */
+unsigned int availableProcessors();
+
+#endif
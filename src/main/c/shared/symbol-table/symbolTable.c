@@ -72,6 +72,13 @@ bool symbolTableGetValue(SymbolTable *table, const char *name, char **outValue)
     return true;
 }
 
+const char *symbolTableValue(SymbolTable *table, const char *name) {
+    if (!table || !name || strlen(name) == 0) return NULL;
+    Symbol *sym = symbolTableLookup(table, name);
+    if (!sym || sym->type != SYM_VAR) return NULL;
+    return sym->value;
+}
+
 int symbolTableGetParameterCount(SymbolTable *table, const char *function) {
     if (!table || !function || strlen(function) == 0) return 0;
 
@@ -32,6 +32,10 @@ bool symbolTableSetValue(SymbolTable *table, const char *function, const char *v
 
 bool symbolTableGetValue(SymbolTable *table, const char *name, char **outValue);
 
+// Like symbolTableGetValue, but without a copy: the value is NULL if there's
+// none, and it's valid until the variable is set again.
+const char *symbolTableValue(SymbolTable *table, const char *name);
+
 int symbolTableGetParameterCount(SymbolTable *table, const char *function);
 
 int symbolTableGetParameterCount(SymbolTable *table, const char *function);